@@ -62,6 +62,8 @@ b8 gameUpdate(Game *gameInstance, f32 deltaTime) {
     if (inputIsKeyUp('M') && inputWasKeyDown('M')) {
         ENGINE_DEBUG("Allocations: %llu (%llu this frame)",
             allocationCount, allocationCount - prevAllocationCount)
+        engineReportFrameHotSpots(8);
+        engineReportTopAllocators(8);
     }
 
     if (inputIsKeyUp('T') && inputWasKeyDown('T')) {
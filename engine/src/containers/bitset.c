@@ -0,0 +1,158 @@
+#include "bitset.h"
+
+#include "../core/logger.h"
+#include "../engine_memory/engine_memory.h"
+
+static u32 wordsFor(u32 bitCount) {
+    return (bitCount + 63) / 64;
+}
+
+/** Mask of the bits of word that lie below bitCount. */
+static u64 validBits(u32 bitCount, u32 word) {
+    u32 remaining = bitCount - (word * 64);
+    return remaining >= 64 ? ~0ULL : (1ULL << remaining) - 1;
+}
+
+b8 bitsetCreate(u32 bitCount, u64 *memoryRequirement, void *memory, Bitset *outBitset) {
+    if (!memoryRequirement) {
+        ENGINE_ERROR("bitsetCreate requires a memoryRequirement.")
+        return false;
+    }
+
+    *memoryRequirement = sizeof(u64) * wordsFor(bitCount);
+    if (!memory) {
+        return true;
+    }
+
+    if (!outBitset) {
+        ENGINE_ERROR("bitsetCreate requires outBitset when memory is passed.")
+        return false;
+    }
+
+    outBitset->bitCount = bitCount;
+    outBitset->wordCount = wordsFor(bitCount);
+    outBitset->words = memory;
+    bitsetClearAll(outBitset);
+
+    return true;
+}
+
+void bitsetClearAll(Bitset *bitset) {
+    engineZeroMemory(bitset->words, sizeof(u64) * bitset->wordCount);
+}
+
+u32 bitsetCount(const Bitset *bitset) {
+    u32 count = 0;
+    for (u32 i = 0; i < bitset->wordCount; ++i) {
+        count += bitPopCount64(bitset->words[i]);
+    }
+
+    return count;
+}
+
+/** Shared scan; invert flips each word so the search is always for a set bit. */
+static u32 findFirst(const Bitset *bitset, u32 start, u64 invert) {
+    if (start >= bitset->bitCount) {
+        return INVALID_ID;
+    }
+
+    u32 word = start >> 6;
+    u64 bits = (bitset->words[word] ^ invert) & (~0ULL << (start & 63));
+    for (;;) {
+        bits &= validBits(bitset->bitCount, word);
+        if (bits) {
+            return (word * 64) + bitCountTrailingZeros64(bits);
+        }
+
+        if (++word >= bitset->wordCount) {
+            return INVALID_ID;
+        }
+
+        bits = bitset->words[word] ^ invert;
+    }
+}
+
+u32 bitsetFindFirstSet(const Bitset *bitset, u32 start) {
+    return findFirst(bitset, start, 0);
+}
+
+u32 bitsetFindFirstClear(const Bitset *bitset, u32 start) {
+    return findFirst(bitset, start, ~0ULL);
+}
+
+b8 indexAllocatorCreate(u32 capacity, u64 *memoryRequirement, void *memory,
+    IndexAllocator *outAllocator) {
+
+    if (!memoryRequirement || capacity == 0) {
+        ENGINE_ERROR("indexAllocatorCreate requires a memoryRequirement and a capacity above zero.")
+        return false;
+    }
+
+    /** Block of memory will contain the leaf words, then the summary words. */
+    u32 leafWordCount = wordsFor(capacity);
+    u64 leafRequirement = 0;
+    u64 summaryRequirement = 0;
+    bitsetCreate(capacity, &leafRequirement, 0, 0);
+    bitsetCreate(leafWordCount, &summaryRequirement, 0, 0);
+    *memoryRequirement = leafRequirement + summaryRequirement;
+    if (!memory) {
+        return true;
+    }
+
+    if (!outAllocator) {
+        ENGINE_ERROR("indexAllocatorCreate requires outAllocator when memory is passed.")
+        return false;
+    }
+
+    outAllocator->capacity = capacity;
+    bitsetCreate(capacity, &leafRequirement, memory, &outAllocator->leaves);
+    bitsetCreate(leafWordCount, &summaryRequirement, (u8*)memory + leafRequirement, &outAllocator->summary);
+    indexAllocatorReset(outAllocator);
+
+    return true;
+}
+
+void indexAllocatorReset(IndexAllocator *allocator) {
+    Bitset *leaves = &allocator->leaves;
+    for (u32 i = 0; i < leaves->wordCount; ++i) {
+        leaves->words[i] = validBits(leaves->bitCount, i);
+    }
+
+    Bitset *summary = &allocator->summary;
+    for (u32 i = 0; i < summary->wordCount; ++i) {
+        summary->words[i] = validBits(summary->bitCount, i);
+    }
+
+    allocator->count = 0;
+}
+
+u32 indexAllocatorAcquire(IndexAllocator *allocator) {
+    u32 leafWord = bitsetFindFirstSet(&allocator->summary, 0);
+    if (leafWord == INVALID_ID) {
+        return INVALID_ID;
+    }
+
+    u64 *word = &allocator->leaves.words[leafWord];
+    u32 index = (leafWord * 64) + bitCountTrailingZeros64(*word);
+    *word &= *word - 1;
+    if (!*word) {
+        bitsetClear(&allocator->summary, leafWord);
+    }
+
+    allocator->count++;
+
+    return index;
+}
+
+b8 indexAllocatorRelease(IndexAllocator *allocator, u32 index) {
+    if (!indexAllocatorIsAcquired(allocator, index)) {
+        ENGINE_WARNING("indexAllocatorRelease - index %u is not in use; double release?", index)
+        return false;
+    }
+
+    bitsetSet(&allocator->leaves, index);
+    bitsetSet(&allocator->summary, index >> 6);
+    allocator->count--;
+
+    return true;
+}
@@ -0,0 +1,143 @@
+#ifndef __ENGINE_BITSET_H__
+#define __ENGINE_BITSET_H__
+
+#include "../defines.h"
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+/** @brief Index of the lowest set bit of a non-zero value. */
+ENGINE_INLINE u32 bitCountTrailingZeros64(u64 value) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index = 0;
+    _BitScanForward64(&index, value);
+    return (u32)index;
+#else
+    return (u32)__builtin_ctzll(value);
+#endif
+}
+
+/** @brief Number of set bits in value. */
+ENGINE_INLINE u32 bitPopCount64(u64 value) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    return (u32)__popcnt64(value);
+#else
+    return (u32)__builtin_popcountll(value);
+#endif
+}
+
+/**
+ * @brief A fixed number of bits packed into 64-bit words. Scans skip whole
+ * words at a time and use ctz on the first interesting one.
+ */
+typedef struct Bitset {
+    u32 bitCount;
+    u32 wordCount;
+    u64 *words;
+} Bitset;
+
+/**
+ * @brief Creates a bitset with every bit clear, or obtains the memory requirement for one.
+ * Call twice; once passing 0 to memory to obtain the memory requirement,
+ * and a second time passing an allocated block to memory.
+ *
+ * @param bitCount The number of bits.
+ * @param memoryRequirement A pointer to hold the memory requirement.
+ * @param memory 0, or a pre-allocated block of memory for the bitset to use.
+ * @param outBitset A pointer to hold the bitset.
+ * @return True on success; otherwise false.
+ */
+ENGINE_API b8 bitsetCreate(u32 bitCount, u64 *memoryRequirement, void *memory, Bitset *outBitset);
+
+/** @brief Clears every bit. */
+ENGINE_API void bitsetClearAll(Bitset *bitset);
+
+/** @brief Number of set bits. */
+ENGINE_API u32 bitsetCount(const Bitset *bitset);
+
+/**
+ * @brief Finds the first set bit at or after start.
+ *
+ * @return The bit index; INVALID_ID if there is none.
+ */
+ENGINE_API u32 bitsetFindFirstSet(const Bitset *bitset, u32 start);
+
+/**
+ * @brief Finds the first clear bit at or after start.
+ *
+ * @return The bit index; INVALID_ID if there is none.
+ */
+ENGINE_API u32 bitsetFindFirstClear(const Bitset *bitset, u32 start);
+
+ENGINE_INLINE b8 bitsetTest(const Bitset *bitset, u32 bit) {
+    return (bitset->words[bit >> 6] >> (bit & 63)) & 1;
+}
+
+ENGINE_INLINE void bitsetSet(Bitset *bitset, u32 bit) {
+    bitset->words[bit >> 6] |= 1ULL << (bit & 63);
+}
+
+ENGINE_INLINE void bitsetClear(Bitset *bitset, u32 bit) {
+    bitset->words[bit >> 6] &= ~(1ULL << (bit & 63));
+}
+
+/**
+ * @brief Hands out the lowest free index in [0, capacity) and takes released
+ * ones back, so IDs are reused and stay packed toward 0. Members of this
+ * structure should not be modified outside the functions associated with it.
+ *
+ * A leaf bitset marks free indices. A summary word per 64 leaf words marks
+ * which leaf words still have a free bit, so finding a free index reads one
+ * summary word per 4096 indices and then a single leaf word.
+ */
+typedef struct IndexAllocator {
+    u32 capacity;
+
+    /** Number of indices handed out. */
+    u32 count;
+
+    /** Bit i is set while index i is free. */
+    Bitset leaves;
+
+    /** Bit i is set while leaf word i has a free bit. */
+    Bitset summary;
+} IndexAllocator;
+
+/**
+ * @brief Creates an allocator with every index free, or obtains the memory requirement for one.
+ * Call twice; once passing 0 to memory to obtain the memory requirement,
+ * and a second time passing an allocated block to memory.
+ *
+ * @param capacity The number of indices.
+ * @param memoryRequirement A pointer to hold the memory requirement.
+ * @param memory 0, or a pre-allocated block of memory for the allocator to use.
+ * @param outAllocator A pointer to hold the allocator.
+ * @return True on success; otherwise false.
+ */
+ENGINE_API b8 indexAllocatorCreate(u32 capacity, u64 *memoryRequirement, void *memory,
+    IndexAllocator *outAllocator);
+
+/** @brief Marks every index free again. */
+ENGINE_API void indexAllocatorReset(IndexAllocator *allocator);
+
+/**
+ * @brief Takes the lowest free index.
+ *
+ * @return The index; INVALID_ID if every index is in use.
+ */
+ENGINE_API u32 indexAllocatorAcquire(IndexAllocator *allocator);
+
+/**
+ * @brief Returns an index for reuse.
+ *
+ * @return True if the index was in use; otherwise false.
+ */
+ENGINE_API b8 indexAllocatorRelease(IndexAllocator *allocator, u32 index);
+
+/** @brief True if the index is currently handed out. */
+ENGINE_INLINE b8 indexAllocatorIsAcquired(const IndexAllocator *allocator, u32 index) {
+    return index < allocator->capacity && !bitsetTest(&allocator->leaves, index);
+}
+
+#endif
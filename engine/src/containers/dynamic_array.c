@@ -3,22 +3,62 @@
 #include "../engine_memory/engine_memory.h"
 #include "../core/logger.h"
 
-void* _dynamicArrayCreate(u64 length, u64 stride) {
-    u64 header_size = DYNAMIC_ARRAY_FIELD_LENGTH * sizeof(u64);
+#define DYNAMIC_ARRAY_HEADER_SIZE (DYNAMIC_ARRAY_FIELD_LENGTH * sizeof(u64))
+#define DYNAMIC_ARRAY_ALIGNMENT 16
+
+static EngineAllocator* headerAllocator(u64* header) {
+    return (EngineAllocator*)&header[DYNAMIC_ARRAY_ALLOCATOR];
+}
+
+static void* allocateArray(u64 length, u64 stride, const EngineAllocator* allocator, b8 zero) {
+    u64 header_size = DYNAMIC_ARRAY_HEADER_SIZE;
     u64 array_size = length * stride;
-    u64* new_array = engineAllocate(header_size + array_size, MEMORY_TAG_DYNAMIC_ARRAY);
-    engineSetMemory(new_array, 0, header_size + array_size);
+    u64* new_array = 0;
+    if (allocator && allocator->allocate) {
+        new_array = engineAllocatorAllocate(allocator, header_size + array_size, DYNAMIC_ARRAY_ALIGNMENT);
+        if (!new_array) {
+            ENGINE_ERROR("Dynamic array allocator is out of space for %llu elements.", length)
+            return 0;
+        }
+
+        if (zero) {
+            engineZeroMemory(new_array, header_size + array_size);
+        }
+    } else {
+        new_array = zero ?
+            engineAllocate(header_size + array_size, MEMORY_TAG_DYNAMIC_ARRAY) :
+            engineAllocateUninitialized(header_size + array_size, MEMORY_TAG_DYNAMIC_ARRAY);
+    }
+
     new_array[DYNAMIC_ARRAY_CAPACITY] = length;
     new_array[DYNAMIC_ARRAY_LENGTH] = 0;
     new_array[DYNAMIC_ARRAY_STRIDE] = stride;
+    new_array[DYNAMIC_ARRAY_GROWTH] = DYNAMIC_ARRAY_DEFAULT_GROWTH;
+    if (allocator) {
+        *headerAllocator(new_array) = *allocator;
+    } else {
+        engineZeroMemory(headerAllocator(new_array), sizeof(EngineAllocator));
+    }
     return (void*)(new_array + DYNAMIC_ARRAY_FIELD_LENGTH);
 }
 
+void* _dynamicArrayCreate(u64 length, u64 stride) {
+    return allocateArray(length, stride, 0, true);
+}
+
+void* _dynamicArrayCreateWith(u64 length, u64 stride, const EngineAllocator* allocator) {
+    return allocateArray(length, stride, allocator, true);
+}
+
 void _dynamicArrayDestroy(void* array) {
     u64* header = (u64*)array - DYNAMIC_ARRAY_FIELD_LENGTH;
-    u64 header_size = DYNAMIC_ARRAY_FIELD_LENGTH * sizeof(u64);
-    u64 total_size = header_size + header[DYNAMIC_ARRAY_CAPACITY] * header[DYNAMIC_ARRAY_STRIDE];
-    engineFree(header, total_size, MEMORY_TAG_DYNAMIC_ARRAY);
+    u64 total_size = DYNAMIC_ARRAY_HEADER_SIZE + header[DYNAMIC_ARRAY_CAPACITY] * header[DYNAMIC_ARRAY_STRIDE];
+    EngineAllocator* allocator = headerAllocator(header);
+    if (allocator->allocate) {
+        engineAllocatorFree(allocator, header, total_size, DYNAMIC_ARRAY_ALIGNMENT);
+    } else {
+        engineFree(header, total_size, MEMORY_TAG_DYNAMIC_ARRAY);
+    }
 }
 
 u64 _dynamicArrayFieldGet(void* array, u64 field) {
@@ -31,24 +71,70 @@ void _dynamicArrayFieldSet(void* array, u64 field, u64 value) {
     header[field] = value;
 }
 
-void* _dynamicArrayResize(void* array) {
-    u64 length = dynamicArrayLength(array);
-    u64 stride = dynamicArrayStride(array);
-    void* temp = _dynamicArrayCreate(
-        (DYNAMIC_ARRAY_RESIZE_FACTOR * dynamicArrayCapacity(array)),
-        stride);
+/** Moves the contents into a new block of exactly capacity elements. */
+static void* reallocateArray(void* array, u64 capacity) {
+    u64* header = (u64*)array - DYNAMIC_ARRAY_FIELD_LENGTH;
+    u64 length = header[DYNAMIC_ARRAY_LENGTH];
+    u64 stride = header[DYNAMIC_ARRAY_STRIDE];
+
+    /** Only the part past the copied elements needs zeroing. */
+    void* temp = allocateArray(capacity, stride, headerAllocator(header), false);
+    if (!temp) {
+        return array;
+    }
+
     engineCopyMemory(temp, array, length * stride);
+    engineZeroMemory((u8*)temp + (length * stride), (capacity - length) * stride);
 
     _dynamicArrayFieldSet(temp, DYNAMIC_ARRAY_LENGTH, length);
+    _dynamicArrayFieldSet(temp, DYNAMIC_ARRAY_GROWTH, header[DYNAMIC_ARRAY_GROWTH]);
     _dynamicArrayDestroy(array);
     return temp;
 }
 
+/** Grows by the growth factor, or further if that is still not enough for required elements. */
+static void* growArray(void* array, u64 required) {
+    u64 capacity = dynamicArrayCapacity(array);
+    if (required <= capacity) {
+        return array;
+    }
+
+    u64 grown = (capacity * _dynamicArrayFieldGet(array, DYNAMIC_ARRAY_GROWTH)) / 100;
+    if (grown <= capacity) {
+        grown = capacity + 1;
+    }
+
+    return reallocateArray(array, grown < required ? required : grown);
+}
+
+void* _dynamicArrayResize(void* array) {
+    return growArray(array, dynamicArrayCapacity(array) + 1);
+}
+
+/**
+ * Growing frees the old block, so a source inside the array is found again
+ * in the new block, which holds a copy of every element.
+ */
+static const void* sourceAfterGrow(const void* source, const void* oldArray, const void* newArray, u64 length, u64 stride) {
+    const u8* start = oldArray;
+    if (oldArray == newArray || (const u8*)source < start || (const u8*)source >= start + (length * stride)) {
+        return source;
+    }
+
+    return (const u8*)newArray + ((const u8*)source - start);
+}
+
 void* _dynamicArrayPush(void* array, const void* value_ptr) {
     u64 length = dynamicArrayLength(array);
     u64 stride = dynamicArrayStride(array);
     if (length >= dynamicArrayCapacity(array)) {
+        void* old = array;
         array = _dynamicArrayResize(array);
+        if (length >= dynamicArrayCapacity(array)) {
+            return array;
+        }
+
+        value_ptr = sourceAfterGrow(value_ptr, old, array, length, stride);
     }
 
     u64 addr = (u64)array;
@@ -58,6 +144,47 @@ void* _dynamicArrayPush(void* array, const void* value_ptr) {
     return array;
 }
 
+void* _dynamicArrayPushN(void* array, const void* values, u64 count) {
+    u64 length = dynamicArrayLength(array);
+    u64 stride = dynamicArrayStride(array);
+    if (!count) {
+        return array;
+    }
+
+    void* old = array;
+    array = growArray(array, length + count);
+    if (length + count > dynamicArrayCapacity(array)) {
+        return array;
+    }
+
+    values = sourceAfterGrow(values, old, array, length, stride);
+
+    engineCopyMemory((u8*)array + (length * stride), values, count * stride);
+    _dynamicArrayFieldSet(array, DYNAMIC_ARRAY_LENGTH, length + count);
+    return array;
+}
+
+void* _dynamicArrayReserveCapacity(void* array, u64 capacity) {
+    if (capacity <= dynamicArrayCapacity(array)) {
+        return array;
+    }
+
+    return reallocateArray(array, capacity);
+}
+
+void* _dynamicArrayShrinkToFit(void* array) {
+    u64* header = (u64*)array - DYNAMIC_ARRAY_FIELD_LENGTH;
+    EngineAllocator* allocator = headerAllocator(header);
+    u64 length = header[DYNAMIC_ARRAY_LENGTH];
+
+    /** A bump allocator would only leak the old block; keep it. */
+    if ((allocator->allocate && !allocator->free) || header[DYNAMIC_ARRAY_CAPACITY] == length) {
+        return array;
+    }
+
+    return reallocateArray(array, length ? length : 1);
+}
+
 void _dynamicArrayPop(void* array, void* dest) {
     u64 length = dynamicArrayLength(array);
     u64 stride = dynamicArrayStride(array);
@@ -78,18 +205,38 @@ void* _dynamicArrayPopAt(void* array, u64 index, void* dest) {
     u64 addr = (u64)array;
     engineCopyMemory(dest, (void*)(addr + (index * stride)), stride);
 
-    // If not on the last element, snip out the entry and copy the rest inward.
+    // If not on the last element, snip out the entry and move the rest inward.
     if (index != length - 1) {
-        engineCopyMemory(
+        engineMoveMemory(
             (void*)(addr + (index * stride)),
             (void*)(addr + ((index + 1) * stride)),
-            stride * (length - index));
+            stride * (length - index - 1));
     }
 
     _dynamicArrayFieldSet(array, DYNAMIC_ARRAY_LENGTH, length - 1);
     return array;
 }
 
+void _dynamicArraySwapRemove(void* array, u64 index, void* dest) {
+    u64 length = dynamicArrayLength(array);
+    u64 stride = dynamicArrayStride(array);
+    if (index >= length) {
+        ENGINE_ERROR("Index outside the bounds of this array! Length: %llu, index: %llu", length, index);
+        return;
+    }
+
+    u8* element = (u8*)array + (index * stride);
+    if (dest) {
+        engineCopyMemory(dest, element, stride);
+    }
+
+    if (index != length - 1) {
+        engineCopyMemory(element, (u8*)array + ((length - 1) * stride), stride);
+    }
+
+    _dynamicArrayFieldSet(array, DYNAMIC_ARRAY_LENGTH, length - 1);
+}
+
 void* _dynamicArrayInsertAt(void* array, u64 index, void* value_ptr) {
     u64 length = dynamicArrayLength(array);
     u64 stride = dynamicArrayStride(array);
@@ -99,21 +246,22 @@ void* _dynamicArrayInsertAt(void* array, u64 index, void* value_ptr) {
     }
     if (length >= dynamicArrayCapacity(array)) {
         array = _dynamicArrayResize(array);
+        if (length >= dynamicArrayCapacity(array)) {
+            return array;
+        }
     }
 
     u64 addr = (u64)array;
 
-    // If not on the last element, copy the rest outward.
-    if (index != length - 1) {
-        engineCopyMemory(
-            (void*)(addr + ((index + 1) * stride)),
-            (void*)(addr + (index * stride)),
-            stride * (length - index));
-    }
+    // Move the rest outward.
+    engineMoveMemory(
+        (void*)(addr + ((index + 1) * stride)),
+        (void*)(addr + (index * stride)),
+        stride * (length - index));
 
     // Set the value at the index
     engineCopyMemory((void*)(addr + (index * stride)), value_ptr, stride);
 
     _dynamicArrayFieldSet(array, DYNAMIC_ARRAY_LENGTH, length + 1);
     return array;
-}
\ No newline at end of file
+}
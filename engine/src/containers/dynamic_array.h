@@ -1,12 +1,16 @@
 #pragma once
 
 #include "../defines.h"
+#include "../engine_memory/allocator.h"
 
 /*
 Memory layout
 u64 capacity = number elements that can be held
 u64 length = number of elements currently contained
 u64 stride = size of each element in bytes
+u64 growth = percentage of the old capacity allocated when full
+EngineAllocator allocator = where the array lives; allocate is 0 for the engine heap
+u64 padding = keeps elements 16-byte aligned
 void* elements
 */
 
@@ -14,10 +18,20 @@ enum {
     DYNAMIC_ARRAY_CAPACITY,
     DYNAMIC_ARRAY_LENGTH,
     DYNAMIC_ARRAY_STRIDE,
-    DYNAMIC_ARRAY_FIELD_LENGTH
+    DYNAMIC_ARRAY_GROWTH,
+    DYNAMIC_ARRAY_ALLOCATOR,
+    DYNAMIC_ARRAY_FIELD_LENGTH = DYNAMIC_ARRAY_ALLOCATOR + 4
 };
 
 ENGINE_API void* _dynamicArrayCreate(u64 length, u64 stride);
+
+/**
+ * @brief Creates an array whose storage comes from the given allocator. A copy
+ * of allocator is kept; the allocator it refers to must outlive the array.
+ * With allocators that cannot free individually (linear, stack, arena), blocks
+ * outgrown by the array are only reclaimed when that allocator is reset.
+ */
+ENGINE_API void* _dynamicArrayCreateWith(u64 length, u64 stride, const EngineAllocator* allocator);
 ENGINE_API void _dynamicArrayDestroy(void* array);
 
 ENGINE_API u64 _dynamicArrayFieldGet(void* array, u64 field);
@@ -31,12 +45,32 @@ ENGINE_API void _dynamicArrayPop(void* array, void* dest);
 ENGINE_API void* _dynamicArrayPopAt(void* array, u64 index, void* dest);
 ENGINE_API void* _dynamicArrayInsertAt(void* array, u64 index, void* value_ptr);
 
-#define DYNAMIC_ARRAY_DEFAULT_CAPACITY 1
-#define DYNAMIC_ARRAY_RESIZE_FACTOR 2
+/** @brief Appends count elements from values with a single copy, growing at most once. */
+ENGINE_API void* _dynamicArrayPushN(void* array, const void* values, u64 count);
+
+/** @brief Grows capacity to at least the given number of elements. Never shrinks. */
+ENGINE_API void* _dynamicArrayReserveCapacity(void* array, u64 capacity);
+
+/** @brief Reallocates so capacity matches length. No-op for allocators that cannot free. */
+ENGINE_API void* _dynamicArrayShrinkToFit(void* array);
+
+/**
+ * @brief Removes the element at index by moving the last element into its place.
+ * O(1), but does not preserve order.
+ */
+ENGINE_API void _dynamicArraySwapRemove(void* array, u64 index, void* dest);
+
+#define DYNAMIC_ARRAY_DEFAULT_CAPACITY 4
+
+/** Default growth, as a percentage of the old capacity. */
+#define DYNAMIC_ARRAY_DEFAULT_GROWTH 200
 
 #define dynamicArrayCreate(type) \
     _dynamicArrayCreate(DYNAMIC_ARRAY_DEFAULT_CAPACITY, sizeof(type))
 
+#define dynamicArrayCreateWith(type, capacity, allocator_ptr) \
+    _dynamicArrayCreateWith(capacity, sizeof(type), allocator_ptr)
+
 #define dynamicArrayReserve(type, capacity) \
     _dynamicArrayCreate(capacity, sizeof(type))
 
@@ -77,3 +111,30 @@ ENGINE_API void* _dynamicArrayInsertAt(void* array, u64 index, void* value_ptr);
 
 #define dynamicArrayLengthSet(array, value) \
     _dynamicArrayFieldSet(array, DYNAMIC_ARRAY_LENGTH, value)
+
+#define dynamicArrayPushN(array, values_ptr, count) \
+    {                                            \
+        array = _dynamicArrayPushN(array, values_ptr, count); \
+    }
+
+#define dynamicArrayAppendArray(array, other) \
+    {                                            \
+        array = _dynamicArrayPushN(array, other, dynamicArrayLength(other)); \
+    }
+
+#define dynamicArrayReserveCapacity(array, capacity) \
+    {                                            \
+        array = _dynamicArrayReserveCapacity(array, capacity); \
+    }
+
+#define dynamicArrayShrinkToFit(array) \
+    {                                            \
+        array = _dynamicArrayShrinkToFit(array); \
+    }
+
+#define dynamicArraySwapRemove(array, index, value_ptr) \
+    _dynamicArraySwapRemove(array, index, value_ptr)
+
+/** Sets the growth percentage; anything up to 100 is treated as growing by one element. */
+#define dynamicArraySetGrowth(array, percent) \
+    _dynamicArrayFieldSet(array, DYNAMIC_ARRAY_GROWTH, percent)
@@ -1,49 +1,452 @@
 #include "hashtable.h"
 
 #include "../engine_memory/engine_memory.h"
+#include "../engine_memory/engine_string.h"
 
 #include "../core/logger.h"
 
-u64 hashName(const char *name, u32 elementCount) {
-    /** A simular to use when generating a hash. Prime to hopefully avoid collisions. */
-    static const u64 multiplier = 97;
+#define HASHTABLE_INVALID_SLOT ((u64)-1)
 
-    unsigned const char *us;
-    u64 hash = 0;
+/** Entries moved out of the old storage per insert or removal while a growable table rehashes. */
+#define HASHTABLE_REHASH_STEP 8
+
+/**
+ * @brief 64-bit FNV-1a over the name, with a final avalanche so the low bits
+ * used to pick a slot depend on every byte. The name's length is written to
+ * outLength.
+ */
+static u64 hashName(const char *name, u64 *outLength) {
+    u64 hash = 0xcbf29ce484222325ULL;
 
-    for (us = (unsigned const char *)name; *us; us++) {
-        hash = hash * multiplier + *us;
+    const u8 *us = (const u8*)name;
+    for (; *us; us++) {
+        hash ^= *us;
+        hash *= 0x100000001b3ULL;
     }
 
-    /** Mod it against the size of the table. */
-    hash %= elementCount;
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+
+    *outLength = (u64)(us - (const u8*)name);
 
     return hash;
 }
 
-void hashtableCreate(u64 elementSize, u32 elementCount, void *memory, b8 isPointerType,
-    Hashtable *outHashtable) {
+static u64 hashU64(u64 key) {
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ULL;
+    key ^= key >> 33;
+
+    return key;
+}
+
+/** Hash of a string or u64 key; never 0, which marks an empty slot. */
+static u64 hashKey(const Hashtable *table, const void *key, u64 *outLength) {
+    u64 hash = 0;
+    if (table->keyType == HASHTABLE_KEY_STRING) {
+        hash = hashName(key, outLength);
+    } else {
+        hash = hashU64(*(const u64*)key);
+        *outLength = sizeof(u64);
+    }
+
+    return hash ? hash : 1;
+}
+
+static b8 keyMatches(const Hashtable *table, const HashtableStorage *storage, u32 entry, const void *key) {
+    const u8 *stored = storage->keys + ((u64)entry * table->keySize);
+    if (table->keyType == HASHTABLE_KEY_STRING) {
+        return stringsEqual((const char*)stored, key);
+    }
+
+    return *(const u64*)stored == *(const u64*)key;
+}
+
+static u64 roundTo16(u64 size) {
+    return (size + 15) & ~15ULL;
+}
+
+/** Smallest power of two that keeps capacity entries at most 7/8 of the slots. */
+static u64 slotCountFor(u32 capacity) {
+    u64 minimum = (u64)capacity + (capacity / 7) + 1;
+    u64 count = 8;
+    while (count < minimum) {
+        count <<= 1;
+    }
+
+    return count;
+}
+
+/**
+ * @brief Obtains the size of storage for capacity entries and, given memory,
+ * carves it up: slots, then hashes, values and finally keys.
+ */
+static u64 layoutStorage(u64 elementSize, u32 keySize, u32 capacity, void *memory, HashtableStorage *outStorage) {
+    u64 slotCount = slotCountFor(capacity);
+    u64 slotsRequirement = slotCount * sizeof(HashtableSlot);
+    u64 hashesRequirement = capacity * sizeof(u64);
+    u64 valuesRequirement = roundTo16(elementSize * capacity);
+    u64 keysRequirement = roundTo16((u64)keySize * capacity);
+    u64 requirement = slotsRequirement + hashesRequirement + valuesRequirement + keysRequirement;
+
+    if (memory) {
+        engineZeroMemory(outStorage, sizeof(HashtableStorage));
+        outStorage->capacity = capacity;
+        outStorage->slotMask = slotCount - 1;
+        outStorage->memory = memory;
+        outStorage->memorySize = requirement;
+        outStorage->slots = memory;
+        outStorage->hashes = (u64*)((u8*)memory + slotsRequirement);
+        outStorage->values = (u8*)outStorage->hashes + hashesRequirement;
+        outStorage->keys = outStorage->values + valuesRequirement;
+
+        /** Only the slots need clearing; entries are written before they are read. */
+        engineZeroMemory(outStorage->slots, slotsRequirement);
+    }
+
+    return requirement;
+}
+
+/** How far the slot at index sits from the home slot of its hash. */
+static u64 probeDistance(const HashtableStorage *storage, u64 index, u64 hash) {
+    return (index - (hash & storage->slotMask)) & storage->slotMask;
+}
+
+static u64 storageFind(const Hashtable *table, const HashtableStorage *storage, const void *key, u64 hash) {
+    if (!storage->count) {
+        return HASHTABLE_INVALID_SLOT;
+    }
+
+    u64 index = hash & storage->slotMask;
+    for (u64 distance = 0; ; ++distance) {
+        const HashtableSlot *slot = &storage->slots[index];
+
+        /** A poorer entry ends the search; the key would have displaced it. */
+        if (!slot->hash || probeDistance(storage, index, slot->hash) < distance) {
+            return HASHTABLE_INVALID_SLOT;
+        }
+
+        if (slot->hash == hash && keyMatches(table, storage, slot->entry, key)) {
+            return index;
+        }
+
+        index = (index + 1) & storage->slotMask;
+    }
+}
+
+/** The slot that points at entry, found by probing from the entry's home slot. */
+static u64 storageSlotOfEntry(const HashtableStorage *storage, u32 entry) {
+    u64 index = storage->hashes[entry] & storage->slotMask;
+    while (storage->slots[index].entry != entry || !storage->slots[index].hash) {
+        index = (index + 1) & storage->slotMask;
+    }
+
+    return index;
+}
+
+/** Appends a new entry for key, which must not be present. The storage must have room. */
+static u32 storageInsert(const Hashtable *table, HashtableStorage *storage, const void *key,
+    u64 keyLength, u64 hash) {
+
+    u32 entry = storage->count++;
+    storage->hashes[entry] = hash;
+    u8 *storedKey = storage->keys + ((u64)entry * table->keySize);
+    engineCopyMemory(storedKey, key, keyLength);
+    if (table->keyType == HASHTABLE_KEY_STRING) {
+        storedKey[keyLength] = 0;
+    }
+
+    /** Robin Hood insertion: take the slot of any entry closer to its home than we are to ours. */
+    HashtableSlot carried = { hash, entry, 0 };
+    u64 index = hash & storage->slotMask;
+    u64 distance = 0;
+    for (;;) {
+        HashtableSlot *slot = &storage->slots[index];
+        if (!slot->hash) {
+            *slot = carried;
+            break;
+        }
+
+        u64 residentDistance = probeDistance(storage, index, slot->hash);
+        if (residentDistance < distance) {
+            HashtableSlot displaced = *slot;
+            *slot = carried;
+            carried = displaced;
+            distance = residentDistance;
+        }
+
+        index = (index + 1) & storage->slotMask;
+        ++distance;
+    }
+
+    return entry;
+}
+
+static void storageRemoveSlot(const Hashtable *table, HashtableStorage *storage, u64 hole) {
+    u32 entry = storage->slots[hole].entry;
+
+    /** Backward-shift deletion: pull the rest of the run one slot closer to home. */
+    u64 next = (hole + 1) & storage->slotMask;
+    while (storage->slots[next].hash && probeDistance(storage, next, storage->slots[next].hash) > 0) {
+        storage->slots[hole] = storage->slots[next];
+        hole = next;
+        next = (next + 1) & storage->slotMask;
+    }
+
+    storage->slots[hole].hash = 0;
+
+    /** Keep entries dense by moving the last one into the freed entry. */
+    u32 last = --storage->count;
+    if (entry != last) {
+        storage->slots[storageSlotOfEntry(storage, last)].entry = entry;
+        storage->hashes[entry] = storage->hashes[last];
+        engineCopyMemory(storage->values + (table->elementSize * entry),
+                         storage->values + (table->elementSize * last), table->elementSize);
+        const u8 *lastKey = storage->keys + ((u64)table->keySize * last);
+        u64 keyLength = table->keyType == HASHTABLE_KEY_STRING ?
+            stringLength((const char*)lastKey) + 1 : sizeof(u64);
+        engineCopyMemory(storage->keys + ((u64)table->keySize * entry), lastKey, keyLength);
+    }
+}
 
-    if (!memory || !outHashtable) {
-        ENGINE_ERROR("hashtableCreate failed! Pointer to memory and outHashtable are required!")
+/** Moves up to steps entries from the old storage into the current one, releasing it once empty. */
+static void migrate(Hashtable *table, u32 steps) {
+    HashtableStorage *previous = &table->previous;
+    if (!previous->memory) {
         return;
     }
 
+    while (steps-- && previous->count) {
+        u32 entry = previous->count - 1;
+        const u8 *key = previous->keys + ((u64)entry * table->keySize);
+        u64 keyLength = table->keyType == HASHTABLE_KEY_STRING ? stringLength((const char*)key) : sizeof(u64);
+
+        u32 moved = storageInsert(table, &table->current, key, keyLength, previous->hashes[entry]);
+        engineCopyMemory(table->current.values + (table->elementSize * moved),
+                         previous->values + (table->elementSize * entry), table->elementSize);
+
+        /** The last entry, so removal leaves the rest of the entries where they are. */
+        storageRemoveSlot(table, previous, storageSlotOfEntry(previous, entry));
+    }
+
+    if (!previous->count) {
+        engineFree(previous->memory, previous->memorySize, MEMORY_TAG_DICTIONARY);
+        engineZeroMemory(previous, sizeof(HashtableStorage));
+    }
+}
+
+/** Doubles a full growable table. Anything still waiting to be rehashed is finished first. */
+static b8 grow(Hashtable *table) {
+    migrate(table, INVALID_ID);
+    if (table->current.count < table->current.capacity) {
+        return true;
+    }
+
+    if (table->current.capacity > (INVALID_ID >> 1)) {
+        ENGINE_ERROR("Hashtable cannot grow beyond %u entries.", table->current.capacity)
+        return false;
+    }
+
+    u32 capacity = table->current.capacity * 2;
+    u64 requirement = layoutStorage(table->elementSize, table->keySize, capacity, 0, 0);
+    void *memory = engineAllocate(requirement, MEMORY_TAG_DICTIONARY);
+
+    table->previous = table->current;
+    layoutStorage(table->elementSize, table->keySize, capacity, memory, &table->current);
+    table->elementCount = capacity;
+
+    return true;
+}
+
+/** Pointer to the stored value for key, or 0 if it is not present. */
+static u8 *findValue(Hashtable *table, const void *key, u64 hash) {
+    u64 slot = storageFind(table, &table->current, key, hash);
+    if (slot != HASHTABLE_INVALID_SLOT) {
+        return table->current.values + (table->elementSize * table->current.slots[slot].entry);
+    }
+
+    slot = storageFind(table, &table->previous, key, hash);
+    if (slot != HASHTABLE_INVALID_SLOT) {
+        return table->previous.values + (table->elementSize * table->previous.slots[slot].entry);
+    }
+
+    return 0;
+}
+
+/** Pointer to the value for key, adding the key when it is not present. 0 if it cannot be added. */
+static u8 *acquireValue(Hashtable *table, const void *key) {
+    u64 keyLength = 0;
+    u64 hash = hashKey(table, key, &keyLength);
+
+    u8 *value = findValue(table, key, hash);
+    if (value) {
+        return value;
+    }
+
+    if (table->keyType == HASHTABLE_KEY_STRING && keyLength >= table->keySize) {
+        ENGINE_ERROR("Hashtable key '%s' is longer than the %u characters the table stores.",
+            (const char*)key, table->keySize - 1)
+        return 0;
+    }
+
+    if (table->current.count == table->current.capacity) {
+        if (!table->growable) {
+            if (table->keyType == HASHTABLE_KEY_STRING) {
+                ENGINE_ERROR("Hashtable is full (%u entries); cannot add '%s'.",
+                    table->elementCount, (const char*)key)
+            } else {
+                ENGINE_ERROR("Hashtable is full (%u entries); cannot add key %llu.",
+                    table->elementCount, *(const u64*)key)
+            }
+            return 0;
+        }
+
+        if (!grow(table)) {
+            return 0;
+        }
+    }
+
+    u32 entry = storageInsert(table, &table->current, key, keyLength, hash);
+    table->count++;
+    value = table->current.values + (table->elementSize * entry);
+
+    /** The value pointer stays valid; migration only adds entries to current. */
+    migrate(table, HASHTABLE_REHASH_STEP);
+
+    return value;
+}
+
+static b8 removeKey(Hashtable *table, const void *key) {
+    u64 keyLength = 0;
+    u64 hash = hashKey(table, key, &keyLength);
+
+    b8 removed = false;
+    u64 slot = storageFind(table, &table->current, key, hash);
+    if (slot != HASHTABLE_INVALID_SLOT) {
+        storageRemoveSlot(table, &table->current, slot);
+        removed = true;
+    } else {
+        slot = storageFind(table, &table->previous, key, hash);
+        if (slot != HASHTABLE_INVALID_SLOT) {
+            storageRemoveSlot(table, &table->previous, slot);
+            removed = true;
+        }
+    }
+
+    if (removed) {
+        table->count--;
+        migrate(table, HASHTABLE_REHASH_STEP);
+    }
+
+    return removed;
+}
+
+static b8 createFixed(u64 elementSize, u32 elementCount, HashtableKeyType keyType, u32 keySize,
+    b8 isPointerType, u64 *memoryRequirement, void *memory, Hashtable *outHashtable) {
+
+    if (!memoryRequirement) {
+        ENGINE_ERROR("hashtableCreate requires memoryRequirement to exist. Create failed.")
+        return false;
+    }
+
     if (!elementCount || !elementSize) {
         ENGINE_ERROR("elementSize and elementCount must be a positive non-zero value!")
-        return;
+        return false;
+    }
+
+    /** Storage, followed by the default value. */
+    u64 storageRequirement = layoutStorage(elementSize, keySize, elementCount, 0, 0);
+    *memoryRequirement = storageRequirement + roundTo16(elementSize);
+
+    if (!memory) {
+        return true;
     }
 
+    if (!outHashtable) {
+        ENGINE_ERROR("hashtableCreate failed! Pointer to outHashtable is required!")
+        return false;
+    }
+
+    engineZeroMemory(outHashtable, sizeof(Hashtable));
     outHashtable->memory = memory;
     outHashtable->elementCount = elementCount;
     outHashtable->elementSize = elementSize;
     outHashtable->isPointerType = isPointerType;
+    outHashtable->keyType = keyType;
+    outHashtable->keySize = keySize;
+    layoutStorage(elementSize, keySize, elementCount, memory, &outHashtable->current);
+    outHashtable->defaultValue = (u8*)memory + storageRequirement;
+
+    return true;
+}
+
+b8 hashtableCreate(u64 elementSize, u32 elementCount, u32 maxKeyLength, b8 isPointerType,
+    u64 *memoryRequirement, void *memory, Hashtable *outHashtable) {
+
+    if (maxKeyLength < 2) {
+        ENGINE_ERROR("hashtableCreate - maxKeyLength must leave room for at least one character.")
+        return false;
+    }
+
+    return createFixed(elementSize, elementCount, HASHTABLE_KEY_STRING, maxKeyLength, isPointerType,
+        memoryRequirement, memory, outHashtable);
+}
+
+b8 hashtableCreateU64(u64 elementSize, u32 elementCount, u64 *memoryRequirement,
+    void *memory, Hashtable *outHashtable) {
+
+    return createFixed(elementSize, elementCount, HASHTABLE_KEY_U64, sizeof(u64), false,
+        memoryRequirement, memory, outHashtable);
+}
+
+b8 hashtableCreateGrowable(u64 elementSize, u32 initialCount, HashtableKeyType keyType,
+    u32 maxKeyLength, b8 isPointerType, Hashtable *outHashtable) {
+
+    if (!outHashtable || !elementSize) {
+        ENGINE_ERROR("hashtableCreateGrowable requires outHashtable and a non-zero elementSize.")
+        return false;
+    }
+
+    if (keyType == HASHTABLE_KEY_STRING && maxKeyLength < 2) {
+        ENGINE_ERROR("hashtableCreateGrowable - maxKeyLength must leave room for at least one character.")
+        return false;
+    }
+
+    engineZeroMemory(outHashtable, sizeof(Hashtable));
+    outHashtable->elementSize = elementSize;
+    outHashtable->elementCount = initialCount < 8 ? 8 : initialCount;
+    outHashtable->isPointerType = isPointerType;
+    outHashtable->keyType = keyType;
+    outHashtable->keySize = keyType == HASHTABLE_KEY_STRING ? maxKeyLength : sizeof(u64);
+    outHashtable->growable = true;
 
-    engineZeroMemory(outHashtable->memory, elementSize * elementCount);
+    u64 requirement = layoutStorage(elementSize, outHashtable->keySize, outHashtable->elementCount, 0, 0);
+    void *memory = engineAllocate(requirement, MEMORY_TAG_DICTIONARY);
+    layoutStorage(elementSize, outHashtable->keySize, outHashtable->elementCount, memory, &outHashtable->current);
+    outHashtable->defaultValue = engineAllocate(elementSize, MEMORY_TAG_DICTIONARY);
+
+    return true;
 }
 
 void hashtableDestroy(Hashtable *table) {
     if (table) {
+        if (table->growable) {
+            if (table->previous.memory) {
+                engineFree(table->previous.memory, table->previous.memorySize, MEMORY_TAG_DICTIONARY);
+            }
+
+            if (table->current.memory) {
+                engineFree(table->current.memory, table->current.memorySize, MEMORY_TAG_DICTIONARY);
+            }
+
+            if (table->defaultValue) {
+                engineFree(table->defaultValue, table->elementSize, MEMORY_TAG_DICTIONARY);
+            }
+        }
+
         engineZeroMemory(table, sizeof(Hashtable));
     }
 }
@@ -54,15 +457,18 @@ b8 hashtableSet(Hashtable *table, const char *name, void *value) {
         return false;
     }
 
-    if (table->isPointerType) {
-        ENGINE_ERROR("hashtableSet should not be used with tables that have pointer types. "
-            "Use hashtableSetPtr instead.")
+    if (table->isPointerType || table->keyType != HASHTABLE_KEY_STRING) {
+        ENGINE_ERROR("hashtableSet should only be used with string keyed tables without pointer types. "
+            "Use hashtableSetPtr or hashtableSetU64 instead.")
         return false;
     }
 
-    u64 hash = hashName(name, table->elementCount);
-    engineCopyMemory(table->memory + (table->elementSize * hash), value,
-                     table->elementSize);
+    u8 *stored = acquireValue(table, name);
+    if (!stored) {
+        return false;
+    }
+
+    engineCopyMemory(stored, value, table->elementSize);
 
     return true;
 }
@@ -73,14 +479,24 @@ b8 hashtableSetPtr(Hashtable *table, const char *name, void **value) {
         return false;
     }
 
-    if (!table->isPointerType) {
+    if (!table->isPointerType || table->keyType != HASHTABLE_KEY_STRING) {
         ENGINE_ERROR("hashtable_set_ptr should not be used with tables that do "
             "not have pointer types. Use hashtable_set instead.")
         return false;
     }
 
-    u64 hash = hashName(name, table->elementCount);
-    ((void**)table->memory)[hash] = value ? *value : 0;
+    /** Unsetting is a removal, so the entry can be reused. */
+    if (!value || !*value) {
+        removeKey(table, name);
+        return true;
+    }
+
+    u8 *stored = acquireValue(table, name);
+    if (!stored) {
+        return false;
+    }
+
+    *(void**)stored = *value;
 
     return true;
 }
@@ -91,15 +507,23 @@ b8 hashtableGet(Hashtable *table, const char *name, void *outValue) {
         return false;
     }
 
-    if (table->isPointerType) {
-        ENGINE_ERROR("hashtableGet should not be used with tables that have pointer types. "
-            "Use hashtableSetPtr instead.")
+    if (table->isPointerType || table->keyType != HASHTABLE_KEY_STRING) {
+        ENGINE_ERROR("hashtableGet should only be used with string keyed tables without pointer types. "
+            "Use hashtableGetPtr or hashtableGetU64 instead.")
         return false;
     }
 
-    u64 hash = hashName(name, table->elementCount);
-    engineCopyMemory(outValue, table->memory + (table->elementSize * hash),
-                     table->elementSize);
+    u64 keyLength = 0;
+    u8 *stored = findValue(table, name, hashKey(table, name, &keyLength));
+    if (!stored) {
+        if (table->hasDefaultValue) {
+            engineCopyMemory(outValue, table->defaultValue, table->elementSize);
+        }
+
+        return table->hasDefaultValue;
+    }
+
+    engineCopyMemory(outValue, stored, table->elementSize);
 
     return true;
 }
@@ -110,18 +534,94 @@ b8 hashtableGetPtr(Hashtable *table, const char *name, void **outValue) {
         return false;
     }
 
-    if (!table->isPointerType) {
+    if (!table->isPointerType || table->keyType != HASHTABLE_KEY_STRING) {
         ENGINE_ERROR("hashtable_get_ptr should not be used with tables that do not have pointer types. "
             "Use hashtable_get instead.")
         return false;
     }
 
-    u64 hash = hashName(name, table->elementCount);
-    *outValue = ((void**)table->memory)[hash];
+    u64 keyLength = 0;
+    u8 *stored = findValue(table, name, hashKey(table, name, &keyLength));
+    *outValue = stored ? *(void**)stored : 0;
 
     return *outValue != 0;
 }
 
+b8 hashtableRemove(Hashtable *table, const char *name) {
+    if (!table || !name) {
+        ENGINE_WARNING("hashtableRemove requires table and name to exist.")
+        return false;
+    }
+
+    if (table->keyType != HASHTABLE_KEY_STRING) {
+        ENGINE_ERROR("hashtableRemove should only be used with string keyed tables. Use hashtableRemoveU64 instead.")
+        return false;
+    }
+
+    return removeKey(table, name);
+}
+
+b8 hashtableSetU64(Hashtable *table, u64 key, void *value) {
+    if (!table || !value) {
+        ENGINE_ERROR("hashtableSetU64 requires table and value to exist.")
+        return false;
+    }
+
+    if (table->keyType != HASHTABLE_KEY_U64) {
+        ENGINE_ERROR("hashtableSetU64 should only be used with u64 keyed tables. Use hashtableSet instead.")
+        return false;
+    }
+
+    u8 *stored = acquireValue(table, &key);
+    if (!stored) {
+        return false;
+    }
+
+    engineCopyMemory(stored, value, table->elementSize);
+
+    return true;
+}
+
+b8 hashtableGetU64(Hashtable *table, u64 key, void *outValue) {
+    if (!table || !outValue) {
+        ENGINE_WARNING("hashtableGetU64 requires table and outValue to exist.")
+        return false;
+    }
+
+    if (table->keyType != HASHTABLE_KEY_U64) {
+        ENGINE_ERROR("hashtableGetU64 should only be used with u64 keyed tables. Use hashtableGet instead.")
+        return false;
+    }
+
+    u64 keyLength = 0;
+    u8 *stored = findValue(table, &key, hashKey(table, &key, &keyLength));
+    if (!stored) {
+        if (table->hasDefaultValue) {
+            engineCopyMemory(outValue, table->defaultValue, table->elementSize);
+        }
+
+        return table->hasDefaultValue;
+    }
+
+    engineCopyMemory(outValue, stored, table->elementSize);
+
+    return true;
+}
+
+b8 hashtableRemoveU64(Hashtable *table, u64 key) {
+    if (!table) {
+        ENGINE_WARNING("hashtableRemoveU64 requires table to exist.")
+        return false;
+    }
+
+    if (table->keyType != HASHTABLE_KEY_U64) {
+        ENGINE_ERROR("hashtableRemoveU64 should only be used with u64 keyed tables. Use hashtableRemove instead.")
+        return false;
+    }
+
+    return removeKey(table, &key);
+}
+
 b8 hashtableFill(Hashtable *table, void *value) {
     if (!table || !value) {
         ENGINE_WARNING("hashtable_fill requires table and value to exist.")
@@ -133,9 +633,47 @@ b8 hashtableFill(Hashtable *table, void *value) {
         return false;
     }
 
-    for (u32 i = 0; i < table->elementCount; ++i) {
-        engineCopyMemory(table->memory + (table->elementSize * i), value, table->elementSize);
+    engineCopyMemory(table->defaultValue, value, table->elementSize);
+    table->hasDefaultValue = true;
+
+    for (u32 i = 0; i < table->current.count; ++i) {
+        engineCopyMemory(table->current.values + (table->elementSize * i), value, table->elementSize);
+    }
+
+    for (u32 i = 0; i < table->previous.count; ++i) {
+        engineCopyMemory(table->previous.values + (table->elementSize * i), value, table->elementSize);
     }
 
     return true;
 }
+
+HashtableIterator hashtableIterate(Hashtable *table) {
+    HashtableIterator iterator = { table, 0, 0 };
+    return iterator;
+}
+
+b8 hashtableIteratorNext(HashtableIterator *iterator, HashtableEntry *outEntry) {
+    if (!iterator || !iterator->table || !outEntry) {
+        return false;
+    }
+
+    Hashtable *table = iterator->table;
+
+    /** Entries are dense, so this only ever visits live ones: current first, then previous. */
+    while (iterator->storage < 2) {
+        HashtableStorage *storage = iterator->storage == 0 ? &table->current : &table->previous;
+        if (iterator->entry < storage->count) {
+            u32 entry = iterator->entry++;
+            const u8 *key = storage->keys + ((u64)entry * table->keySize);
+            outEntry->name = table->keyType == HASHTABLE_KEY_STRING ? (const char*)key : 0;
+            outEntry->key = table->keyType == HASHTABLE_KEY_U64 ? *(const u64*)key : 0;
+            outEntry->value = storage->values + (table->elementSize * entry);
+            return true;
+        }
+
+        iterator->storage++;
+        iterator->entry = 0;
+    }
+
+    return false;
+}
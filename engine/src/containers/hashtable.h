@@ -3,78 +3,204 @@
 
 #include "../defines.h"
 
+typedef enum HashtableKeyType {
+    /** Null-terminated names, copied into the table. */
+    HASHTABLE_KEY_STRING,
+
+    /** 64-bit integers such as handles or precomputed hashes. */
+    HASHTABLE_KEY_U64
+} HashtableKeyType;
+
+/**
+ * @brief One open-addressing slot. hash is the full 64-bit key hash, 0 when
+ * the slot is empty; entry indexes the value and key storage.
+ */
+typedef struct HashtableSlot {
+    u64 hash;
+    u32 entry;
+    u32 reserved;
+} HashtableSlot;
+
+/**
+ * @brief Slots plus dense entry storage. Entries 0..count-1 are always live;
+ * removal moves the last entry into the hole.
+ */
+typedef struct HashtableStorage {
+    u32 capacity;
+    u32 count;
+    u64 slotMask;
+    HashtableSlot *slots;
+
+    /** Key hash, value and key of entry i live at index i. */
+    u64 *hashes;
+    u8 *values;
+    u8 *keys;
+
+    /** The block everything above is carved from. */
+    void *memory;
+    u64 memorySize;
+} HashtableStorage;
+
 /**
  * @brief Represents a simple hashtable. Members of this structure
  * should not be modified outside the functions associated with it.
- * 
- * For non-pointer types, table retains a copy of the value.For 
+ *
+ * For non-pointer types, table retains a copy of the value.For
  * pointer types, make sure to use the _ptr setter and getter. Table
  * does not take ownership of pointers or associated memory allocations,
  * and should be managed externally.
+ *
+ * Lookups use Robin Hood open addressing over a power-of-two slot array
+ * kept at most 7/8 full. Each slot holds the full key hash, so probing
+ * rarely touches a key, and a copy of every key is kept so that keys
+ * which hash alike never alias each other. Removal shifts the rest of
+ * the probe run back a slot, so there are no tombstones.
+ *
+ * Growable tables double when full. The old storage is drained a few
+ * entries per insert or removal rather than all at once, and lookups
+ * check both until it is empty.
  */
 typedef struct Hashtable {
     u64 elementSize;
+
+    /** Most entries the table can hold without growing. */
     u32 elementCount;
     b8 isPointerType;
+
+    /** The block passed to hashtableCreate; 0 for growable tables. */
     void *memory;
+
+    HashtableKeyType keyType;
+
+    /** Bytes of key storage per entry; the longest name plus terminator for string keys. */
+    u32 keySize;
+
+    /** Number of entries currently stored. */
+    u32 count;
+
+    b8 growable;
+    HashtableStorage current;
+
+    /** Storage being drained into current after a grow; memory is 0 otherwise. */
+    HashtableStorage previous;
+
+    /** Returned by lookups of missing keys once hashtableFill has been called. */
+    u8 *defaultValue;
+    b8 hasDefaultValue;
 } Hashtable;
 
 /**
- * @brief Creates a hashtable and stores it in out_hashtable.
- * 
+ * @brief Walks the entries of a table. Adding or removing entries while
+ * iterating invalidates the iterator.
+ */
+typedef struct HashtableIterator {
+    Hashtable *table;
+    u32 storage;
+    u32 entry;
+} HashtableIterator;
+
+/** @brief An entry visited by an iterator. value points into the table. */
+typedef struct HashtableEntry {
+    /** The key for string tables; otherwise 0. */
+    const char *name;
+
+    /** The key for u64 tables; otherwise 0. */
+    u64 key;
+    void *value;
+} HashtableEntry;
+
+/**
+ * @brief Creates a string keyed hashtable or obtains the memory requirement for one.
+ * Call twice; once passing 0 to memory to obtain the memory requirement,
+ * and a second time passing an allocated block to memory.
+ *
  * @param elementSize The size of each element in bytes.
  * @param elementCount The maximum number of elements. Cannot be resized.
- * @param memory A block of memory to be used. Should be equal in size to element_size * element_count;
+ * @param maxKeyLength The longest name that can be stored, including the terminator.
  * @param isPointerType Indicates if this hashtable will hold pointer types.
+ * @param memoryRequirement A pointer to hold the memory requirement.
+ * @param memory 0, or a pre-allocated block of memory for the table to use.
  * @param outHashtable A pointer to a hashtable in which to hold relevant data.
+ * @return True on success; otherwise false.
  */
-ENGINE_API void hashtableCreate(u64 elementSize, u32 elementCount, void *memory,
-    b8 isPointerType, Hashtable *outHashtable);
+ENGINE_API b8 hashtableCreate(u64 elementSize, u32 elementCount, u32 maxKeyLength, b8 isPointerType,
+    u64 *memoryRequirement, void *memory, Hashtable *outHashtable);
+
+/**
+ * @brief Creates a u64 keyed hashtable or obtains the memory requirement for one.
+ * Call twice, as with hashtableCreate.
+ *
+ * @param elementSize The size of each element in bytes.
+ * @param elementCount The maximum number of elements. Cannot be resized.
+ * @param memoryRequirement A pointer to hold the memory requirement.
+ * @param memory 0, or a pre-allocated block of memory for the table to use.
+ * @param outHashtable A pointer to a hashtable in which to hold relevant data.
+ * @return True on success; otherwise false.
+ */
+ENGINE_API b8 hashtableCreateU64(u64 elementSize, u32 elementCount, u64 *memoryRequirement,
+    void *memory, Hashtable *outHashtable);
+
+/**
+ * @brief Creates a hashtable that owns its memory and grows as needed.
+ *
+ * @param elementSize The size of each element in bytes.
+ * @param initialCount The number of elements to make room for up front.
+ * @param keyType The kind of key the table is looked up by.
+ * @param maxKeyLength The longest name that can be stored, including the terminator.
+ * Ignored for u64 keys.
+ * @param isPointerType Indicates if this hashtable will hold pointer types.
+ * @param outHashtable A pointer to a hashtable in which to hold relevant data.
+ * @return True on success; otherwise false.
+ */
+ENGINE_API b8 hashtableCreateGrowable(u64 elementSize, u32 initialCount, HashtableKeyType keyType,
+    u32 maxKeyLength, b8 isPointerType, Hashtable *outHashtable);
 
 /**
  * @brief Destroys the provided hashtable. Does not release memory for pointer types.
- * 
+ * Releases the storage of growable tables.
+ *
  * @param table A pointer to the table to be destroyed.
  */
 ENGINE_API void hashtableDestroy(Hashtable *table);
 
 /**
- * @brief Stores a copy of the data in value in the provided hashtable. 
+ * @brief Stores a copy of the data in value in the provided hashtable.
  * Only use for tables which were *NOT* created with is_pointer_type = true.
- * 
+ *
  * @param table A pointer to the table to get from. Required.
  * @param name The name of the entry to set. Required.
  * @param value The value to be set. Required.
- * @return True, or false if a null pointer is passed.
+ * @return True; or false if a null pointer is passed, the name is too long or the table is full.
  */
 ENGINE_API b8 hashtableSet(Hashtable *table, const char *name, void *value);
 
 /**
  * @brief Stores a pointer as provided in value in the hashtable.
  * Only use for tables which were created with is_pointer_type = true.
- * 
+ *
  * @param table A pointer to the table to get from. Required.
  * @param name The name of the entry to set. Required.
  * @param value A pointer value to be set. Can pass 0 to 'unset' an entry.
- * @return True; or false if a null pointer is passed or if the entry is 0.
+ * @return True; or false if a null pointer is passed, the name is too long or the table is full.
  */
 ENGINE_API b8 hashtableSetPtr(Hashtable *table, const char *name, void **value);
 
 /**
  * @brief Obtains a copy of data present in the hashtable.
  * Only use for tables which were *NOT* created with is_pointer_type = true.
- * 
+ *
  * @param table A pointer to the table to retrieved from. Required.
  * @param name The name of the entry to retrieved. Required.
  * @param value A pointer to store the retrieved value. Required.
- * @return True; or false if a null pointer is passed.
+ * @return True if the entry exists or the table has been filled with a default value,
+ * which is then copied out instead; otherwise false.
  */
 ENGINE_API b8 hashtableGet(Hashtable *table, const char *name, void *outValue);
 
 /**
  * @brief Obtains a pointer to data present in the hashtable.
  * Only use for tables which were created with is_pointer_type = true.
- * 
+ *
  * @param table A pointer to the table to retrieved from. Required.
  * @param name The name of the entry to retrieved. Required.
  * @param value A pointer to store the retrieved value. Required.
@@ -83,14 +209,51 @@ ENGINE_API b8 hashtableGet(Hashtable *table, const char *name, void *outValue);
 ENGINE_API b8 hashtableGetPtr(Hashtable *table, const char *name, void **outValue);
 
 /**
- * @brief Fills all entries in the hashtable with the given value.
+ * @brief Removes an entry, freeing its slot for another name.
+ *
+ * @param table A pointer to the table. Required.
+ * @param name The name of the entry to remove. Required.
+ * @return True if the entry existed; otherwise false.
+ */
+ENGINE_API b8 hashtableRemove(Hashtable *table, const char *name);
+
+/** @brief hashtableSet for tables created with u64 keys. */
+ENGINE_API b8 hashtableSetU64(Hashtable *table, u64 key, void *value);
+
+/** @brief hashtableGet for tables created with u64 keys. */
+ENGINE_API b8 hashtableGetU64(Hashtable *table, u64 key, void *outValue);
+
+/** @brief hashtableRemove for tables created with u64 keys. */
+ENGINE_API b8 hashtableRemoveU64(Hashtable *table, u64 key);
+
+/**
+ * @brief Sets the value returned for keys that are not present, and
+ * overwrites every stored entry with it.
  * Useful when non-existent names should return some default value.
  * Should not be used with pointer table types.
- * 
+ *
  * @param table A pointer to the table filled. Required.
  * @param value The value to be filled with. Required.
  * @return True if successful; otherwise false.
  */
 ENGINE_API b8 hashtableFill(Hashtable *table, void *value);
 
+/**
+ * @brief Obtains an iterator positioned before the first entry. Visits only
+ * stored entries, in no particular order.
+ *
+ * @param table A pointer to the table to walk. Required.
+ * @return The iterator.
+ */
+ENGINE_API HashtableIterator hashtableIterate(Hashtable *table);
+
+/**
+ * @brief Advances the iterator.
+ *
+ * @param iterator A pointer to the iterator. Required.
+ * @param outEntry A pointer to hold the next entry. Required.
+ * @return True if an entry was written; false once every entry has been visited.
+ */
+ENGINE_API b8 hashtableIteratorNext(HashtableIterator *iterator, HashtableEntry *outEntry);
+
 #endif
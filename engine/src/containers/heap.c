@@ -0,0 +1,224 @@
+#include "heap.h"
+
+#include "../core/logger.h"
+#include "../engine_memory/engine_memory.h"
+
+/** Entries are aligned so a node's HEAP_ARITY children share as few cache lines as possible. */
+#define HEAP_ALIGNMENT 64
+
+static void placeEntry(Heap *heap, u32 index, HeapEntry entry) {
+    heap->entries[index] = entry;
+    entry.node->heapIndex = index;
+}
+
+/** Moves the entry at index toward the root until its parent is no larger. */
+static void siftUp(Heap *heap, u32 index) {
+    HeapEntry entry = heap->entries[index];
+    while (index > 0) {
+        u32 parent = (index - 1) / HEAP_ARITY;
+        if (heap->entries[parent].priority <= entry.priority) {
+            break;
+        }
+
+        placeEntry(heap, index, heap->entries[parent]);
+        index = parent;
+    }
+
+    placeEntry(heap, index, entry);
+}
+
+/** Moves the entry at index toward the leaves until no child is smaller. */
+static void siftDown(Heap *heap, u32 index) {
+    HeapEntry entry = heap->entries[index];
+    for (;;) {
+        u32 firstChild = (index * HEAP_ARITY) + 1;
+        if (firstChild >= heap->count) {
+            break;
+        }
+
+        u32 lastChild = firstChild + HEAP_ARITY;
+        if (lastChild > heap->count) {
+            lastChild = heap->count;
+        }
+
+        u32 smallest = firstChild;
+        for (u32 child = firstChild + 1; child < lastChild; ++child) {
+            if (heap->entries[child].priority < heap->entries[smallest].priority) {
+                smallest = child;
+            }
+        }
+
+        if (heap->entries[smallest].priority >= entry.priority) {
+            break;
+        }
+
+        placeEntry(heap, index, heap->entries[smallest]);
+        index = smallest;
+    }
+
+    placeEntry(heap, index, entry);
+}
+
+static b8 ownsNode(const Heap *heap, const HeapNode *node) {
+    return node && node->heapIndex < heap->count && heap->entries[node->heapIndex].node == node;
+}
+
+b8 heapCreate(u32 capacity, u64 *memoryRequirement, void *memory, Heap *outHeap) {
+    if (!memoryRequirement || capacity == 0) {
+        ENGINE_ERROR("heapCreate requires a memoryRequirement and a capacity above zero.")
+        return false;
+    }
+
+    *memoryRequirement = sizeof(HeapEntry) * capacity;
+    if (!memory) {
+        return true;
+    }
+
+    if (!outHeap) {
+        ENGINE_ERROR("heapCreate requires outHeap when memory is passed.")
+        return false;
+    }
+
+    outHeap->capacity = capacity;
+    outHeap->count = 0;
+    outHeap->entries = memory;
+    outHeap->memory = memory;
+    outHeap->growable = false;
+
+    return true;
+}
+
+b8 heapCreateGrowable(u32 initialCapacity, Heap *outHeap) {
+    if (!outHeap) {
+        ENGINE_ERROR("heapCreateGrowable requires outHeap.")
+        return false;
+    }
+
+    outHeap->capacity = initialCapacity ? initialCapacity : 16;
+    outHeap->count = 0;
+    outHeap->entries = engineAllocateAlignedUninitialized(sizeof(HeapEntry) * outHeap->capacity,
+        HEAP_ALIGNMENT, MEMORY_TAG_BST);
+    outHeap->memory = 0;
+    outHeap->growable = true;
+
+    return outHeap->entries != 0;
+}
+
+void heapDestroy(Heap *heap) {
+    if (!heap) {
+        return;
+    }
+
+    for (u32 i = 0; i < heap->count; ++i) {
+        heap->entries[i].node->heapIndex = INVALID_ID;
+    }
+
+    if (heap->growable && heap->entries) {
+        engineFreeAligned(heap->entries, sizeof(HeapEntry) * heap->capacity, HEAP_ALIGNMENT, MEMORY_TAG_BST);
+    }
+
+    engineZeroMemory(heap, sizeof(Heap));
+}
+
+static b8 grow(Heap *heap) {
+    u32 capacity = heap->capacity * 2;
+    HeapEntry *entries = engineAllocateAlignedUninitialized(sizeof(HeapEntry) * capacity,
+        HEAP_ALIGNMENT, MEMORY_TAG_BST);
+    if (!entries) {
+        return false;
+    }
+
+    engineCopyMemory(entries, heap->entries, sizeof(HeapEntry) * heap->count);
+    engineFreeAligned(heap->entries, sizeof(HeapEntry) * heap->capacity, HEAP_ALIGNMENT, MEMORY_TAG_BST);
+    heap->entries = entries;
+    heap->capacity = capacity;
+
+    return true;
+}
+
+b8 heapPush(Heap *heap, HeapNode *node, u64 priority) {
+    if (!heap || !node) {
+        ENGINE_WARNING("heapPush requires heap and node to exist.")
+        return false;
+    }
+
+    if (heapNodeQueued(node)) {
+        ENGINE_WARNING("heapPush - node is already queued.")
+        return false;
+    }
+
+    if (heap->count == heap->capacity && (!heap->growable || !grow(heap))) {
+        ENGINE_ERROR("Heap is full (%u entries).", heap->capacity)
+        return false;
+    }
+
+    HeapEntry entry;
+    entry.priority = priority;
+    entry.node = node;
+    heap->entries[heap->count] = entry;
+    siftUp(heap, heap->count++);
+
+    return true;
+}
+
+HeapNode *heapPeek(Heap *heap, u64 *outPriority) {
+    if (!heap || heap->count == 0) {
+        return 0;
+    }
+
+    if (outPriority) {
+        *outPriority = heap->entries[0].priority;
+    }
+
+    return heap->entries[0].node;
+}
+
+HeapNode *heapPop(Heap *heap, u64 *outPriority) {
+    HeapNode *node = heapPeek(heap, outPriority);
+    if (node) {
+        heapRemove(heap, node);
+    }
+
+    return node;
+}
+
+b8 heapUpdate(Heap *heap, HeapNode *node, u64 priority) {
+    if (!heap || !ownsNode(heap, node)) {
+        return false;
+    }
+
+    u32 index = node->heapIndex;
+    u64 previous = heap->entries[index].priority;
+    heap->entries[index].priority = priority;
+    if (priority < previous) {
+        siftUp(heap, index);
+    } else if (priority > previous) {
+        siftDown(heap, index);
+    }
+
+    return true;
+}
+
+b8 heapRemove(Heap *heap, HeapNode *node) {
+    if (!heap || !ownsNode(heap, node)) {
+        return false;
+    }
+
+    /** Fill the hole with the last entry, then move that whichever way it needs to go. */
+    u32 index = node->heapIndex;
+    node->heapIndex = INVALID_ID;
+    heap->count--;
+    if (index == heap->count) {
+        return true;
+    }
+
+    u64 removed = heap->entries[index].priority;
+    heap->entries[index] = heap->entries[heap->count];
+    if (heap->entries[index].priority < removed) {
+        siftUp(heap, index);
+    } else {
+        siftDown(heap, index);
+    }
+
+    return true;
+}
@@ -0,0 +1,131 @@
+#ifndef __ENGINE_HEAP_H__
+#define __ENGINE_HEAP_H__
+
+#include "../defines.h"
+
+/** Children per node. Four keeps a node's children within one cache line of entries. */
+#define HEAP_ARITY 4
+
+/**
+ * @brief Embedded in whatever is being queued. The heap keeps heapIndex up to
+ * date as entries move, so an element can be found in the heap without a
+ * search. INVALID_ID while the element is not queued.
+ */
+typedef struct HeapNode {
+    u32 heapIndex;
+} HeapNode;
+
+/** Obtains the element a HeapNode is embedded in, given its type and member name. */
+#define HEAP_NODE_OWNER(node, type, member) ((type*)((u8*)(node) - (u64)&((type*)0)->member))
+
+/** @brief A queued node and its priority, stored side by side so sifting never follows the node pointer. */
+typedef struct HeapEntry {
+    u64 priority;
+    HeapNode *node;
+} HeapEntry;
+
+/**
+ * @brief An intrusive d-ary min-heap over a contiguous array. The entry with
+ * the lowest priority is popped first; negate or invert priorities for a
+ * max-heap. Members of this structure should not be modified outside the
+ * functions associated with it.
+ *
+ * Push and pop are O(log n) with HEAP_ARITY-way branching, which halves the
+ * depth of a binary heap. Any queued node can be reprioritized or removed in
+ * O(log n) through its heapIndex.
+ */
+typedef struct Heap {
+    u32 capacity;
+    u32 count;
+    HeapEntry *entries;
+
+    /** The block passed to heapCreate; 0 for growable heaps. */
+    void *memory;
+    b8 growable;
+} Heap;
+
+/**
+ * @brief Creates a fixed-capacity heap or obtains the memory requirement for one.
+ * Call twice; once passing 0 to memory to obtain the memory requirement,
+ * and a second time passing an allocated block to memory.
+ *
+ * @param capacity The maximum number of queued nodes.
+ * @param memoryRequirement A pointer to hold the memory requirement.
+ * @param memory 0, or a pre-allocated block of memory for the heap to use.
+ * @param outHeap A pointer to hold the heap.
+ * @return True on success; otherwise false.
+ */
+ENGINE_API b8 heapCreate(u32 capacity, u64 *memoryRequirement, void *memory, Heap *outHeap);
+
+/**
+ * @brief Creates a heap that owns its entries, tagged MEMORY_TAG_BST, and
+ * doubles them when full.
+ *
+ * @param initialCapacity The number of nodes to make room for up front.
+ * @param outHeap A pointer to hold the heap.
+ * @return True on success; otherwise false.
+ */
+ENGINE_API b8 heapCreateGrowable(u32 initialCapacity, Heap *outHeap);
+
+/** @brief Destroys the heap, marking every queued node as no longer queued. */
+ENGINE_API void heapDestroy(Heap *heap);
+
+/**
+ * @brief Queues a node.
+ *
+ * @param heap A pointer to the heap. Required.
+ * @param node The node to queue. Must not already be queued. Required.
+ * @param priority Lower values are popped first.
+ * @return True on success; false if the node is already queued or a fixed heap is full.
+ */
+ENGINE_API b8 heapPush(Heap *heap, HeapNode *node, u64 priority);
+
+/**
+ * @brief Obtains the node with the lowest priority without removing it.
+ *
+ * @param heap A pointer to the heap. Required.
+ * @param outPriority A pointer to hold its priority. May be 0.
+ * @return The node, or 0 if the heap is empty.
+ */
+ENGINE_API HeapNode *heapPeek(Heap *heap, u64 *outPriority);
+
+/**
+ * @brief Removes and returns the node with the lowest priority.
+ *
+ * @param heap A pointer to the heap. Required.
+ * @param outPriority A pointer to hold its priority. May be 0.
+ * @return The node, or 0 if the heap is empty.
+ */
+ENGINE_API HeapNode *heapPop(Heap *heap, u64 *outPriority);
+
+/**
+ * @brief Changes the priority of a queued node, moving it up for a decrease
+ * and down for an increase.
+ *
+ * @param heap A pointer to the heap. Required.
+ * @param node A node queued in this heap. Required.
+ * @param priority The new priority.
+ * @return True on success; false if the node is not queued in this heap.
+ */
+ENGINE_API b8 heapUpdate(Heap *heap, HeapNode *node, u64 priority);
+
+/**
+ * @brief Removes a queued node wherever it is in the heap.
+ *
+ * @param heap A pointer to the heap. Required.
+ * @param node A node queued in this heap. Required.
+ * @return True if the node was removed; false if it is not queued in this heap.
+ */
+ENGINE_API b8 heapRemove(Heap *heap, HeapNode *node);
+
+/** @brief Prepares a node for use; it starts out not queued. */
+ENGINE_INLINE void heapNodeInitialize(HeapNode *node) {
+    node->heapIndex = INVALID_ID;
+}
+
+/** @brief True if the node is currently queued in some heap. */
+ENGINE_INLINE b8 heapNodeQueued(const HeapNode *node) {
+    return node->heapIndex != INVALID_ID;
+}
+
+#endif
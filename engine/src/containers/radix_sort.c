@@ -0,0 +1,157 @@
+#include "radix_sort.h"
+
+#include "../core/logger.h"
+#include "../engine_memory/engine_memory.h"
+#include "../engine_memory/frame_allocator.h"
+
+#define RADIX_SORT_PASS_COUNT 8
+#define RADIX_SORT_BUCKET_COUNT 256
+
+/** Below this many items an insertion sort beats the eight histogram passes. */
+#define RADIX_SORT_SMALL_COUNT 64
+
+/** Chunks smaller than this are not worth handing to another thread. */
+#define RADIX_SORT_MIN_CHUNK 16384
+
+typedef u32 RadixHistogram[RADIX_SORT_PASS_COUNT][RADIX_SORT_BUCKET_COUNT];
+
+typedef struct HistogramTask {
+    const RadixSortItem *items;
+    u32 count;
+    u32 chunkSize;
+    RadixHistogram *histograms;
+} HistogramTask;
+
+/** Counts every byte of every key in one read of the items. */
+static void buildHistogram(const RadixSortItem *items, u32 count, RadixHistogram histogram) {
+    engineZeroMemory(histogram, sizeof(RadixHistogram));
+    for (u32 i = 0; i < count; ++i) {
+        u64 key = items[i].key;
+        for (u32 pass = 0; pass < RADIX_SORT_PASS_COUNT; ++pass) {
+            histogram[pass][(key >> (pass * 8)) & 0xff]++;
+        }
+    }
+}
+
+static void histogramTask(void *data, u32 index) {
+    HistogramTask *task = data;
+    u32 first = index * task->chunkSize;
+    u32 count = first < task->count ? task->count - first : 0;
+    if (count > task->chunkSize) {
+        count = task->chunkSize;
+    }
+
+    buildHistogram(task->items + first, count, task->histograms[index]);
+}
+
+static void insertionSort(RadixSortItem *items, u32 count) {
+    for (u32 i = 1; i < count; ++i) {
+        RadixSortItem item = items[i];
+        u32 j = i;
+        while (j > 0 && items[j - 1].key > item.key) {
+            items[j] = items[j - 1];
+            --j;
+        }
+
+        items[j] = item;
+    }
+}
+
+/** Builds the histogram of all items, in parallel chunks when that is worthwhile. */
+static void countDigits(const RadixSortItem *items, u32 count, const RadixSortParallel *parallel,
+    RadixHistogram histogram) {
+
+    u32 taskCount = parallel && parallel->parallelFor ? parallel->taskCount : 1;
+    if (taskCount > count / RADIX_SORT_MIN_CHUNK) {
+        taskCount = count / RADIX_SORT_MIN_CHUNK;
+    }
+
+    RadixHistogram *histograms = 0;
+    if (taskCount > 1) {
+        histograms = frameAllocate(sizeof(RadixHistogram) * taskCount, 64);
+    }
+
+    if (!histograms) {
+        buildHistogram(items, count, histogram);
+        return;
+    }
+
+    HistogramTask task;
+    task.items = items;
+    task.count = count;
+    task.chunkSize = (count + taskCount - 1) / taskCount;
+    task.histograms = histograms;
+    parallel->parallelFor(parallel->context, taskCount, histogramTask, &task);
+
+    engineCopyMemory(histogram, histograms[0], sizeof(RadixHistogram));
+    for (u32 t = 1; t < taskCount; ++t) {
+        for (u32 pass = 0; pass < RADIX_SORT_PASS_COUNT; ++pass) {
+            for (u32 bucket = 0; bucket < RADIX_SORT_BUCKET_COUNT; ++bucket) {
+                histogram[pass][bucket] += histograms[t][pass][bucket];
+            }
+        }
+    }
+}
+
+b8 radixSortParallel(RadixSortItem *items, u32 count, RadixSortItem *scratch,
+    const RadixSortParallel *parallel) {
+
+    if (!items || count < 2) {
+        return true;
+    }
+
+    if (count <= RADIX_SORT_SMALL_COUNT) {
+        insertionSort(items, count);
+        return true;
+    }
+
+    if (!scratch) {
+        scratch = frameAllocate(sizeof(RadixSortItem) * count, 16);
+        if (!scratch) {
+            ENGINE_ERROR("radixSort - frame allocator has no room for %u items of scratch.", count)
+            return false;
+        }
+    }
+
+    RadixHistogram histogram;
+    countDigits(items, count, parallel, histogram);
+
+    RadixSortItem *source = items;
+    RadixSortItem *destination = scratch;
+    for (u32 pass = 0; pass < RADIX_SORT_PASS_COUNT; ++pass) {
+        u32 shift = pass * 8;
+        u32 *buckets = histogram[pass];
+
+        /** Every key has the same byte here, so this pass would only copy. */
+        if (buckets[(source[0].key >> shift) & 0xff] == count) {
+            continue;
+        }
+
+        /** Turn the counts into each bucket's first output index. */
+        u32 offset = 0;
+        for (u32 bucket = 0; bucket < RADIX_SORT_BUCKET_COUNT; ++bucket) {
+            u32 bucketCount = buckets[bucket];
+            buckets[bucket] = offset;
+            offset += bucketCount;
+        }
+
+        for (u32 i = 0; i < count; ++i) {
+            destination[buckets[(source[i].key >> shift) & 0xff]++] = source[i];
+        }
+
+        RadixSortItem *swap = source;
+        source = destination;
+        destination = swap;
+    }
+
+    /** An odd number of passes leaves the result in scratch. */
+    if (source != items) {
+        engineCopyMemory(items, source, sizeof(RadixSortItem) * count);
+    }
+
+    return true;
+}
+
+b8 radixSort(RadixSortItem *items, u32 count, RadixSortItem *scratch) {
+    return radixSortParallel(items, count, scratch, 0);
+}
@@ -0,0 +1,63 @@
+#ifndef __ENGINE_RADIX_SORT_H__
+#define __ENGINE_RADIX_SORT_H__
+
+#include "../defines.h"
+
+/**
+ * @brief A sort key and what it refers to, such as a draw item packed as
+ * pipeline | material | depth, or a job priority.
+ */
+typedef struct RadixSortItem {
+    u64 key;
+    u32 payload;
+    u32 reserved;
+} RadixSortItem;
+
+/** A task run by a parallel for; index is in [0, taskCount). */
+typedef void (*PFN_radixSortTask)(void *data, u32 index);
+
+/**
+ * Runs task for every index in [0, taskCount), possibly on several threads,
+ * and returns once all of them have finished.
+ */
+typedef void (*PFN_radixSortParallelFor)(void *context, u32 taskCount, PFN_radixSortTask task, void *data);
+
+/**
+ * @brief How to split the histogram pass across threads. The scatter passes
+ * always run on the calling thread.
+ */
+typedef struct RadixSortParallel {
+    PFN_radixSortParallelFor parallelFor;
+    void *context;
+
+    /** Number of chunks the items are split into; usually the worker count. */
+    u32 taskCount;
+} RadixSortParallel;
+
+/**
+ * @brief Sorts items by key, ascending, with an 8-bit LSD radix sort. The
+ * sort is stable. Byte positions every key shares are skipped, so narrow
+ * keys cost fewer passes.
+ *
+ * @param items The items to sort. Sorted in place. Required.
+ * @param count The number of items.
+ * @param scratch 0, or a buffer of at least count items to ping-pong through.
+ * When 0, one is taken from the frame allocator.
+ * @return True on success; false if no scratch buffer could be obtained.
+ */
+ENGINE_API b8 radixSort(RadixSortItem *items, u32 count, RadixSortItem *scratch);
+
+/**
+ * @brief radixSort with the histograms built in parallel chunks. The
+ * per-chunk histograms come from the frame allocator.
+ *
+ * @param items The items to sort. Sorted in place. Required.
+ * @param count The number of items.
+ * @param scratch 0, or a buffer of at least count items.
+ * @param parallel How to run the histogram chunks. 0 sorts serially.
+ * @return True on success; false if no scratch buffer could be obtained.
+ */
+ENGINE_API b8 radixSortParallel(RadixSortItem *items, u32 count, RadixSortItem *scratch,
+    const RadixSortParallel *parallel);
+
+#endif
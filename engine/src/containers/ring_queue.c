@@ -0,0 +1,227 @@
+#include "ring_queue.h"
+
+#include "../core/atomic.h"
+#include "../core/logger.h"
+#include "../engine_memory/engine_memory.h"
+
+#define RING_QUEUE_CACHE_LINE 64
+
+typedef struct SpscQueueState {
+    u64 elementSize;
+    u64 capacity;
+    u64 mask;
+    u8 *buffer;
+    u64 memorySize;
+    u8 padding0[RING_QUEUE_CACHE_LINE - (5 * sizeof(u64))];
+
+    /** Written by the producer. cachedHead is the producer's last look at head. */
+    volatile u64 tail;
+    u64 cachedHead;
+    u8 padding1[RING_QUEUE_CACHE_LINE - (2 * sizeof(u64))];
+
+    /** Written by the consumer. cachedTail is the consumer's last look at tail. */
+    volatile u64 head;
+    u64 cachedTail;
+    u8 padding2[RING_QUEUE_CACHE_LINE - (2 * sizeof(u64))];
+} SpscQueueState;
+
+typedef struct MpmcQueueState {
+    u64 elementSize;
+    u64 mask;
+
+    /** Bytes per slot: the sequence number then the element, rounded to 16. */
+    u64 slotStride;
+    u8 *slots;
+    u64 memorySize;
+    u8 padding0[RING_QUEUE_CACHE_LINE - (5 * sizeof(u64))];
+
+    volatile u64 enqueuePosition;
+    u8 padding1[RING_QUEUE_CACHE_LINE - sizeof(u64)];
+
+    volatile u64 dequeuePosition;
+    u8 padding2[RING_QUEUE_CACHE_LINE - sizeof(u64)];
+} MpmcQueueState;
+
+static u64 roundToPowerOfTwo(u64 value) {
+    u64 result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+
+    return result;
+}
+
+b8 spscQueueCreate(u64 elementSize, u32 capacity, SpscQueue *outQueue) {
+    if (!outQueue || !elementSize || !capacity) {
+        ENGINE_ERROR("spscQueueCreate requires outQueue, elementSize and capacity to be non-zero.")
+        return false;
+    }
+
+    u64 slotCount = roundToPowerOfTwo(capacity);
+    u64 memorySize = sizeof(SpscQueueState) + (slotCount * elementSize);
+    SpscQueueState *state = engineAllocateAligned(memorySize, RING_QUEUE_CACHE_LINE, MEMORY_TAG_RING_QUEUE);
+    if (!state) {
+        ENGINE_ERROR("spscQueueCreate - unable to allocate %lluB for the queue.", memorySize)
+        return false;
+    }
+
+    state->elementSize = elementSize;
+    state->capacity = slotCount;
+    state->mask = slotCount - 1;
+    state->buffer = (u8*)state + sizeof(SpscQueueState);
+    state->memorySize = memorySize;
+
+    outQueue->memory = state;
+
+    return true;
+}
+
+void spscQueueDestroy(SpscQueue *queue) {
+    if (queue && queue->memory) {
+        SpscQueueState *state = queue->memory;
+        engineFreeAligned(state, state->memorySize, RING_QUEUE_CACHE_LINE, MEMORY_TAG_RING_QUEUE);
+        queue->memory = 0;
+    }
+}
+
+b8 spscQueuePush(SpscQueue *queue, const void *element) {
+    SpscQueueState *state = queue->memory;
+    u64 tail = state->tail;
+
+    if (tail - state->cachedHead == state->capacity) {
+        state->cachedHead = atomicLoad64(&state->head);
+        if (tail - state->cachedHead == state->capacity) {
+            return false;
+        }
+    }
+
+    engineCopyMemory(state->buffer + ((tail & state->mask) * state->elementSize), element, state->elementSize);
+
+    /** Publishes the element; the store orders the copy above before it. */
+    atomicStore64(&state->tail, tail + 1);
+
+    return true;
+}
+
+b8 spscQueuePop(SpscQueue *queue, void *outElement) {
+    SpscQueueState *state = queue->memory;
+    u64 head = state->head;
+
+    if (head == state->cachedTail) {
+        state->cachedTail = atomicLoad64(&state->tail);
+        if (head == state->cachedTail) {
+            return false;
+        }
+    }
+
+    engineCopyMemory(outElement, state->buffer + ((head & state->mask) * state->elementSize), state->elementSize);
+
+    /** Hands the slot back to the producer. */
+    atomicStore64(&state->head, head + 1);
+
+    return true;
+}
+
+u64 spscQueueCount(SpscQueue *queue) {
+    SpscQueueState *state = queue->memory;
+    return atomicLoad64(&state->tail) - atomicLoad64(&state->head);
+}
+
+b8 mpmcQueueCreate(u64 elementSize, u32 capacity, MpmcQueue *outQueue) {
+    if (!outQueue || !elementSize || !capacity) {
+        ENGINE_ERROR("mpmcQueueCreate requires outQueue, elementSize and capacity to be non-zero.")
+        return false;
+    }
+
+    /** A single slot cannot tell "ready to write" from "ready to read" apart. */
+    u64 slotCount = roundToPowerOfTwo(capacity < 2 ? 2 : capacity);
+    u64 slotStride = (sizeof(u64) + elementSize + 15) & ~15ULL;
+    u64 memorySize = sizeof(MpmcQueueState) + (slotCount * slotStride);
+    MpmcQueueState *state = engineAllocateAligned(memorySize, RING_QUEUE_CACHE_LINE, MEMORY_TAG_RING_QUEUE);
+    if (!state) {
+        ENGINE_ERROR("mpmcQueueCreate - unable to allocate %lluB for the queue.", memorySize)
+        return false;
+    }
+
+    state->elementSize = elementSize;
+    state->mask = slotCount - 1;
+    state->slotStride = slotStride;
+    state->slots = (u8*)state + sizeof(MpmcQueueState);
+    state->memorySize = memorySize;
+
+    /** Slot i is first ready for the producer that claims position i. */
+    for (u64 i = 0; i < slotCount; ++i) {
+        *(volatile u64*)(state->slots + (i * slotStride)) = i;
+    }
+
+    outQueue->memory = state;
+
+    return true;
+}
+
+void mpmcQueueDestroy(MpmcQueue *queue) {
+    if (queue && queue->memory) {
+        MpmcQueueState *state = queue->memory;
+        engineFreeAligned(state, state->memorySize, RING_QUEUE_CACHE_LINE, MEMORY_TAG_RING_QUEUE);
+        queue->memory = 0;
+    }
+}
+
+b8 mpmcQueuePush(MpmcQueue *queue, const void *element) {
+    MpmcQueueState *state = queue->memory;
+    u64 position = atomicLoad64(&state->enqueuePosition);
+    u8 *slot = 0;
+
+    for (;;) {
+        slot = state->slots + ((position & state->mask) * state->slotStride);
+        u64 sequence = atomicLoad64((volatile u64*)slot);
+        i64 difference = (i64)(sequence - position);
+
+        if (difference == 0) {
+            /** On failure position is refreshed and the loop retries with it. */
+            if (atomicCompareExchange64(&state->enqueuePosition, &position, position + 1)) {
+                break;
+            }
+        } else if (difference < 0) {
+            /** The slot still holds an element from a lap ago: full. */
+            return false;
+        } else {
+            position = atomicLoad64(&state->enqueuePosition);
+        }
+    }
+
+    engineCopyMemory(slot + sizeof(u64), element, state->elementSize);
+    atomicStore64((volatile u64*)slot, position + 1);
+
+    return true;
+}
+
+b8 mpmcQueuePop(MpmcQueue *queue, void *outElement) {
+    MpmcQueueState *state = queue->memory;
+    u64 position = atomicLoad64(&state->dequeuePosition);
+    u8 *slot = 0;
+
+    for (;;) {
+        slot = state->slots + ((position & state->mask) * state->slotStride);
+        u64 sequence = atomicLoad64((volatile u64*)slot);
+        i64 difference = (i64)(sequence - (position + 1));
+
+        if (difference == 0) {
+            if (atomicCompareExchange64(&state->dequeuePosition, &position, position + 1)) {
+                break;
+            }
+        } else if (difference < 0) {
+            /** Nothing has been published to this slot yet: empty. */
+            return false;
+        } else {
+            position = atomicLoad64(&state->dequeuePosition);
+        }
+    }
+
+    engineCopyMemory(outElement, slot + sizeof(u64), state->elementSize);
+
+    /** Ready for the producer one lap later. */
+    atomicStore64((volatile u64*)slot, position + state->mask + 1);
+
+    return true;
+}
@@ -0,0 +1,83 @@
+#ifndef __ENGINE_RING_QUEUE_H__
+#define __ENGINE_RING_QUEUE_H__
+
+#include "../defines.h"
+
+/**
+ * @brief A bounded, lock-free queue for exactly one producing thread and one
+ * consuming thread. The two indices live on separate cache lines and each side
+ * caches the other's index, so the shared lines are only touched when the
+ * queue looks full or empty.
+ */
+typedef struct SpscQueue {
+    /** Internal state, followed by the element buffer. */
+    void *memory;
+} SpscQueue;
+
+/**
+ * @brief A bounded, lock-free queue for any number of producing and consuming
+ * threads. Each slot carries a sequence number which tells a thread whether
+ * the slot is ready for it, so threads only contend on a single compare-exchange
+ * of the shared position.
+ */
+typedef struct MpmcQueue {
+    /** Internal state, followed by the slots. */
+    void *memory;
+} MpmcQueue;
+
+/**
+ * @brief Creates a single-producer/single-consumer queue. Storage is allocated
+ * with MEMORY_TAG_RING_QUEUE.
+ *
+ * @param elementSize The size of each element in bytes.
+ * @param capacity The number of elements the queue holds. Rounded up to a power of two.
+ * @param outQueue A pointer to hold the queue.
+ * @return True on success; otherwise false.
+ */
+ENGINE_API b8 spscQueueCreate(u64 elementSize, u32 capacity, SpscQueue *outQueue);
+ENGINE_API void spscQueueDestroy(SpscQueue *queue);
+
+/**
+ * @brief Copies an element onto the back of the queue. Producer thread only.
+ *
+ * @return True if the element was queued; false if the queue is full.
+ */
+ENGINE_API b8 spscQueuePush(SpscQueue *queue, const void *element);
+
+/**
+ * @brief Copies the element at the front of the queue out and removes it. Consumer thread only.
+ *
+ * @return True if an element was written to outElement; false if the queue is empty.
+ */
+ENGINE_API b8 spscQueuePop(SpscQueue *queue, void *outElement);
+
+/** @brief Obtains the number of queued elements. Only exact when both sides are idle. */
+ENGINE_API u64 spscQueueCount(SpscQueue *queue);
+
+/**
+ * @brief Creates a multi-producer/multi-consumer queue. Storage is allocated
+ * with MEMORY_TAG_RING_QUEUE.
+ *
+ * @param elementSize The size of each element in bytes.
+ * @param capacity The number of elements the queue holds. Rounded up to a power of two, at least 2.
+ * @param outQueue A pointer to hold the queue.
+ * @return True on success; otherwise false.
+ */
+ENGINE_API b8 mpmcQueueCreate(u64 elementSize, u32 capacity, MpmcQueue *outQueue);
+ENGINE_API void mpmcQueueDestroy(MpmcQueue *queue);
+
+/**
+ * @brief Copies an element onto the back of the queue. Safe from any thread.
+ *
+ * @return True if the element was queued; false if the queue is full.
+ */
+ENGINE_API b8 mpmcQueuePush(MpmcQueue *queue, const void *element);
+
+/**
+ * @brief Copies the element at the front of the queue out and removes it. Safe from any thread.
+ *
+ * @return True if an element was written to outElement; false if the queue is empty.
+ */
+ENGINE_API b8 mpmcQueuePop(MpmcQueue *queue, void *outElement);
+
+#endif
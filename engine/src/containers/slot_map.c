@@ -0,0 +1,141 @@
+#include "slot_map.h"
+
+#include "../engine_memory/engine_memory.h"
+
+#include "../core/logger.h"
+
+static u64 roundTo16(u64 size) {
+    return (size + 15) & ~15ULL;
+}
+
+b8 slotMapCreate(u64 elementSize, u32 capacity, u64 *memoryRequirement, void *memory, SlotMap *outMap) {
+    if (!memoryRequirement) {
+        ENGINE_ERROR("slotMapCreate requires memoryRequirement to exist. Create failed.")
+        return false;
+    }
+
+    if (!elementSize || !capacity || capacity == INVALID_ID) {
+        ENGINE_ERROR("slotMapCreate - elementSize and capacity must be a positive non-zero value!")
+        return false;
+    }
+
+    /** Elements first, to keep the alignment of the block, then the three index arrays. */
+    u64 elementsRequirement = roundTo16(elementSize * capacity);
+    u64 indexRequirement = roundTo16(sizeof(u32) * capacity);
+    *memoryRequirement = elementsRequirement + (indexRequirement * 3);
+
+    if (!memory) {
+        return true;
+    }
+
+    if (!outMap) {
+        ENGINE_ERROR("slotMapCreate requires outMap to exist. Create failed.")
+        return false;
+    }
+
+    outMap->elementSize = elementSize;
+    outMap->capacity = capacity;
+    outMap->count = 0;
+    outMap->memory = memory;
+    outMap->elements = memory;
+    outMap->generations = (u32*)(outMap->elements + elementsRequirement);
+    outMap->dense = (u32*)((u8*)outMap->generations + indexRequirement);
+    outMap->sparse = (u32*)((u8*)outMap->dense + indexRequirement);
+
+    engineZeroMemory(memory, *memoryRequirement);
+
+    /** Thread the free list through sparse, lowest slot first. */
+    for (u32 i = 0; i < capacity; ++i) {
+        outMap->sparse[i] = i + 1 < capacity ? i + 1 : INVALID_ID;
+    }
+    outMap->freeHead = 0;
+
+    return true;
+}
+
+void slotMapDestroy(SlotMap *map) {
+    if (map) {
+        engineZeroMemory(map, sizeof(SlotMap));
+    }
+}
+
+void slotMapFill(SlotMap *map, const void *value) {
+    if (!map || !map->memory || !value) {
+        ENGINE_WARNING("slotMapFill requires map and value to exist.")
+        return;
+    }
+
+    for (u32 slot = map->freeHead; slot != INVALID_ID; slot = map->sparse[slot]) {
+        engineCopyMemory(map->elements + (map->elementSize * slot), value, map->elementSize);
+    }
+}
+
+SlotMapHandle slotMapInsert(SlotMap *map, void **outElement) {
+    if (!map || !map->memory || map->freeHead == INVALID_ID) {
+        return slotMapInvalidHandle();
+    }
+
+    u32 slot = map->freeHead;
+    map->freeHead = map->sparse[slot];
+
+    map->sparse[slot] = map->count;
+    map->dense[map->count++] = slot;
+
+    if (outElement) {
+        *outElement = map->elements + (map->elementSize * slot);
+    }
+
+    SlotMapHandle handle = { slot, map->generations[slot] };
+    return handle;
+}
+
+static b8 isLive(const SlotMap *map, SlotMapHandle handle) {
+    if (!map || !map->memory || handle.index >= map->capacity ||
+        map->generations[handle.index] != handle.generation) {
+
+        return false;
+    }
+
+    u32 position = map->sparse[handle.index];
+    return position < map->count && map->dense[position] == handle.index;
+}
+
+b8 slotMapRemove(SlotMap *map, SlotMapHandle handle) {
+    if (!isLive(map, handle)) {
+        return false;
+    }
+
+    /** Fill the hole in dense with the last live slot. */
+    u32 position = map->sparse[handle.index];
+    u32 last = map->dense[--map->count];
+    map->dense[position] = last;
+    map->sparse[last] = position;
+
+    map->generations[handle.index]++;
+    map->sparse[handle.index] = map->freeHead;
+    map->freeHead = handle.index;
+
+    return true;
+}
+
+void *slotMapGet(SlotMap *map, SlotMapHandle handle) {
+    if (!isLive(map, handle)) {
+        return 0;
+    }
+
+    return map->elements + (map->elementSize * handle.index);
+}
+
+void *slotMapGetLive(SlotMap *map, u32 i, SlotMapHandle *outHandle) {
+    if (!map || !map->memory || i >= map->count) {
+        return 0;
+    }
+
+    u32 slot = map->dense[i];
+    if (outHandle) {
+        outHandle->index = slot;
+        outHandle->generation = map->generations[slot];
+    }
+
+    return map->elements + (map->elementSize * slot);
+}
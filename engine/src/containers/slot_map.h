@@ -0,0 +1,113 @@
+#ifndef __ENGINE_SLOT_MAP_H__
+#define __ENGINE_SLOT_MAP_H__
+
+#include "../defines.h"
+
+/**
+ * @brief Refers to an element of a slot map. The generation is bumped every
+ * time the slot is released, so handles to a released element stop resolving
+ * even after the slot has been reused.
+ */
+typedef struct SlotMapHandle {
+    u32 index;
+    u32 generation;
+} SlotMapHandle;
+
+/**
+ * @brief A fixed-capacity pool of elements addressed by generational handles.
+ * Members of this structure should not be modified outside the functions
+ * associated with it.
+ *
+ * Elements never move, so pointers to them stay valid while they are live.
+ * Free slots are kept on a free list, making insert and remove O(1), and the
+ * indices of live slots are kept packed so walking them never visits a free
+ * slot. A slot keeps whatever its element last held until it is reused.
+ */
+typedef struct SlotMap {
+    u64 elementSize;
+    u32 capacity;
+
+    /** Number of live elements. */
+    u32 count;
+    void *memory;
+
+    /** Element storage, indexed by slot. */
+    u8 *elements;
+    u32 *generations;
+
+    /** Live slot indices, packed into 0..count-1. */
+    u32 *dense;
+
+    /** For a live slot, its position in dense; for a free slot, the next free slot. */
+    u32 *sparse;
+    u32 freeHead;
+} SlotMap;
+
+/**
+ * @brief Creates a slot map or obtains the memory requirement for one.
+ * Call twice; once passing 0 to memory to obtain the memory requirement,
+ * and a second time passing an allocated block to memory.
+ *
+ * @param elementSize The size of each element in bytes.
+ * @param capacity The maximum number of live elements.
+ * @param memoryRequirement A pointer to hold the memory requirement.
+ * @param memory 0, or a pre-allocated block of memory for the map to use.
+ * @param outMap A pointer to hold the slot map.
+ * @return True on success; otherwise false.
+ */
+ENGINE_API b8 slotMapCreate(u64 elementSize, u32 capacity, u64 *memoryRequirement, void *memory,
+    SlotMap *outMap);
+
+/** @brief Destroys the given slot map. Does not release the memory passed to slotMapCreate. */
+ENGINE_API void slotMapDestroy(SlotMap *map);
+
+/**
+ * @brief Copies value into every free slot. Useful for giving elements a
+ * known "unused" state before they are first inserted.
+ *
+ * @param map A pointer to the slot map. Required.
+ * @param value The value to copy. Required.
+ */
+ENGINE_API void slotMapFill(SlotMap *map, const void *value);
+
+/**
+ * @brief Claims a free slot.
+ *
+ * @param map A pointer to the slot map. Required.
+ * @param outElement A pointer to hold the element of the new slot. Optional.
+ * @return The handle of the new element; index is INVALID_ID if the map is full.
+ */
+ENGINE_API SlotMapHandle slotMapInsert(SlotMap *map, void **outElement);
+
+/**
+ * @brief Releases the element referred to by handle.
+ *
+ * @return True if the handle was live; otherwise false.
+ */
+ENGINE_API b8 slotMapRemove(SlotMap *map, SlotMapHandle handle);
+
+/**
+ * @brief Resolves a handle.
+ *
+ * @return The element, or 0 if the handle is invalid or stale.
+ */
+ENGINE_API void *slotMapGet(SlotMap *map, SlotMapHandle handle);
+
+/**
+ * @brief Obtains the live element at position i, for 0 <= i < map->count.
+ * Removal reorders positions, so walk backwards when removing while iterating.
+ *
+ * @param map A pointer to the slot map. Required.
+ * @param i The position among live elements.
+ * @param outHandle A pointer to hold the element's handle. Optional.
+ * @return The element, or 0 if i is out of range.
+ */
+ENGINE_API void *slotMapGetLive(SlotMap *map, u32 i, SlotMapHandle *outHandle);
+
+/** @brief Obtains a handle that never resolves. */
+ENGINE_INLINE SlotMapHandle slotMapInvalidHandle() {
+    SlotMapHandle handle = { INVALID_ID, INVALID_ID };
+    return handle;
+}
+
+#endif
@@ -0,0 +1,234 @@
+#include "soa_array.h"
+
+#include "../core/logger.h"
+#include "../engine_memory/engine_memory.h"
+
+static u64 alignColumn(u64 size) {
+    return (size + SOA_ARRAY_COLUMN_ALIGNMENT - 1) & ~(u64)(SOA_ARRAY_COLUMN_ALIGNMENT - 1);
+}
+
+static u64 blockSize(u32 columnCount, const u64 *columnStrides, u32 capacity) {
+    u64 size = 0;
+    for (u32 i = 0; i < columnCount; ++i) {
+        size += alignColumn(columnStrides[i] * capacity);
+    }
+
+    return size;
+}
+
+static b8 validColumns(u32 columnCount, const u64 *columnStrides) {
+    if (columnCount == 0 || columnCount > SOA_ARRAY_MAX_COLUMNS || !columnStrides) {
+        ENGINE_ERROR("SoA arrays need between 1 and %u columns.", SOA_ARRAY_MAX_COLUMNS)
+        return false;
+    }
+
+    for (u32 i = 0; i < columnCount; ++i) {
+        if (columnStrides[i] == 0) {
+            ENGINE_ERROR("SoA array column %u has a stride of 0.", i)
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/** Points the columns into memory, laid out back to back. */
+static void carveColumns(SoaArray *array, void *memory, u32 capacity) {
+    u8 *column = memory;
+    for (u32 i = 0; i < array->columnCount; ++i) {
+        array->columns[i] = column;
+        column += alignColumn(array->columnStrides[i] * capacity);
+    }
+
+    array->memory = memory;
+    array->capacity = capacity;
+}
+
+static void initialize(SoaArray *array, u32 columnCount, const u64 *columnStrides) {
+    engineZeroMemory(array, sizeof(SoaArray));
+    array->columnCount = columnCount;
+    for (u32 i = 0; i < columnCount; ++i) {
+        array->columnStrides[i] = columnStrides[i];
+    }
+}
+
+b8 soaArrayCreate(u32 columnCount, const u64 *columnStrides, u32 capacity,
+    u64 *memoryRequirement, void *memory, SoaArray *outArray) {
+
+    if (!memoryRequirement || !validColumns(columnCount, columnStrides)) {
+        return false;
+    }
+
+    *memoryRequirement = blockSize(columnCount, columnStrides, capacity);
+    if (!memory) {
+        return true;
+    }
+
+    if (!outArray) {
+        ENGINE_ERROR("soaArrayCreate requires outArray when memory is passed.")
+        return false;
+    }
+
+    initialize(outArray, columnCount, columnStrides);
+    outArray->memorySize = *memoryRequirement;
+    carveColumns(outArray, memory, capacity);
+
+    return true;
+}
+
+b8 soaArrayCreateGrowable(u32 columnCount, const u64 *columnStrides, u32 initialCapacity,
+    SoaArray *outArray) {
+
+    if (!outArray || !validColumns(columnCount, columnStrides)) {
+        return false;
+    }
+
+    initialize(outArray, columnCount, columnStrides);
+    outArray->growable = true;
+
+    return soaArrayReserve(outArray, initialCapacity ? initialCapacity : 16);
+}
+
+void soaArrayDestroy(SoaArray *array) {
+    if (!array) {
+        return;
+    }
+
+    if (array->growable && array->memory) {
+        engineFreeAligned(array->memory, array->memorySize, SOA_ARRAY_COLUMN_ALIGNMENT, MEMORY_TAG_ARRAY);
+    }
+
+    engineZeroMemory(array, sizeof(SoaArray));
+}
+
+b8 soaArrayReserve(SoaArray *array, u32 capacity) {
+    if (capacity <= array->capacity) {
+        return true;
+    }
+
+    if (!array->growable) {
+        ENGINE_ERROR("SoA array is full (%u rows) and cannot grow.", array->capacity)
+        return false;
+    }
+
+    u64 size = blockSize(array->columnCount, array->columnStrides, capacity);
+    void *memory = engineAllocateAligned(size, SOA_ARRAY_COLUMN_ALIGNMENT, MEMORY_TAG_ARRAY);
+    if (!memory) {
+        return false;
+    }
+
+    /** Columns are copied one by one, since each one's offset depends on the capacity. */
+    void *previous = array->memory;
+    u64 previousSize = array->memorySize;
+    u8 *previousColumns[SOA_ARRAY_MAX_COLUMNS];
+    for (u32 i = 0; i < array->columnCount; ++i) {
+        previousColumns[i] = array->columns[i];
+    }
+
+    carveColumns(array, memory, capacity);
+    array->memorySize = size;
+    if (previous) {
+        for (u32 i = 0; i < array->columnCount; ++i) {
+            engineCopyMemory(array->columns[i], previousColumns[i], array->columnStrides[i] * array->length);
+        }
+
+        engineFreeAligned(previous, previousSize, SOA_ARRAY_COLUMN_ALIGNMENT, MEMORY_TAG_ARRAY);
+    }
+
+    return true;
+}
+
+/** Makes room for count more rows, doubling growable arrays as needed. */
+static b8 ensureRoom(SoaArray *array, u32 count) {
+    u64 required = (u64)array->length + count;
+    if (required <= array->capacity) {
+        return true;
+    }
+
+    u64 capacity = array->capacity ? array->capacity : 16;
+    while (capacity < required) {
+        capacity *= 2;
+    }
+
+    return capacity < INVALID_ID && soaArrayReserve(array, (u32)capacity);
+}
+
+u32 soaArrayPush(SoaArray *array, const void **values) {
+    if (!array || !ensureRoom(array, 1)) {
+        return INVALID_ID;
+    }
+
+    u32 index = array->length++;
+    for (u32 i = 0; i < array->columnCount; ++i) {
+        u64 stride = array->columnStrides[i];
+        u8 *element = array->columns[i] + (stride * index);
+        if (values && values[i]) {
+            engineCopyMemory(element, values[i], stride);
+        } else {
+            engineZeroMemory(element, stride);
+        }
+    }
+
+    return index;
+}
+
+u32 soaArrayAppend(SoaArray *array, u32 count) {
+    if (!array || !ensureRoom(array, count)) {
+        return INVALID_ID;
+    }
+
+    u32 first = array->length;
+    for (u32 i = 0; i < array->columnCount; ++i) {
+        u64 stride = array->columnStrides[i];
+        engineZeroMemory(array->columns[i] + (stride * first), stride * count);
+    }
+
+    array->length += count;
+
+    return first;
+}
+
+b8 soaArraySwapRemove(SoaArray *array, u32 index) {
+    if (!array || index >= array->length) {
+        ENGINE_ERROR("soaArraySwapRemove - index %u outside the bounds of the array.", index)
+        return false;
+    }
+
+    u32 last = --array->length;
+    if (index != last) {
+        for (u32 i = 0; i < array->columnCount; ++i) {
+            u64 stride = array->columnStrides[i];
+            engineCopyMemory(array->columns[i] + (stride * index), array->columns[i] + (stride * last), stride);
+        }
+    }
+
+    return true;
+}
+
+void soaArrayClear(SoaArray *array) {
+    if (array) {
+        array->length = 0;
+    }
+}
+
+b8 soaArrayNextSpan(SoaArray *array, u32 spanLength, SoaArraySpan *span) {
+    if (!array || !span) {
+        return false;
+    }
+
+    u32 first = span->first + span->count;
+    if (first >= array->length) {
+        span->first = array->length;
+        span->count = 0;
+        return false;
+    }
+
+    u32 remaining = array->length - first;
+    span->first = first;
+    span->count = spanLength && spanLength < remaining ? spanLength : remaining;
+    for (u32 i = 0; i < array->columnCount; ++i) {
+        span->columns[i] = array->columns[i] + (array->columnStrides[i] * first);
+    }
+
+    return true;
+}
@@ -0,0 +1,129 @@
+#ifndef __ENGINE_SOA_ARRAY_H__
+#define __ENGINE_SOA_ARRAY_H__
+
+#include "../defines.h"
+
+#define SOA_ARRAY_MAX_COLUMNS 16
+
+/** Every column starts on a cache line, which also suits aligned SIMD loads. */
+#define SOA_ARRAY_COLUMN_ALIGNMENT 64
+
+/**
+ * @brief Structure-of-arrays storage: one array per field, all with the same
+ * length, carved from one block. Row i is element i of every column.
+ * Members of this structure should not be modified outside the functions
+ * associated with it.
+ *
+ * Kernels that touch only some fields stream just those columns instead of
+ * dragging whole structs through the cache.
+ */
+typedef struct SoaArray {
+    u32 columnCount;
+    u32 capacity;
+
+    /** Number of rows in use; shared by every column. */
+    u32 length;
+
+    u64 columnStrides[SOA_ARRAY_MAX_COLUMNS];
+    u8 *columns[SOA_ARRAY_MAX_COLUMNS];
+
+    /** The block the columns are carved from; owned by growable arrays. */
+    void *memory;
+    u64 memorySize;
+    b8 growable;
+} SoaArray;
+
+/**
+ * @brief A run of consecutive rows, with each column pointer already offset
+ * to the first of them.
+ */
+typedef struct SoaArraySpan {
+    u32 first;
+    u32 count;
+    void *columns[SOA_ARRAY_MAX_COLUMNS];
+} SoaArraySpan;
+
+/**
+ * @brief Creates a fixed-capacity array or obtains the memory requirement for one.
+ * Call twice; once passing 0 to memory to obtain the memory requirement,
+ * and a second time passing an allocated block to memory. The block should
+ * be aligned to SOA_ARRAY_COLUMN_ALIGNMENT.
+ *
+ * @param columnCount The number of columns, up to SOA_ARRAY_MAX_COLUMNS.
+ * @param columnStrides The size in bytes of one element of each column.
+ * @param capacity The maximum number of rows.
+ * @param memoryRequirement A pointer to hold the memory requirement.
+ * @param memory 0, or a pre-allocated block of memory for the array to use.
+ * @param outArray A pointer to hold the array.
+ * @return True on success; otherwise false.
+ */
+ENGINE_API b8 soaArrayCreate(u32 columnCount, const u64 *columnStrides, u32 capacity,
+    u64 *memoryRequirement, void *memory, SoaArray *outArray);
+
+/**
+ * @brief Creates an array that owns its block, tagged MEMORY_TAG_ARRAY, and
+ * doubles it when full.
+ *
+ * @param columnCount The number of columns, up to SOA_ARRAY_MAX_COLUMNS.
+ * @param columnStrides The size in bytes of one element of each column.
+ * @param initialCapacity The number of rows to make room for up front.
+ * @param outArray A pointer to hold the array.
+ * @return True on success; otherwise false.
+ */
+ENGINE_API b8 soaArrayCreateGrowable(u32 columnCount, const u64 *columnStrides, u32 initialCapacity,
+    SoaArray *outArray);
+
+ENGINE_API void soaArrayDestroy(SoaArray *array);
+
+/**
+ * @brief Makes room for at least capacity rows. Only growable arrays can grow.
+ *
+ * @return True if the array can hold capacity rows; otherwise false.
+ */
+ENGINE_API b8 soaArrayReserve(SoaArray *array, u32 capacity);
+
+/**
+ * @brief Appends a row.
+ *
+ * @param array A pointer to the array. Required.
+ * @param values One pointer per column to the value to copy in, or 0 to
+ * zero the whole row. Individual pointers may also be 0 to zero that column.
+ * @return The index of the new row; INVALID_ID if the array is full.
+ */
+ENGINE_API u32 soaArrayPush(SoaArray *array, const void **values);
+
+/**
+ * @brief Appends count zeroed rows, to be filled column by column.
+ *
+ * @return The index of the first new row; INVALID_ID if they do not fit.
+ */
+ENGINE_API u32 soaArrayAppend(SoaArray *array, u32 count);
+
+/**
+ * @brief Removes a row by moving the last row into its place, in every column.
+ * Row order is not preserved.
+ *
+ * @return True if the row existed; otherwise false.
+ */
+ENGINE_API b8 soaArraySwapRemove(SoaArray *array, u32 index);
+
+/** @brief Removes every row. Capacity is kept. */
+ENGINE_API void soaArrayClear(SoaArray *array);
+
+/**
+ * @brief Walks the rows in runs of at most spanLength, for processing a
+ * column or a handful of columns at a time. Start from a zeroed span.
+ *
+ * @param array A pointer to the array. Required.
+ * @param spanLength The most rows per span; 0 for all remaining rows at once.
+ * @param span A pointer to the span to advance. Required.
+ * @return True if span now holds rows; false once every row has been visited.
+ */
+ENGINE_API b8 soaArrayNextSpan(SoaArray *array, u32 spanLength, SoaArraySpan *span);
+
+/** @brief Obtains the start of a column. Invalidated when a growable array grows. */
+ENGINE_INLINE void *soaArrayColumn(SoaArray *array, u32 column) {
+    return array->columns[column];
+}
+
+#endif
@@ -8,12 +8,18 @@
 #include "event.h"
 #include "input.h"
 #include "clock.h"
-#include "../engine_memory/linear_allocator.h"
+#include "../engine_memory/virtual_arena.h"
+#include "../engine_memory/frame_allocator.h"
+#include "../engine_memory/stack_allocator.h"
+#include "job_system.h"
+#include "parallel_for.h"
+#include "task_graph.h"
 #include "../../../editor/src/game.h"
 
 #include "../renderer/renderer_frontend.h"
 
 /** Systems. */
+#include "../systems/string_intern_system.h"
 #include "../systems/texture_system.h"
 
 #include <stdio.h>
@@ -27,7 +33,15 @@ typedef struct {
     i16 height;
     Clock clock;
     f64 lastTime;
-    LinearAllocator systemsAllocator;
+
+    /** Seconds since the previous frame, for the frame graph's tasks. */
+    f64 frameDelta;
+
+    /** Every stage of a frame, built once in applicationCreate. */
+    TaskGraph frameGraph;
+
+    /** Holds the state of every system; grows as they need it. */
+    VirtualArena systemsAllocator;
 
     u64 eventSystemMemoryRequirement;
     void *eventSystemState;
@@ -38,6 +52,18 @@ typedef struct {
     u64 loggingSystemMemoryRequirement;
     void *loggingSystemState;
 
+    u64 frameAllocatorSystemMemoryRequirement;
+    void *frameAllocatorSystemState;
+
+    /** Scratch stack for the main thread. */
+    StackAllocator scratchStack;
+
+    u64 jobSystemMemoryRequirement;
+    void *jobSystemState;
+
+    u64 parallelForSystemMemoryRequirement;
+    void *parallelForSystemState;
+
     u64 inputSystemMemoryRequirement;
     void *inputSystemState;
 
@@ -47,6 +73,9 @@ typedef struct {
     u64 rendererSystemMemoryRequirement;
     void *rendererSystemState;
 
+    u64 stringInternSystemMemoryRequirement;
+    void *stringInternSystemState;
+
     u64 textureSystemMemoryRequirement;
     void *textureSystemState;
 } ApplicationState;
@@ -58,6 +87,15 @@ b8 applicationOnEvent(u16 code, void *sender, void *listenerInstance, EventConte
 b8 applicationOnKey(u16 code, void *sender, void *listenerInstance, EventContext context);
 b8 applicationOnResize(u16 code, void *sender, void *listenerInstance, EventContext context);
 
+/** Frame graph tasks. */
+static b8 framePumpMessages(void *userData);
+static b8 frameGameUpdate(void *userData);
+static b8 frameGameRender(void *userData);
+static b8 frameDraw(void *userData);
+static b8 frameInputUpdate(void *userData);
+
+static b8 buildFrameGraph(void *memory, u64 memoryRequirement);
+
 b8 applicationCreate(Game *gameInstance) {
     if (gameInstance->applicationState) {
         ENGINE_ERROR("ApplicationCreate called more than once.")
@@ -71,14 +109,18 @@ b8 applicationCreate(Game *gameInstance) {
     appState->isRunning = false;
     appState->isSuspended = false;
 
-    u64 systemsAllocatorTotalSize = 64 * 1024 * 1024;
-    linearAllocatorCreate(systemsAllocatorTotalSize, 0, &appState->systemsAllocator);
+    /** Only address space; pages are committed as systems claim their state. */
+    u64 systemsAllocatorReserveSize = 1024ULL * 1024 * 1024;
+    if (!virtualArenaCreate(systemsAllocatorReserveSize, &appState->systemsAllocator)) {
+        ENGINE_FATAL("Failed to reserve the systems allocator; shutting down.")
+        return false;
+    }
 
     /** Initialize subsystems. */
 
     /** Events. */
     eventSystemInitialize(&appState->eventSystemMemoryRequirement, 0);
-    appState->eventSystemState = linearAllocatorAllocate(
+    appState->eventSystemState = virtualArenaAllocate(
         &appState->systemsAllocator,
         appState->eventSystemMemoryRequirement);
     eventSystemInitialize(
@@ -86,17 +128,41 @@ b8 applicationCreate(Game *gameInstance) {
         appState->eventSystemState);
 
     /** Memory. */
-    memorySystemInitialize(&appState->memorySystemMemoryRequirement, 0);
-    appState->memorySystemState = linearAllocatorAllocate(
+    MemorySystemConfig memorySystemConfig;
+    memorySystemConfig.totalAllocSize = 1024 * 1024 * 1024;
+    memorySystemConfig.poolBlocksPerClass = 1024;
+    memorySystemConfig.pooledTagMask = MEMORY_TAG_BIT(MEMORY_TAG_DYNAMIC_ARRAY) |
+        MEMORY_TAG_BIT(MEMORY_TAG_TEXTURE) | MEMORY_TAG_BIT(MEMORY_TAG_STRING);
+
+    /** File blobs and texture data; the pool above still takes the small ones. */
+    memorySystemConfig.buddyAllocSize = 64 * 1024 * 1024;
+    memorySystemConfig.buddyMinBlockSize = 1024;
+    memorySystemConfig.buddyTagMask = MEMORY_TAG_BIT(MEMORY_TAG_TEXTURE) |
+        MEMORY_TAG_BIT(MEMORY_TAG_STRING);
+    /** Steady-state frames should not need the general-purpose allocators at all. */
+    memorySystemConfig.frameAllocationBudget = 32;
+#if defined(_DEBUG)
+    memorySystemConfig.trackAllocations = true;
+    memorySystemConfig.trackingCapacity = 64 * 1024;
+#else
+    memorySystemConfig.trackAllocations = false;
+    memorySystemConfig.trackingCapacity = 0;
+#endif
+    memorySystemInitialize(&appState->memorySystemMemoryRequirement, 0, memorySystemConfig);
+    appState->memorySystemState = virtualArenaAllocate(
         &appState->systemsAllocator,
         appState->memorySystemMemoryRequirement);
-    memorySystemInitialize(
-        &appState->memorySystemMemoryRequirement,
-        appState->memorySystemState);
+
+    if (!memorySystemInitialize(&appState->memorySystemMemoryRequirement,
+        appState->memorySystemState, memorySystemConfig)) {
+
+        ENGINE_FATAL("Failed to initialize memory system; shutting down.")
+        return false;
+    }
 
     /** Logging. */
     initializeLogging(&appState->loggingSystemMemoryRequirement, 0);
-    appState->loggingSystemState = linearAllocatorAllocate(&appState->systemsAllocator,
+    appState->loggingSystemState = virtualArenaAllocate(&appState->systemsAllocator,
         appState->loggingSystemMemoryRequirement);
 
     if (!initializeLogging(&appState->loggingSystemMemoryRequirement, appState->loggingSystemState)) {
@@ -104,9 +170,66 @@ b8 applicationCreate(Game *gameInstance) {
         return false;
     }
 
+    /** Frame allocator. */
+    FrameAllocatorConfig frameAllocatorConfig;
+    frameAllocatorConfig.arenaSize = 4 * 1024 * 1024;
+    frameAllocatorSystemInitialize(&appState->frameAllocatorSystemMemoryRequirement, 0,
+        frameAllocatorConfig);
+    appState->frameAllocatorSystemState = virtualArenaAllocate(&appState->systemsAllocator,
+        appState->frameAllocatorSystemMemoryRequirement);
+
+    if (!frameAllocatorSystemInitialize(&appState->frameAllocatorSystemMemoryRequirement,
+        appState->frameAllocatorSystemState, frameAllocatorConfig)) {
+
+        ENGINE_FATAL("Failed to initialize frame allocator; shutting down.")
+        return false;
+    }
+
+    /** Main thread scratch stack. */
+    u64 scratchStackSize = 8 * 1024 * 1024;
+    stackAllocatorCreate(scratchStackSize,
+        virtualArenaAllocate(&appState->systemsAllocator, scratchStackSize),
+        &appState->scratchStack);
+    stackAllocatorSetScratch(&appState->scratchStack);
+
+    /** Job system; workers start here, before anything that may hand them work. */
+    JobSystemConfig jobSystemConfig;
+    jobSystemConfig.workerCount = 0;
+    jobSystemConfig.maxJobsPerThread = 1024;
+    jobSystemConfig.fiberCount = 128;
+    /** Frame graph tasks run as jobs and may log, and logging alone takes two 32KB buffers. */
+    jobSystemConfig.fiberStackSize = 256 * 1024;
+
+    /** Enough to decode most assets off the heap; larger ones fall back to it. */
+    jobSystemConfig.workerScratchSize = 4 * 1024 * 1024;
+    jobSystemInitialize(&appState->jobSystemMemoryRequirement, 0, jobSystemConfig);
+    appState->jobSystemState = virtualArenaAllocate(&appState->systemsAllocator,
+        appState->jobSystemMemoryRequirement);
+
+    if (!jobSystemInitialize(&appState->jobSystemMemoryRequirement,
+        appState->jobSystemState, jobSystemConfig)) {
+
+        ENGINE_FATAL("Failed to initialize job system; shutting down.")
+        return false;
+    }
+
+    /** Parallel-for pool. */
+    ParallelForConfig parallelForConfig;
+    parallelForConfig.workerCount = 0;
+    parallelForSystemInitialize(&appState->parallelForSystemMemoryRequirement, 0, parallelForConfig);
+    appState->parallelForSystemState = virtualArenaAllocate(&appState->systemsAllocator,
+        appState->parallelForSystemMemoryRequirement);
+
+    if (!parallelForSystemInitialize(&appState->parallelForSystemMemoryRequirement,
+        appState->parallelForSystemState, parallelForConfig)) {
+
+        ENGINE_FATAL("Failed to initialize parallel-for pool; shutting down.")
+        return false;
+    }
+
     /** Input. */
     inputSystemInitialize(&appState->inputSystemMemoryRequirement, 0);
-    appState->inputSystemState = linearAllocatorAllocate(
+    appState->inputSystemState = virtualArenaAllocate(
         &appState->systemsAllocator,
         appState->inputSystemMemoryRequirement);
     inputSystemInitialize(
@@ -121,7 +244,7 @@ b8 applicationCreate(Game *gameInstance) {
 
     /** Platform. */
     platformSystemStartup(&appState->platformSystemMemoryRequirement, 0, 0, 0, 0, 0, 0);
-    appState->platformSystemState = linearAllocatorAllocate(
+    appState->platformSystemState = virtualArenaAllocate(
         &appState->systemsAllocator,
         appState->platformSystemMemoryRequirement);
 
@@ -135,7 +258,7 @@ b8 applicationCreate(Game *gameInstance) {
 
     /** Renderer system. */
     rendererSystemInitialize(&appState->rendererSystemMemoryRequirement, 0, 0);
-    appState->rendererSystemState = linearAllocatorAllocate(&appState->systemsAllocator,
+    appState->rendererSystemState = virtualArenaAllocate(&appState->systemsAllocator,
         appState->rendererSystemMemoryRequirement);
 
     if (!rendererSystemInitialize(&appState->rendererSystemMemoryRequirement,
@@ -145,11 +268,26 @@ b8 applicationCreate(Game *gameInstance) {
         return false;
     }
 
+    /** String intern system; resources store their names as IDs from it. */
+    StringInternSystemConfig stringInternSystemConfig;
+    stringInternSystemConfig.maxStringCount = 65536;
+    stringInternSystemConfig.maxCharacterBytes = 64 * 1024 * 1024;
+    stringInternSystemInitialize(&appState->stringInternSystemMemoryRequirement, 0, stringInternSystemConfig);
+    appState->stringInternSystemState = virtualArenaAllocate(&appState->systemsAllocator,
+        appState->stringInternSystemMemoryRequirement);
+
+    if (!stringInternSystemInitialize(&appState->stringInternSystemMemoryRequirement,
+        appState->stringInternSystemState, stringInternSystemConfig)) {
+
+        ENGINE_FATAL("Failed to initialize string intern system. Application cannot continue.")
+        return false;
+    }
+
     /** Texture system. */
     TextureSystemConfig textureSystemConfig;
     textureSystemConfig.maxTextureCount = 65336;
     textureSystemInitialize(&appState->textureSystemMemoryRequirement, 0, textureSystemConfig);
-    appState->textureSystemState = linearAllocatorAllocate(&appState->systemsAllocator,
+    appState->textureSystemState = virtualArenaAllocate(&appState->systemsAllocator,
         appState->textureSystemMemoryRequirement);
 
     if (!textureSystemInitialize(&appState->textureSystemMemoryRequirement,
@@ -159,6 +297,16 @@ b8 applicationCreate(Game *gameInstance) {
         return false;
     }
 
+    /** Frame graph; the game may add its own tasks to it while initializing. */
+    u64 frameGraphMemoryRequirement = 0;
+    taskGraphCreate(64, 64, 256, &frameGraphMemoryRequirement, 0, 0);
+    if (!buildFrameGraph(virtualArenaAllocate(&appState->systemsAllocator, frameGraphMemoryRequirement),
+        frameGraphMemoryRequirement)) {
+
+        ENGINE_FATAL("Failed to build the frame graph. Application cannot continue.")
+        return false;
+    }
+
     /* Initialize the game. */
     if (!appState->gameInstance->initialize(appState->gameInstance)) {
         ENGINE_FATAL("Game failed to initialize")
@@ -182,35 +330,33 @@ b8 applicationRun() {
     ENGINE_INFO(engineGetMemoryUsageStr())
 
     while (appState->isRunning) {
-        if (!platformPumpMessages()) {
-            appState->isRunning = false;
-        }
+        /** Update clock and get delta time. */
+        clockUpdate(&appState->clock);
+        f64 currentTime = appState->clock.elapsed;
+        appState->frameDelta = currentTime - appState->lastTime;
+        f64 frameStartTime = platformGetAbsoluteTime();
 
         if (!appState->isSuspended) {
-            /** Update clock and get delta time. */
-            clockUpdate(&appState->clock);
-            f64 currentTime = appState->clock.elapsed;
-            f64 delta = (currentTime - appState->lastTime);
-            f64 frameStartTime = platformGetAbsoluteTime();
-
-            if (!appState->gameInstance->update(appState->gameInstance, (f32)delta)) {
-                ENGINE_FATAL("Game update failed, shutting down.")
-                appState->isRunning = false;
-                break;
-            }
-
-            /** Call the game's render routine. */
-            if (!appState->gameInstance->render(appState->gameInstance, (f32)delta)) {
-                ENGINE_FATAL("Game render failed, shutting down.")
-                appState->isRunning = false;
-                break;
+            /**
+             * Start of the frame's transient memory. Anything taken with
+             * frameAllocate during the previous frame is still valid.
+             */
+            frameAllocatorBeginFrame();
+            if (!memorySystemBeginFrame()) {
+                MemoryFrameDelta memoryDelta;
+                engineGetMemoryFrameDelta(&memoryDelta);
+                ENGINE_WARNING("Frame %llu made %llu allocations (%lluB), over the budget.",
+                    memoryDelta.frameNumber, memoryDelta.allocationCount, memoryDelta.bytesAllocated)
             }
+        }
 
-            /** Refactor packet creation. */
-            RenderPacket packet;
-            packet.deltaTime = delta;
-            rendererDrawFrame(&packet);
+        /** The whole frame, message pump to input update, runs as one graph. */
+        if (!taskGraphExecute(&appState->frameGraph)) {
+            appState->isRunning = false;
+            break;
+        }
 
+        if (!appState->isSuspended) {
             /** Figure out how long the frame took and, if below. */
             f64 frameEndTime = platformGetAbsoluteTime();
             f64 frameElapsedTime = frameEndTime - frameStartTime;
@@ -226,14 +372,6 @@ b8 applicationRun() {
                 }
             }
 
-            /**
-             * Input update/state copying should always be handled
-             * after any input should be recorded; I.E. before this line.
-             * As a safety, input is the last thing to be updated before
-             * this frame ends.
-             */
-            inputUpdate(delta);
-
             /** Update last time. */
             appState->lastTime = currentTime;
         }
@@ -246,19 +384,129 @@ b8 applicationRun() {
     eventUnregister(EVENT_CODE_KEY_PRESSED, 0, applicationOnKey);
     eventUnregister(EVENT_CODE_KEY_RELEASED, 0, applicationOnKey);
 
+    /** Workers go first so no job outlives the systems it might touch. */
+    jobSystemShutdown(appState->jobSystemState);
+    parallelForSystemShutdown(appState->parallelForSystemState);
+
     inputSystemShutdown(appState->inputSystemState);
 
     textureSystemShutdown(appState->textureSystemState);
+    stringInternSystemShutdown(appState->stringInternSystemState);
 
     rendererSystemShutdown(appState->rendererSystemState);
     platformSystemShutdown(appState->platformSystemState);
 
-    memorySystemShutdown(appState->memorySystemState);
     eventSystemShutdown(appState->eventSystemState);
 
+    ENGINE_DEBUG("Scratch stack high-water mark: %lluB of %lluB.",
+        appState->scratchStack.highWaterMark, appState->scratchStack.totalSize)
+    stackAllocatorSetScratch(0);
+    stackAllocatorDestroy(&appState->scratchStack);
+
+    frameAllocatorSystemShutdown(appState->frameAllocatorSystemState);
+
+    /** Last, since the systems above return their blocks to the memory system's allocator. */
+    memorySystemShutdown(appState->memorySystemState);
+
+    /** Every system's state lives in the arena, the logger's included. */
+    shutdownLogging(appState->loggingSystemState);
+    virtualArenaDestroy(&appState->systemsAllocator);
+
+    return true;
+}
+
+/**
+ * Stages of a frame and the state they share. Pumping messages feeds input
+ * and may resize the renderer; the game reads input and drives the renderer;
+ * input rolls over to the next frame once the game is done reading it, which
+ * leaves it free to overlap with drawing.
+ */
+static b8 buildFrameGraph(void *memory, u64 memoryRequirement) {
+    TaskGraph *graph = &appState->frameGraph;
+    if (!memory || !taskGraphCreate(64, 64, 256, &memoryRequirement, memory, graph)) {
+        return false;
+    }
+
+    u32 pump = taskGraphAddTask(graph, "pump messages", framePumpMessages, 0, true);
+    u32 update = taskGraphAddTask(graph, "game update", frameGameUpdate, 0, true);
+    u32 render = taskGraphAddTask(graph, "game render", frameGameRender, 0, true);
+    u32 draw = taskGraphAddTask(graph, "draw frame", frameDraw, 0, true);
+    u32 input = taskGraphAddTask(graph, "input update", frameInputUpdate, 0, false);
+
+    return taskGraphWrite(graph, pump, "input") && taskGraphWrite(graph, pump, "renderer") &&
+        taskGraphRead(graph, update, "input") && taskGraphWrite(graph, update, "game") &&
+        taskGraphWrite(graph, update, "renderer") &&
+        taskGraphRead(graph, render, "input") && taskGraphRead(graph, render, "game") &&
+        taskGraphWrite(graph, render, "renderer") &&
+        taskGraphWrite(graph, draw, "renderer") &&
+        taskGraphWrite(graph, input, "input");
+}
+
+static b8 framePumpMessages(void *userData) {
+    if (!platformPumpMessages()) {
+        appState->isRunning = false;
+    }
+
+    return true;
+}
+
+static b8 frameGameUpdate(void *userData) {
+    if (appState->isSuspended) {
+        return true;
+    }
+
+    if (!appState->gameInstance->update(appState->gameInstance, (f32)appState->frameDelta)) {
+        ENGINE_FATAL("Game update failed, shutting down.")
+        return false;
+    }
+
+    return true;
+}
+
+static b8 frameGameRender(void *userData) {
+    if (appState->isSuspended) {
+        return true;
+    }
+
+    /** Call the game's render routine. */
+    if (!appState->gameInstance->render(appState->gameInstance, (f32)appState->frameDelta)) {
+        ENGINE_FATAL("Game render failed, shutting down.")
+        return false;
+    }
+
+    return true;
+}
+
+static b8 frameDraw(void *userData) {
+    if (appState->isSuspended) {
+        return true;
+    }
+
+    /** Refactor packet creation. */
+    RenderPacket packet;
+    packet.deltaTime = appState->frameDelta;
+    rendererDrawFrame(&packet);
+
+    return true;
+}
+
+/**
+ * Input update/state copying should always be handled after any input
+ * should be recorded. The graph runs it only once the game is done with
+ * this frame's input, and before the next frame pumps messages.
+ */
+static b8 frameInputUpdate(void *userData) {
+    if (!appState->isSuspended) {
+        inputUpdate(appState->frameDelta);
+    }
+
     return true;
 }
 
+TaskGraph* applicationGetFrameGraph() {
+    return &appState->frameGraph;
+}
+
 void applicationGetFramebufferSize(u32 *width, u32 *height) {
     *width = appState->width;
     *height = appState->height;
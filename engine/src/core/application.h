@@ -4,6 +4,7 @@
 #include "../defines.h"
 
 struct Game;
+struct TaskGraph;
 
 typedef struct ApplicationConfig {
     /** Window starting position x axis, if applicable. */
@@ -28,4 +29,12 @@ ENGINE_API b8 applicationRun();
 
 void applicationGetFramebufferSize(u32 *width, u32 *height);
 
+/**
+ * @brief The graph the application runs every frame. Tasks added to it, for
+ * instance from the game's initialize, join the next frame; declare what they
+ * read and write so they are ordered against the engine's own stages
+ * ("input", "game" and "renderer").
+ */
+ENGINE_API struct TaskGraph* applicationGetFrameGraph();
+
 #endif
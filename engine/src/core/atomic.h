@@ -0,0 +1,169 @@
+#ifndef __ENGINE_ATOMIC_H__
+#define __ENGINE_ATOMIC_H__
+
+#include "../defines.h"
+
+/**
+ * Sequentially consistent operations on naturally aligned 32- and 64-bit
+ * integers. GCC and Clang (including clang-cl) use the __atomic builtins;
+ * MSVC uses the Interlocked intrinsics.
+ */
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+
+/** @brief Adds value to *target and returns the previous value. */
+ENGINE_INLINE u64 atomicFetchAdd64(volatile u64 *target, u64 value) {
+    return (u64)_InterlockedExchangeAdd64((volatile long long*)target, (long long)value);
+}
+
+/** @brief Subtracts value from *target and returns the previous value. */
+ENGINE_INLINE u64 atomicFetchSub64(volatile u64 *target, u64 value) {
+    return (u64)_InterlockedExchangeAdd64((volatile long long*)target, -(long long)value);
+}
+
+ENGINE_INLINE u64 atomicLoad64(volatile u64 *target) {
+    return (u64)_InterlockedCompareExchange64((volatile long long*)target, 0, 0);
+}
+
+ENGINE_INLINE void atomicStore64(volatile u64 *target, u64 value) {
+    _InterlockedExchange64((volatile long long*)target, (long long)value);
+}
+
+/**
+ * @brief Stores desired in *target if it still holds *expected. On failure
+ * *expected is updated to the current value.
+ *
+ * @return True if the store happened; otherwise false.
+ */
+ENGINE_INLINE b8 atomicCompareExchange64(volatile u64 *target, u64 *expected, u64 desired) {
+    u64 previous = (u64)_InterlockedCompareExchange64((volatile long long*)target,
+        (long long)desired, (long long)*expected);
+    if (previous == *expected) {
+        return true;
+    }
+
+    *expected = previous;
+    return false;
+}
+
+/** @brief Stores value in *target and returns the previous value. */
+ENGINE_INLINE u64 atomicExchange64(volatile u64 *target, u64 value) {
+    return (u64)_InterlockedExchange64((volatile long long*)target, (long long)value);
+}
+
+ENGINE_INLINE u32 atomicFetchAdd32(volatile u32 *target, u32 value) {
+    return (u32)_InterlockedExchangeAdd((volatile long*)target, (long)value);
+}
+
+ENGINE_INLINE u32 atomicFetchSub32(volatile u32 *target, u32 value) {
+    return (u32)_InterlockedExchangeAdd((volatile long*)target, -(long)value);
+}
+
+ENGINE_INLINE u32 atomicLoad32(volatile u32 *target) {
+    return (u32)_InterlockedCompareExchange((volatile long*)target, 0, 0);
+}
+
+ENGINE_INLINE void atomicStore32(volatile u32 *target, u32 value) {
+    _InterlockedExchange((volatile long*)target, (long)value);
+}
+
+ENGINE_INLINE u32 atomicExchange32(volatile u32 *target, u32 value) {
+    return (u32)_InterlockedExchange((volatile long*)target, (long)value);
+}
+
+ENGINE_INLINE b8 atomicCompareExchange32(volatile u32 *target, u32 *expected, u32 desired) {
+    u32 previous = (u32)_InterlockedCompareExchange((volatile long*)target, (long)desired, (long)*expected);
+    if (previous == *expected) {
+        return true;
+    }
+
+    *expected = previous;
+    return false;
+}
+
+/** @brief Tells the core this is a spin-wait loop, so it can back off briefly. */
+ENGINE_INLINE void atomicPause() {
+    _mm_pause();
+}
+
+#else
+
+/** @brief Adds value to *target and returns the previous value. */
+ENGINE_INLINE u64 atomicFetchAdd64(volatile u64 *target, u64 value) {
+    return __atomic_fetch_add(target, value, __ATOMIC_SEQ_CST);
+}
+
+/** @brief Subtracts value from *target and returns the previous value. */
+ENGINE_INLINE u64 atomicFetchSub64(volatile u64 *target, u64 value) {
+    return __atomic_fetch_sub(target, value, __ATOMIC_SEQ_CST);
+}
+
+ENGINE_INLINE u64 atomicLoad64(volatile u64 *target) {
+    return __atomic_load_n(target, __ATOMIC_SEQ_CST);
+}
+
+ENGINE_INLINE void atomicStore64(volatile u64 *target, u64 value) {
+    __atomic_store_n(target, value, __ATOMIC_SEQ_CST);
+}
+
+/**
+ * @brief Stores desired in *target if it still holds *expected. On failure
+ * *expected is updated to the current value.
+ *
+ * @return True if the store happened; otherwise false.
+ */
+ENGINE_INLINE b8 atomicCompareExchange64(volatile u64 *target, u64 *expected, u64 desired) {
+    return __atomic_compare_exchange_n(target, expected, desired, false,
+        __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+
+/** @brief Stores value in *target and returns the previous value. */
+ENGINE_INLINE u64 atomicExchange64(volatile u64 *target, u64 value) {
+    return __atomic_exchange_n(target, value, __ATOMIC_SEQ_CST);
+}
+
+ENGINE_INLINE u32 atomicFetchAdd32(volatile u32 *target, u32 value) {
+    return __atomic_fetch_add(target, value, __ATOMIC_SEQ_CST);
+}
+
+ENGINE_INLINE u32 atomicFetchSub32(volatile u32 *target, u32 value) {
+    return __atomic_fetch_sub(target, value, __ATOMIC_SEQ_CST);
+}
+
+ENGINE_INLINE u32 atomicLoad32(volatile u32 *target) {
+    return __atomic_load_n(target, __ATOMIC_SEQ_CST);
+}
+
+ENGINE_INLINE void atomicStore32(volatile u32 *target, u32 value) {
+    __atomic_store_n(target, value, __ATOMIC_SEQ_CST);
+}
+
+ENGINE_INLINE u32 atomicExchange32(volatile u32 *target, u32 value) {
+    return __atomic_exchange_n(target, value, __ATOMIC_SEQ_CST);
+}
+
+ENGINE_INLINE b8 atomicCompareExchange32(volatile u32 *target, u32 *expected, u32 desired) {
+    return __atomic_compare_exchange_n(target, expected, desired, false,
+        __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+
+/** @brief Tells the core this is a spin-wait loop, so it can back off briefly. */
+ENGINE_INLINE void atomicPause() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+#endif
+
+/** @brief Raises *target to value if value is larger. */
+ENGINE_INLINE void atomicMax64(volatile u64 *target, u64 value) {
+    u64 current = atomicLoad64(target);
+    while (current < value && !atomicCompareExchange64(target, &current, value)) {
+    }
+}
+
+#endif
@@ -0,0 +1,577 @@
+#include "job_system.h"
+
+#include "atomic.h"
+#include "logger.h"
+
+#include "../engine_memory/engine_memory.h"
+#include "../engine_memory/engine_string.h"
+#include "../engine_memory/stack_allocator.h"
+#include "../platform/platform.h"
+
+#define JOB_CACHE_LINE 64
+
+/** Times an idle worker looks for work before going to sleep. */
+#define JOB_IDLE_SPIN_COUNT 64
+
+typedef struct Job {
+    PFN_jobEntry entry;
+    void *data;
+    JobCounter *counter;
+} Job;
+
+/**
+ * A Chase-Lev deque. The owning thread pushes and pops at bottom; other
+ * threads steal at top. Jobs are stored by value: a thief copies its slot
+ * before claiming it, and the owner can only reuse that slot once top has
+ * moved past it, in which case the claim fails and the copy is discarded.
+ */
+typedef struct JobDeque {
+    volatile u64 top;
+    u8 topPadding[JOB_CACHE_LINE - sizeof(u64)];
+
+    volatile u64 bottom;
+    u8 bottomPadding[JOB_CACHE_LINE - sizeof(u64)];
+
+    Job *slots;
+    u64 mask;
+    u8 slotsPadding[JOB_CACHE_LINE - sizeof(Job*) - sizeof(u64)];
+} JobDeque;
+
+/** Why a fiber switched back to its thread. */
+typedef enum JobSwitchReason {
+    JOB_SWITCH_FINISHED,
+    JOB_SWITCH_WAITING
+} JobSwitchReason;
+
+typedef struct JobFiber {
+    PlatformFiber fiber;
+    Job job;
+
+    /** Set while the fiber is parked. */
+    JobCounter *waitCounter;
+    u64 waitValue;
+} JobFiber;
+
+typedef struct JobThread {
+    JobDeque deques[JOB_PRIORITY_COUNT];
+    PlatformThread thread;
+
+    /** The thread's own context; 0 when it runs jobs without fibers. */
+    PlatformFiber threadFiber;
+
+    /** The pool fiber running on this thread, if any, and why it last switched back. */
+    JobFiber *currentFiber;
+    JobSwitchReason switchReason;
+
+    /** The thread this one tries to steal from first; rotates to spread thieves out. */
+    u32 stealCursor;
+
+    /** Bound as the worker's scratch stack; unused for the main thread. */
+    StackAllocator scratch;
+} JobThread;
+
+typedef struct JobSystemState {
+    JobSystemConfig config;
+    u32 threadCount;
+    volatile u64 running;
+
+    /** Workers that have committed to sleeping; submitters wake this many at most. */
+    volatile u64 sleepingWorkers;
+    PlatformSemaphore wakeSemaphore;
+
+    JobThread *threads;
+
+    /**
+     * Fibers not running a job, and fibers parked on a counter. Both lists
+     * sit behind fiberMutex; it is only taken to hand a fiber over.
+     */
+    PlatformMutex fiberMutex;
+    u32 fiberCount;
+    JobFiber *fibers;
+    JobFiber **freeFibers;
+    u32 freeFiberCount;
+    JobFiber **waitingFibers;
+    volatile u64 waitingFiberCount;
+} JobSystemState;
+
+static JobSystemState *statePtr = 0;
+
+/** The main thread is 0 once the system is up; workers set theirs on start. */
+static ENGINE_THREAD_LOCAL u32 threadIndex = INVALID_ID;
+
+static u64 alignCacheLine(u64 value) {
+    return (value + JOB_CACHE_LINE - 1) & ~(u64)(JOB_CACHE_LINE - 1);
+}
+
+static u32 roundUpPowerOfTwo(u32 value) {
+    u32 result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+
+    return result;
+}
+
+static b8 dequePush(JobDeque *deque, const Job *job) {
+    u64 bottom = atomicLoad64(&deque->bottom);
+    u64 top = atomicLoad64(&deque->top);
+    if (bottom - top > deque->mask) {
+        return false;
+    }
+
+    deque->slots[bottom & deque->mask] = *job;
+    atomicStore64(&deque->bottom, bottom + 1);
+    return true;
+}
+
+static b8 dequePop(JobDeque *deque, Job *outJob) {
+    u64 bottom = atomicLoad64(&deque->bottom) - 1;
+    atomicStore64(&deque->bottom, bottom);
+    u64 top = atomicLoad64(&deque->top);
+
+    if ((i64)(bottom - top) < 0) {
+        /** Empty; put bottom back. */
+        atomicStore64(&deque->bottom, bottom + 1);
+        return false;
+    }
+
+    *outJob = deque->slots[bottom & deque->mask];
+    if (bottom != top) {
+        return true;
+    }
+
+    /** Last job: race any thief for it. Either way the deque ends up empty at top + 1. */
+    u64 expected = top;
+    b8 won = atomicCompareExchange64(&deque->top, &expected, top + 1);
+    atomicStore64(&deque->bottom, top + 1);
+    return won;
+}
+
+static b8 dequeSteal(JobDeque *deque, Job *outJob) {
+    u64 top = atomicLoad64(&deque->top);
+    u64 bottom = atomicLoad64(&deque->bottom);
+    if ((i64)(bottom - top) <= 0) {
+        return false;
+    }
+
+    Job job = deque->slots[top & deque->mask];
+    if (!atomicCompareExchange64(&deque->top, &top, top + 1)) {
+        return false;
+    }
+
+    *outJob = job;
+    return true;
+}
+
+/** Own deques first, then everyone else's, one priority level at a time. */
+static b8 findJob(u32 index, Job *outJob) {
+    JobThread *self = &statePtr->threads[index];
+    u32 threadCount = statePtr->threadCount;
+
+    for (u32 priority = 0; priority < JOB_PRIORITY_COUNT; ++priority) {
+        if (dequePop(&self->deques[priority], outJob)) {
+            return true;
+        }
+
+        for (u32 i = 1; i < threadCount; ++i) {
+            u32 victim = (self->stealCursor + i) % threadCount;
+            if (victim != index && dequeSteal(&statePtr->threads[victim].deques[priority], outJob)) {
+                self->stealCursor = victim;
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Wakes a sleeping worker if a fiber is parked on counter at value or above.
+ * Fibers parked after this look are found by the thread that parks them, as
+ * it goes on scheduling before it can sleep.
+ */
+static void wakeWaiters(JobCounter *counter, u64 value) {
+    if (!statePtr || !atomicLoad64(&statePtr->waitingFiberCount) || !atomicLoad64(&statePtr->sleepingWorkers)) {
+        return;
+    }
+
+    b8 ready = false;
+    platformMutexLock(&statePtr->fiberMutex);
+    u32 count = (u32)statePtr->waitingFiberCount;
+    for (u32 i = 0; i < count && !ready; ++i) {
+        JobFiber *fiber = statePtr->waitingFibers[i];
+        ready = fiber->waitCounter == counter && value <= fiber->waitValue;
+    }
+
+    platformMutexUnlock(&statePtr->fiberMutex);
+    if (ready) {
+        platformSemaphoreSignal(&statePtr->wakeSemaphore, 1);
+    }
+}
+
+static void runJob(const Job *job) {
+    job->entry(job->data);
+    if (job->counter) {
+        JobCounter *counter = job->counter;
+        wakeWaiters(counter, atomicFetchSub64(&counter->value, 1) - 1);
+    }
+}
+
+/**
+ * A fiber can suspend on one thread and resume on another, so code that may
+ * have switched fibers asks again rather than trusting a thread-local it read
+ * before the switch.
+ */
+static ENGINE_NOINLINE JobThread* currentThread() {
+    return statePtr && threadIndex != INVALID_ID ? &statePtr->threads[threadIndex] : 0;
+}
+
+static JobFiber* acquireFiber() {
+    JobFiber *fiber = 0;
+    platformMutexLock(&statePtr->fiberMutex);
+    if (statePtr->freeFiberCount) {
+        fiber = statePtr->freeFibers[--statePtr->freeFiberCount];
+    }
+
+    platformMutexUnlock(&statePtr->fiberMutex);
+    return fiber;
+}
+
+/** Removes and returns a parked fiber whose counter has reached its value. */
+static JobFiber* takeReadyFiber() {
+    if (!atomicLoad64(&statePtr->waitingFiberCount)) {
+        return 0;
+    }
+
+    JobFiber *fiber = 0;
+    platformMutexLock(&statePtr->fiberMutex);
+    u32 count = (u32)statePtr->waitingFiberCount;
+    for (u32 i = 0; i < count; ++i) {
+        JobFiber *candidate = statePtr->waitingFibers[i];
+        if (atomicLoad64(&candidate->waitCounter->value) <= candidate->waitValue) {
+            statePtr->waitingFibers[i] = statePtr->waitingFibers[count - 1];
+            atomicStore64(&statePtr->waitingFiberCount, count - 1);
+            candidate->waitCounter = 0;
+            fiber = candidate;
+            break;
+        }
+    }
+
+    platformMutexUnlock(&statePtr->fiberMutex);
+    return fiber;
+}
+
+/**
+ * Files a fiber that has just switched back to this thread. Only done once
+ * its stack is no longer running, so no other thread can resume it early.
+ */
+static void retireFiber(JobFiber *fiber, JobSwitchReason reason) {
+    platformMutexLock(&statePtr->fiberMutex);
+    if (reason == JOB_SWITCH_FINISHED) {
+        statePtr->freeFibers[statePtr->freeFiberCount++] = fiber;
+    } else {
+        u64 count = statePtr->waitingFiberCount;
+        statePtr->waitingFibers[count] = fiber;
+        atomicStore64(&statePtr->waitingFiberCount, count + 1);
+    }
+
+    platformMutexUnlock(&statePtr->fiberMutex);
+}
+
+static void fiberEntry(void *argument) {
+    JobFiber *fiber = argument;
+    for (;;) {
+        runJob(&fiber->job);
+
+        JobThread *thread = currentThread();
+        thread->switchReason = JOB_SWITCH_FINISHED;
+        platformFiberSwitch(&fiber->fiber, &thread->threadFiber);
+    }
+}
+
+/**
+ * Runs one piece of work from a thread's own context: a parked fiber that
+ * can continue, or else a queued job on a fresh fiber. Jobs run directly on
+ * the thread's stack when it has no fibers or the pool is empty.
+ *
+ * @return True if anything ran.
+ */
+static b8 scheduleOnce(u32 index) {
+    JobThread *thread = &statePtr->threads[index];
+    JobFiber *fiber = thread->threadFiber.internalData ? takeReadyFiber() : 0;
+    if (!fiber) {
+        Job job;
+        if (!findJob(index, &job)) {
+            return false;
+        }
+
+        fiber = thread->threadFiber.internalData ? acquireFiber() : 0;
+        if (!fiber) {
+            runJob(&job);
+            return true;
+        }
+
+        fiber->job = job;
+    }
+
+    /** Thread contexts never migrate, so thread is still ours when the switch returns. */
+    thread->currentFiber = fiber;
+    platformFiberSwitch(&thread->threadFiber, &fiber->fiber);
+    thread->currentFiber = 0;
+    retireFiber(fiber, thread->switchReason);
+
+    return true;
+}
+
+static u32 workerEntry(void *argument) {
+    u32 index = (u32)(u64)argument;
+    threadIndex = index;
+
+    JobThread *thread = &statePtr->threads[index];
+    if (statePtr->fiberCount && !platformFiberConvertThread(&thread->threadFiber)) {
+        ENGINE_WARNING("Job worker %u could not become a fiber; its jobs will block while waiting.", index)
+    }
+
+    if (thread->scratch.memory) {
+        stackAllocatorSetScratch(&thread->scratch);
+    }
+
+    while (atomicLoad64(&statePtr->running)) {
+        b8 worked = false;
+        for (u32 spin = 0; spin < JOB_IDLE_SPIN_COUNT && !worked; ++spin) {
+            worked = scheduleOnce(index);
+            if (!worked) {
+                platformThreadYield();
+            }
+        }
+
+        if (worked) {
+            continue;
+        }
+
+        /**
+         * Announce the sleep before the last look, so a submitter or a job
+         * finishing on a parked fiber's counter either sees this worker
+         * sleeping or this look finds the work.
+         */
+        atomicFetchAdd64(&statePtr->sleepingWorkers, 1);
+        worked = scheduleOnce(index);
+        if (!worked && atomicLoad64(&statePtr->running)) {
+            platformSemaphoreWait(&statePtr->wakeSemaphore);
+        }
+
+        atomicFetchSub64(&statePtr->sleepingWorkers, 1);
+    }
+
+    stackAllocatorSetScratch(0);
+    platformFiberRevertThread(&thread->threadFiber);
+
+    return 0;
+}
+
+b8 jobSystemInitialize(u64 *memoryRequirement, void *state, JobSystemConfig config) {
+    u32 workerCount = config.workerCount;
+    if (workerCount == 0) {
+        workerCount = platformGetProcessorCount() - 1;
+    }
+
+    u32 threadCount = workerCount + 1;
+    if (threadCount > JOB_SYSTEM_MAX_THREADS) {
+        threadCount = JOB_SYSTEM_MAX_THREADS;
+    }
+
+    u32 dequeCapacity = roundUpPowerOfTwo(config.maxJobsPerThread ? config.maxJobsPerThread : 1024);
+
+    /**
+     * Block of memory will contain state structure, then the threads, the
+     * fibers and both fiber lists, then every deque's slots, then the
+     * workers' scratch stacks. The extra line lets the threads start on a
+     * cache line.
+     */
+    u64 structRequirement = alignCacheLine(sizeof(JobSystemState));
+    u64 threadsRequirement = alignCacheLine(sizeof(JobThread) * threadCount);
+    u64 fibersRequirement = alignCacheLine((sizeof(JobFiber) + (sizeof(JobFiber*) * 2)) * config.fiberCount);
+    u64 slotsRequirement = sizeof(Job) * dequeCapacity;
+    u64 scratchSize = alignCacheLine(config.workerScratchSize);
+    u64 bookkeepingRequirement = JOB_CACHE_LINE + structRequirement + threadsRequirement + fibersRequirement +
+        (slotsRequirement * threadCount * JOB_PRIORITY_COUNT);
+    *memoryRequirement = bookkeepingRequirement + (scratchSize * (threadCount - 1));
+
+    if (!state) {
+        return true;
+    }
+
+    /** Scratch stacks are left as they are, so their pages are only touched once used. */
+    engineZeroMemory(state, bookkeepingRequirement);
+    statePtr = (JobSystemState*)alignCacheLine((u64)state);
+    statePtr->config = config;
+    statePtr->threadCount = threadCount;
+    statePtr->threads = (JobThread*)((u8*)statePtr + structRequirement);
+
+    statePtr->fibers = (JobFiber*)((u8*)statePtr->threads + threadsRequirement);
+    statePtr->freeFibers = (JobFiber**)(statePtr->fibers + config.fiberCount);
+    statePtr->waitingFibers = statePtr->freeFibers + config.fiberCount;
+    u64 fiberStackSize = config.fiberStackSize ? config.fiberStackSize : 64 * 1024;
+    for (u32 i = 0; i < config.fiberCount; ++i) {
+        JobFiber *fiber = &statePtr->fibers[i];
+        if (!platformFiberCreate(fiberStackSize, fiberEntry, fiber, &fiber->fiber)) {
+            ENGINE_WARNING("jobSystemInitialize - only %u of %u fibers could be created.", i, config.fiberCount)
+            break;
+        }
+
+        statePtr->freeFibers[statePtr->fiberCount++] = fiber;
+    }
+
+    statePtr->freeFiberCount = statePtr->fiberCount;
+
+    u8 *slots = (u8*)statePtr->threads + threadsRequirement + fibersRequirement;
+    for (u32 i = 0; i < threadCount; ++i) {
+        for (u32 priority = 0; priority < JOB_PRIORITY_COUNT; ++priority) {
+            JobDeque *deque = &statePtr->threads[i].deques[priority];
+            deque->slots = (Job*)slots;
+            deque->mask = dequeCapacity - 1;
+            slots += slotsRequirement;
+        }
+    }
+
+    u8 *scratchMemory = (u8*)state + bookkeepingRequirement;
+    for (u32 i = 1; scratchSize && i < threadCount; ++i) {
+        stackAllocatorCreate(scratchSize, scratchMemory + (scratchSize * (i - 1)), &statePtr->threads[i].scratch);
+    }
+
+    if (!platformSemaphoreCreate(0, &statePtr->wakeSemaphore)) {
+        ENGINE_FATAL("jobSystemInitialize - failed to create the wake semaphore.")
+        statePtr = 0;
+        return false;
+    }
+
+    threadIndex = 0;
+    if (statePtr->fiberCount && !platformFiberConvertThread(&statePtr->threads[0].threadFiber)) {
+        ENGINE_WARNING("jobSystemInitialize - the main thread could not become a fiber.")
+    }
+
+    atomicStore64(&statePtr->running, true);
+    for (u32 i = 1; i < threadCount; ++i) {
+        if (!platformThreadCreate(workerEntry, (void*)(u64)i, &statePtr->threads[i].thread)) {
+            ENGINE_ERROR("jobSystemInitialize - could only start %u of %u workers.", i - 1, threadCount - 1)
+            statePtr->threadCount = i;
+            break;
+        }
+
+        char name[32];
+        stringFormat(name, "Job worker %u", i);
+        platformThreadSetName(&statePtr->threads[i].thread, name);
+    }
+
+    ENGINE_INFO("Job system started with %u worker threads and %u fibers.",
+        statePtr->threadCount - 1, statePtr->fiberCount)
+
+    return true;
+}
+
+void jobSystemShutdown(void *state) {
+    if (statePtr) {
+        atomicStore64(&statePtr->running, false);
+        platformSemaphoreSignal(&statePtr->wakeSemaphore, statePtr->threadCount);
+        for (u32 i = 1; i < statePtr->threadCount; ++i) {
+            platformThreadJoin(&statePtr->threads[i].thread);
+        }
+
+        platformSemaphoreDestroy(&statePtr->wakeSemaphore);
+
+        for (u32 i = 1; i < statePtr->threadCount; ++i) {
+            if (statePtr->threads[i].scratch.memory) {
+                stackAllocatorDestroy(&statePtr->threads[i].scratch);
+            }
+        }
+
+        platformFiberRevertThread(&statePtr->threads[0].threadFiber);
+        for (u32 i = 0; i < statePtr->fiberCount; ++i) {
+            platformFiberDestroy(&statePtr->fibers[i].fiber);
+        }
+    }
+
+    statePtr = 0;
+    threadIndex = INVALID_ID;
+}
+
+void jobSystemRun(const JobDecl *jobs, u32 count, JobCounter *counter) {
+    if (!jobs || count == 0) {
+        return;
+    }
+
+    if (counter) {
+        atomicFetchAdd64(&counter->value, count);
+    }
+
+    /** Without the system, or off its threads, there is no deque to queue on. */
+    JobThread *self = currentThread();
+    u32 queued = 0;
+    for (u32 i = 0; i < count; ++i) {
+        Job job;
+        job.entry = jobs[i].entry;
+        job.data = jobs[i].data;
+        job.counter = counter;
+
+        JobPriority priority = jobs[i].priority < JOB_PRIORITY_COUNT ? jobs[i].priority : JOB_PRIORITY_NORMAL;
+        if (self && dequePush(&self->deques[priority], &job)) {
+            queued++;
+        } else {
+            /** The job may wait and move this fiber to another thread. */
+            runJob(&job);
+            self = currentThread();
+        }
+    }
+
+    if (queued) {
+        u64 sleeping = atomicLoad64(&statePtr->sleepingWorkers);
+        if (sleeping) {
+            platformSemaphoreSignal(&statePtr->wakeSemaphore, sleeping < queued ? (u32)sleeping : queued);
+        }
+    }
+}
+
+void jobSystemWaitForCounter(JobCounter *counter, u64 value) {
+    if (!counter) {
+        return;
+    }
+
+    if (atomicLoad64(&counter->value) <= value) {
+        return;
+    }
+
+    JobThread *thread = currentThread();
+    if (thread && thread->currentFiber) {
+        /** Park this fiber; the thread picks up other work until a scheduler resumes it. */
+        JobFiber *fiber = thread->currentFiber;
+        fiber->waitCounter = counter;
+        fiber->waitValue = value;
+        thread->switchReason = JOB_SWITCH_WAITING;
+        platformFiberSwitch(&fiber->fiber, &thread->threadFiber);
+        return;
+    }
+
+    /** On a thread's own stack there is nothing to park, so help out until done. */
+    while (atomicLoad64(&counter->value) > value) {
+        if (!thread || !scheduleOnce(jobSystemGetThreadIndex())) {
+            platformThreadYield();
+        }
+    }
+}
+
+b8 jobSystemRunOne() {
+    JobThread *thread = currentThread();
+    if (!thread || thread->currentFiber) {
+        return false;
+    }
+
+    return scheduleOnce(jobSystemGetThreadIndex());
+}
+
+u32 jobSystemGetThreadCount() {
+    return statePtr ? statePtr->threadCount : 1;
+}
+
+u32 jobSystemGetThreadIndex() {
+    return threadIndex;
+}
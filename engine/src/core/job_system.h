@@ -0,0 +1,129 @@
+#ifndef __ENGINE_JOB_SYSTEM_H__
+#define __ENGINE_JOB_SYSTEM_H__
+
+#include "../defines.h"
+
+/** Most threads that run jobs, the main thread included. */
+#define JOB_SYSTEM_MAX_THREADS 64
+
+typedef enum JobPriority {
+    JOB_PRIORITY_HIGH,
+    JOB_PRIORITY_NORMAL,
+    JOB_PRIORITY_LOW,
+    JOB_PRIORITY_COUNT
+} JobPriority;
+
+typedef void (*PFN_jobEntry)(void *data);
+
+/** @brief Describes one job to run. */
+typedef struct JobDecl {
+    PFN_jobEntry entry;
+    void *data;
+    JobPriority priority;
+} JobDecl;
+
+/**
+ * @brief Counts jobs that have not finished yet. Zero it before first use;
+ * jobSystemRun adds to it and each job subtracts one when it returns.
+ */
+typedef struct JobCounter {
+    volatile u64 value;
+} JobCounter;
+
+typedef struct JobSystemConfig {
+    /** Worker threads to start besides the main thread; 0 for one per remaining core. */
+    u32 workerCount;
+
+    /**
+     * Jobs each thread can have queued or running at once, per priority.
+     * Rounded up to a power of two.
+     */
+    u32 maxJobsPerThread;
+
+    /**
+     * Fibers that jobs run on, which bounds how many jobs can be parked in
+     * jobSystemWaitForCounter at once. 0 runs jobs on the threads' own stacks,
+     * where waiting helps run other jobs instead of parking.
+     */
+    u32 fiberCount;
+
+    /** Stack size of each fiber in bytes; 0 for 64KB. */
+    u64 fiberStackSize;
+
+    /**
+     * Size of the scratch stack each worker binds with stackAllocatorSetScratch;
+     * 0 for none. The main thread keeps whatever it bound itself. A parked job
+     * may resume on another thread, so jobs release their scratch allocations
+     * before waiting on a counter.
+     */
+    u64 workerScratchSize;
+} JobSystemConfig;
+
+/**
+ * @brief Initializes the job system. Call twice; once with state = 0 to get
+ * required memory size, then a second time passing allocated memory to state.
+ * The second call starts the workers.
+ *
+ * Every thread that runs jobs owns one Chase-Lev deque per priority. It
+ * pushes and pops the bottom of its own deques, and idle threads steal from
+ * the top of everyone else's, highest priority first. Workers with nothing
+ * to do sleep on a semaphore until more work is queued.
+ *
+ * Each job runs on a fiber from a fixed pool, so a job that waits on a
+ * counter is parked and its thread moves on to other work. Parked fibers
+ * resume on whichever thread notices their counter first.
+ *
+ * @param memoryRequirement A pointer to hold the required memory size.
+ * @param state 0 if just requesting memory requirement, otherwise allocated block of memory.
+ * @param config The job system configuration.
+ * @return True on success; otherwise false.
+ */
+b8 jobSystemInitialize(u64 *memoryRequirement, void *state, JobSystemConfig config);
+
+/** @brief Stops and joins the workers. Queued jobs that have not started are dropped. */
+void jobSystemShutdown(void *state);
+
+/**
+ * @brief Queues jobs on the calling thread's deques. Jobs may be queued from
+ * the main thread or from inside other jobs. When a deque is full the job runs
+ * immediately on the calling thread instead.
+ *
+ * @param jobs The jobs to queue. Required.
+ * @param count The number of jobs.
+ * @param counter 0, or a counter to add count to. Each job subtracts one when it returns.
+ */
+ENGINE_API void jobSystemRun(const JobDecl *jobs, u32 count, JobCounter *counter);
+
+/**
+ * @brief Waits until counter has dropped to value or below. Inside a job the
+ * job's fiber is parked and the thread runs other work; it may resume on a
+ * different thread, so thread-local state read before the wait can be stale
+ * after it. Outside a job, the calling thread runs queued jobs until done.
+ * A parked job is woken when a job counted by counter returns; a counter
+ * changed by hand is only noticed by threads that are already awake.
+ *
+ * @param counter The counter to watch. Required.
+ * @param value The value to wait for; usually 0.
+ */
+ENGINE_API void jobSystemWaitForCounter(JobCounter *counter, u64 value);
+
+/**
+ * @brief Runs one queued job, or resumes one parked job whose counter is
+ * ready, on the calling thread. For loops that wait on something other than
+ * a counter and want to help meanwhile. Does nothing inside a job or on a
+ * thread the job system does not know.
+ *
+ * @return True if anything ran; otherwise false.
+ */
+ENGINE_API b8 jobSystemRunOne();
+
+/** @brief Number of threads that run jobs, the main thread included; 1 before initialization. */
+ENGINE_API u32 jobSystemGetThreadCount();
+
+/**
+ * @brief Index of the calling thread among the threads that run jobs: 0 for
+ * the main thread, 1.. for workers, INVALID_ID for any other thread.
+ */
+ENGINE_API u32 jobSystemGetThreadIndex();
+
+#endif
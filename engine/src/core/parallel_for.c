@@ -0,0 +1,263 @@
+#include "parallel_for.h"
+
+#include "atomic.h"
+#include "logger.h"
+
+#include "../engine_memory/engine_memory.h"
+#include "../engine_memory/engine_string.h"
+#include "../platform/platform.h"
+
+#define PARALLEL_FOR_CACHE_LINE 64
+
+/**
+ * The part of the loop a thread still has to do, as begin << 32 | end in a
+ * single word so the owner taking chunks off the front and a thief taking
+ * the back half can both claim with one compare-exchange.
+ */
+typedef struct ParallelForSlot {
+    volatile u64 range;
+    u8 padding[PARALLEL_FOR_CACHE_LINE - sizeof(u64)];
+} ParallelForSlot;
+
+typedef struct ParallelForState {
+    u32 threadCount;
+    volatile u64 running;
+    PlatformSemaphore wakeSemaphore;
+    PlatformThread *workers;
+    ParallelForSlot *slots;
+
+    /** Set while a loop is running; there is only one set of slots. */
+    volatile u64 busy;
+
+    /** The loop being run. */
+    PFN_parallelForBody body;
+    void *userData;
+    u32 minChunk;
+    u32 participantCount;
+
+    /** Hands out slot indices to the workers woken for the loop. */
+    volatile u64 nextParticipant;
+
+    /** Indices not yet processed; the loop is done at 0. */
+    volatile u64 remaining;
+
+    /** Woken workers that are done with the loop and will not touch the slots again. */
+    volatile u64 finishedWorkers;
+} ParallelForState;
+
+static ParallelForState *statePtr = 0;
+
+static u64 packRange(u32 begin, u32 end) {
+    return ((u64)begin << 32) | end;
+}
+
+static u32 rangeBegin(u64 range) {
+    return (u32)(range >> 32);
+}
+
+static u32 rangeEnd(u64 range) {
+    return (u32)range;
+}
+
+/** Claims up to minChunk indices off the front of a thread's own share. */
+static b8 takeChunk(ParallelForSlot *slot, u32 *outBegin, u32 *outEnd) {
+    u64 range = atomicLoad64(&slot->range);
+    for (;;) {
+        u32 begin = rangeBegin(range);
+        u32 end = rangeEnd(range);
+        if (begin >= end) {
+            return false;
+        }
+
+        u32 take = end - begin < statePtr->minChunk ? end - begin : statePtr->minChunk;
+        if (atomicCompareExchange64(&slot->range, &range, packRange(begin + take, end))) {
+            *outBegin = begin;
+            *outEnd = begin + take;
+            return true;
+        }
+    }
+}
+
+/**
+ * Moves the back half of the largest share that can still be split into the
+ * thief's own slot.
+ *
+ * @return False once no share is two chunks long.
+ */
+static b8 stealHalf(u32 thief) {
+    u32 splittable = statePtr->minChunk * 2;
+    for (;;) {
+        u32 victim = INVALID_ID;
+        u64 victimRange = 0;
+        u32 victimSize = 0;
+        for (u32 i = 0; i < statePtr->participantCount; ++i) {
+            u64 range = atomicLoad64(&statePtr->slots[i].range);
+            u32 size = rangeEnd(range) > rangeBegin(range) ? rangeEnd(range) - rangeBegin(range) : 0;
+            if (i != thief && size >= splittable && size > victimSize) {
+                victim = i;
+                victimRange = range;
+                victimSize = size;
+            }
+        }
+
+        if (victim == INVALID_ID) {
+            return false;
+        }
+
+        u32 middle = rangeBegin(victimRange) + (victimSize / 2);
+        if (atomicCompareExchange64(&statePtr->slots[victim].range, &victimRange,
+            packRange(rangeBegin(victimRange), middle))) {
+
+            atomicStore64(&statePtr->slots[thief].range, packRange(middle, rangeEnd(victimRange)));
+            return true;
+        }
+    }
+}
+
+static void runParticipant(u32 index) {
+    ParallelForSlot *slot = &statePtr->slots[index];
+    do {
+        u32 begin = 0;
+        u32 end = 0;
+        while (takeChunk(slot, &begin, &end)) {
+            statePtr->body(begin, end, statePtr->userData);
+            atomicFetchSub64(&statePtr->remaining, end - begin);
+        }
+    } while (stealHalf(index));
+}
+
+static u32 workerEntry(void *argument) {
+    (void)argument;
+
+    for (;;) {
+        platformSemaphoreWait(&statePtr->wakeSemaphore);
+        if (!atomicLoad64(&statePtr->running)) {
+            break;
+        }
+
+        /** Exactly participantCount - 1 workers are woken per loop, so every index is a valid slot. */
+        u32 index = (u32)atomicFetchAdd64(&statePtr->nextParticipant, 1);
+        runParticipant(index);
+        atomicFetchAdd64(&statePtr->finishedWorkers, 1);
+    }
+
+    return 0;
+}
+
+b8 parallelForSystemInitialize(u64 *memoryRequirement, void *state, ParallelForConfig config) {
+    u32 workerCount = config.workerCount;
+    if (workerCount == 0) {
+        workerCount = platformGetProcessorCount() - 1;
+    }
+
+    u32 threadCount = workerCount + 1;
+    if (threadCount > PARALLEL_FOR_MAX_THREADS) {
+        threadCount = PARALLEL_FOR_MAX_THREADS;
+    }
+
+    /**
+     * Block of memory will contain state structure, then the slots, then the
+     * worker threads. The extra line lets the slots start on a cache line.
+     */
+    u64 structRequirement = sizeof(ParallelForState);
+    u64 slotsRequirement = sizeof(ParallelForSlot) * threadCount;
+    u64 workersRequirement = sizeof(PlatformThread) * threadCount;
+    *memoryRequirement = structRequirement + PARALLEL_FOR_CACHE_LINE + slotsRequirement + workersRequirement;
+
+    if (!state) {
+        return true;
+    }
+
+    engineZeroMemory(state, *memoryRequirement);
+    statePtr = state;
+    statePtr->slots = (ParallelForSlot*)(((u64)statePtr + structRequirement + PARALLEL_FOR_CACHE_LINE - 1) &
+        ~(u64)(PARALLEL_FOR_CACHE_LINE - 1));
+    statePtr->workers = (PlatformThread*)((u8*)statePtr->slots + slotsRequirement);
+    statePtr->threadCount = 1;
+
+    if (!platformSemaphoreCreate(0, &statePtr->wakeSemaphore)) {
+        ENGINE_FATAL("parallelForSystemInitialize - failed to create the wake semaphore.")
+        statePtr = 0;
+        return false;
+    }
+
+    atomicStore64(&statePtr->running, true);
+    for (u32 i = 1; i < threadCount; ++i) {
+        if (!platformThreadCreate(workerEntry, 0, &statePtr->workers[i])) {
+            ENGINE_ERROR("parallelForSystemInitialize - could only start %u of %u workers.", i - 1, threadCount - 1)
+            break;
+        }
+
+        char name[32];
+        stringFormat(name, "Parallel-for %u", i);
+        platformThreadSetName(&statePtr->workers[i], name);
+        statePtr->threadCount++;
+    }
+
+    ENGINE_INFO("Parallel-for pool started with %u worker threads.", statePtr->threadCount - 1)
+
+    return true;
+}
+
+void parallelForSystemShutdown(void *state) {
+    if (statePtr) {
+        atomicStore64(&statePtr->running, false);
+        platformSemaphoreSignal(&statePtr->wakeSemaphore, statePtr->threadCount - 1);
+        for (u32 i = 1; i < statePtr->threadCount; ++i) {
+            platformThreadJoin(&statePtr->workers[i]);
+        }
+
+        platformSemaphoreDestroy(&statePtr->wakeSemaphore);
+    }
+
+    statePtr = 0;
+}
+
+void parallelFor(u32 begin, u32 end, u32 minChunk, PFN_parallelForBody body, void *userData) {
+    if (!body || begin >= end) {
+        return;
+    }
+
+    u32 count = end - begin;
+    if (minChunk == 0) {
+        minChunk = 1;
+    }
+
+    u64 expected = 0;
+    if (!statePtr || statePtr->threadCount == 1 || count / 2 < minChunk ||
+        !atomicCompareExchange64(&statePtr->busy, &expected, 1)) {
+
+        body(begin, end, userData);
+        return;
+    }
+
+    /** No more threads than there are chunks to go round. */
+    u32 participantCount = count / minChunk < statePtr->threadCount ? count / minChunk : statePtr->threadCount;
+    statePtr->body = body;
+    statePtr->userData = userData;
+    statePtr->minChunk = minChunk;
+    statePtr->participantCount = participantCount;
+    atomicStore64(&statePtr->nextParticipant, 1);
+    atomicStore64(&statePtr->remaining, count);
+    atomicStore64(&statePtr->finishedWorkers, 0);
+
+    for (u32 i = 0; i < participantCount; ++i) {
+        u32 shareBegin = begin + (u32)(((u64)count * i) / participantCount);
+        u32 shareEnd = begin + (u32)(((u64)count * (i + 1)) / participantCount);
+        atomicStore64(&statePtr->slots[i].range, packRange(shareBegin, shareEnd));
+    }
+
+    platformSemaphoreSignal(&statePtr->wakeSemaphore, participantCount - 1);
+    runParticipant(0);
+
+    /** Other threads may still be inside their last chunk, or not have woken up yet. */
+    while (atomicLoad64(&statePtr->remaining) || atomicLoad64(&statePtr->finishedWorkers) < participantCount - 1) {
+        platformThreadYield();
+    }
+
+    atomicStore64(&statePtr->busy, 0);
+}
+
+u32 parallelForGetThreadCount() {
+    return statePtr ? statePtr->threadCount : 1;
+}
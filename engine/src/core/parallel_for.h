@@ -0,0 +1,62 @@
+#ifndef __ENGINE_PARALLEL_FOR_H__
+#define __ENGINE_PARALLEL_FOR_H__
+
+#include "../defines.h"
+
+/** Most threads a loop is split across, the calling thread included. */
+#define PARALLEL_FOR_MAX_THREADS 64
+
+/**
+ * @brief Body of a parallel loop. Processes the indices [begin, end); each
+ * index of the loop is handed to exactly one call.
+ */
+typedef void (*PFN_parallelForBody)(u32 begin, u32 end, void *userData);
+
+typedef struct ParallelForConfig {
+    /** Worker threads to start besides the calling thread; 0 for one per remaining core. */
+    u32 workerCount;
+} ParallelForConfig;
+
+/**
+ * @brief Initializes the parallel-for pool. Call twice; once with state = 0 to
+ * get required memory size, then a second time passing allocated memory to
+ * state. The second call starts the workers, which sleep until a loop runs.
+ *
+ * The pool is separate from the job system so that short data-parallel loops
+ * never queue behind longer jobs.
+ *
+ * @param memoryRequirement A pointer to hold the required memory size.
+ * @param state 0 if just requesting memory requirement, otherwise allocated block of memory.
+ * @param config The pool configuration.
+ * @return True on success; otherwise false.
+ */
+b8 parallelForSystemInitialize(u64 *memoryRequirement, void *state, ParallelForConfig config);
+
+/** @brief Stops and joins the workers. */
+void parallelForSystemShutdown(void *state);
+
+/**
+ * @brief Runs body over [begin, end) on the calling thread and the pool, and
+ * returns once every index has been processed.
+ *
+ * The range starts out split evenly between the threads. Each thread eats
+ * its share minChunk indices at a time, and a thread that runs dry steals the
+ * back half of the largest share left, so ranges are only split further when
+ * a thread actually needs work. Nothing is allocated per call or per index.
+ *
+ * Ranges shorter than two chunks, loops started while another one is running
+ * (including from inside a body), and loops before initialization all run
+ * serially on the calling thread.
+ *
+ * @param begin The first index.
+ * @param end One past the last index.
+ * @param minChunk The fewest indices handed to one body call; 0 is treated as 1.
+ * @param body The loop body. Required.
+ * @param userData Passed to body.
+ */
+ENGINE_API void parallelFor(u32 begin, u32 end, u32 minChunk, PFN_parallelForBody body, void *userData);
+
+/** @brief Number of threads a loop can run on, the calling thread included; 1 before initialization. */
+ENGINE_API u32 parallelForGetThreadCount();
+
+#endif
@@ -0,0 +1,326 @@
+#include "task_graph.h"
+
+#include "atomic.h"
+#include "job_system.h"
+#include "logger.h"
+
+#include "../engine_memory/engine_memory.h"
+#include "../engine_memory/engine_string.h"
+#include "../platform/platform.h"
+
+/**
+ * Per-resource state while compiling, kept after the public resources: the
+ * last task to write it and the newest access reading it since then. Older
+ * readers chain back through a link stored after the accesses.
+ */
+typedef struct TaskGraphCompileResource {
+    u32 lastWriter;
+    u32 lastReader;
+} TaskGraphCompileResource;
+
+/** Sizes of the arrays carved out of the graph's block, in carving order. */
+static u64 tasksSize(u32 maxTasks) {
+    return sizeof(TaskGraphTask) * maxTasks;
+}
+
+static u64 mainReadySize(u32 maxTasks) {
+    return sizeof(u64) * maxTasks;
+}
+
+static u64 resourcesSize(u32 maxResources) {
+    return (sizeof(TaskGraphResource) + sizeof(TaskGraphCompileResource)) * maxResources;
+}
+
+static u64 accessesSize(u32 maxAccesses) {
+    /** Each access also gets a link to the previous reader of the same resource. */
+    return (sizeof(TaskGraphAccess) + sizeof(u32)) * maxAccesses;
+}
+
+/** A read adds at most one edge from the last writer and one into the next writer; a write at most one. */
+static u64 edgesSize(u32 maxAccesses) {
+    return sizeof(u32) * 2 * (2 * (u64)maxAccesses);
+}
+
+static u64 successorsSize(u32 maxAccesses) {
+    return sizeof(u32) * 2 * (u64)maxAccesses;
+}
+
+b8 taskGraphCreate(u32 maxTasks, u32 maxResources, u32 maxAccesses,
+    u64 *memoryRequirement, void *memory, TaskGraph *outGraph) {
+
+    if (!memoryRequirement || maxTasks == 0) {
+        ENGINE_ERROR("taskGraphCreate requires a memoryRequirement and room for at least one task.")
+        return false;
+    }
+
+    /**
+     * Block of memory will contain the tasks, the main-thread ready list, the
+     * resources, the accesses, then the edges and successors built by compiling.
+     */
+    *memoryRequirement = tasksSize(maxTasks) + mainReadySize(maxTasks) + resourcesSize(maxResources) +
+        accessesSize(maxAccesses) + edgesSize(maxAccesses) + successorsSize(maxAccesses);
+    if (!memory) {
+        return true;
+    }
+
+    if (!outGraph) {
+        ENGINE_ERROR("taskGraphCreate requires outGraph when memory is passed.")
+        return false;
+    }
+
+    engineZeroMemory(outGraph, sizeof(TaskGraph));
+    engineZeroMemory(memory, *memoryRequirement);
+    outGraph->maxTasks = maxTasks;
+    outGraph->maxResources = maxResources;
+    outGraph->maxAccesses = maxAccesses;
+
+    u8 *block = memory;
+    outGraph->tasks = (TaskGraphTask*)block;
+    block += tasksSize(maxTasks);
+    outGraph->mainReady = (volatile u64*)block;
+    block += mainReadySize(maxTasks);
+    outGraph->resources = (TaskGraphResource*)block;
+    block += resourcesSize(maxResources);
+    outGraph->accesses = (TaskGraphAccess*)block;
+    block += accessesSize(maxAccesses);
+    outGraph->edges = (u32*)block;
+    block += edgesSize(maxAccesses);
+    outGraph->successors = (u32*)block;
+
+    return true;
+}
+
+u32 taskGraphAddTask(TaskGraph *graph, const char *name, PFN_taskGraphTask run, void *userData,
+    b8 mainThread) {
+
+    if (!graph || !run) {
+        ENGINE_ERROR("taskGraphAddTask requires a graph and a run function.")
+        return INVALID_ID;
+    }
+
+    if (graph->taskCount == graph->maxTasks) {
+        ENGINE_ERROR("Task graph is full (%u tasks); cannot add '%s'.", graph->maxTasks, name ? name : "")
+        return INVALID_ID;
+    }
+
+    u32 index = graph->taskCount++;
+    TaskGraphTask *task = &graph->tasks[index];
+    engineZeroMemory(task, sizeof(TaskGraphTask));
+    task->name = name ? name : "";
+    task->run = run;
+    task->userData = userData;
+    task->mainThread = mainThread;
+    graph->compiled = false;
+
+    return index;
+}
+
+static b8 addAccess(TaskGraph *graph, u32 task, const char *resource, b8 write) {
+    if (!graph || task >= graph->taskCount || !resource) {
+        ENGINE_ERROR("Task graph access needs a graph, one of its tasks and a resource name.")
+        return false;
+    }
+
+    u32 resourceIndex = INVALID_ID;
+    for (u32 i = 0; i < graph->resourceCount; ++i) {
+        if (stringsEqual(graph->resources[i].name, resource)) {
+            resourceIndex = i;
+            break;
+        }
+    }
+
+    if (resourceIndex == INVALID_ID) {
+        if (graph->resourceCount == graph->maxResources) {
+            ENGINE_ERROR("Task graph is out of resources (%u); cannot add '%s'.", graph->maxResources, resource)
+            return false;
+        }
+
+        resourceIndex = graph->resourceCount++;
+        graph->resources[resourceIndex].name = resource;
+    }
+
+    if (graph->accessCount == graph->maxAccesses) {
+        ENGINE_ERROR("Task graph is out of accesses (%u).", graph->maxAccesses)
+        return false;
+    }
+
+    TaskGraphAccess *access = &graph->accesses[graph->accessCount++];
+    access->task = task;
+    access->resource = resourceIndex;
+    access->write = write;
+    graph->compiled = false;
+
+    return true;
+}
+
+b8 taskGraphRead(TaskGraph *graph, u32 task, const char *resource) {
+    return addAccess(graph, task, resource, false);
+}
+
+b8 taskGraphWrite(TaskGraph *graph, u32 task, const char *resource) {
+    return addAccess(graph, task, resource, true);
+}
+
+static void addEdge(TaskGraph *graph, u32 from, u32 to) {
+    if (from != to) {
+        graph->edges[graph->edgeCount * 2] = from;
+        graph->edges[(graph->edgeCount * 2) + 1] = to;
+        graph->edgeCount++;
+    }
+}
+
+/** Turns the declared accesses into dependency counts and successor lists. */
+static void compile(TaskGraph *graph) {
+    TaskGraphCompileResource *resourceState = (TaskGraphCompileResource*)(graph->resources + graph->maxResources);
+    u32 *previousReader = (u32*)(graph->accesses + graph->maxAccesses);
+    for (u32 i = 0; i < graph->resourceCount; ++i) {
+        resourceState[i].lastWriter = INVALID_ID;
+        resourceState[i].lastReader = INVALID_ID;
+    }
+
+    /** Walk the accesses task by task, so declaration order of tasks decides who goes first. */
+    graph->edgeCount = 0;
+    for (u32 task = 0; task < graph->taskCount; ++task) {
+        for (u32 i = 0; i < graph->accessCount; ++i) {
+            TaskGraphAccess *access = &graph->accesses[i];
+            if (access->task != task) {
+                continue;
+            }
+
+            TaskGraphCompileResource *resource = &resourceState[access->resource];
+            if (!access->write) {
+                if (resource->lastWriter != INVALID_ID) {
+                    addEdge(graph, resource->lastWriter, task);
+                }
+
+                previousReader[i] = resource->lastReader;
+                resource->lastReader = i;
+                continue;
+            }
+
+            if (resource->lastReader != INVALID_ID) {
+                for (u32 reader = resource->lastReader; reader != INVALID_ID; reader = previousReader[reader]) {
+                    addEdge(graph, graph->accesses[reader].task, task);
+                }
+            } else if (resource->lastWriter != INVALID_ID) {
+                addEdge(graph, resource->lastWriter, task);
+            }
+
+            resource->lastWriter = task;
+            resource->lastReader = INVALID_ID;
+        }
+    }
+
+    for (u32 i = 0; i < graph->taskCount; ++i) {
+        graph->tasks[i].dependencyCount = 0;
+        graph->tasks[i].successorCount = 0;
+    }
+
+    for (u32 i = 0; i < graph->edgeCount; ++i) {
+        graph->tasks[graph->edges[i * 2]].successorCount++;
+        graph->tasks[graph->edges[(i * 2) + 1]].dependencyCount++;
+    }
+
+    /** Lay the successor lists out back to back, then fill them using the counts as cursors. */
+    u32 offset = 0;
+    for (u32 i = 0; i < graph->taskCount; ++i) {
+        graph->tasks[i].successorOffset = offset;
+        offset += graph->tasks[i].successorCount;
+        graph->tasks[i].successorCount = 0;
+    }
+
+    for (u32 i = 0; i < graph->edgeCount; ++i) {
+        TaskGraphTask *from = &graph->tasks[graph->edges[i * 2]];
+        graph->successors[from->successorOffset + from->successorCount++] = graph->edges[(i * 2) + 1];
+    }
+
+    graph->compiled = true;
+}
+
+static void taskJob(void *data);
+
+static void makeReady(TaskGraph *graph, u32 index) {
+    TaskGraphTask *task = &graph->tasks[index];
+    if (task->mainThread) {
+        u64 slot = atomicFetchAdd64(&graph->mainReadyCount, 1);
+        atomicStore64(&graph->mainReady[slot], index + 1);
+        return;
+    }
+
+    /** The job system copies the declaration, so a local is enough and nothing is allocated. */
+    JobDecl job;
+    job.entry = taskJob;
+    job.data = task;
+    job.priority = JOB_PRIORITY_HIGH;
+    jobSystemRun(&job, 1, 0);
+}
+
+static void runTask(TaskGraphTask *task) {
+    TaskGraph *graph = task->graph;
+    if (!atomicLoad64(&graph->failed) && !task->run(task->userData)) {
+        ENGINE_ERROR("Task '%s' failed; tasks that have not started are skipped.", task->name)
+        atomicStore64(&graph->failed, true);
+    }
+
+    for (u32 i = 0; i < task->successorCount; ++i) {
+        u32 successor = graph->successors[task->successorOffset + i];
+        if (atomicFetchSub64(&graph->tasks[successor].remaining, 1) == 1) {
+            makeReady(graph, successor);
+        }
+    }
+
+    atomicFetchSub64(&graph->remainingTasks, 1);
+}
+
+static void taskJob(void *data) {
+    runTask(data);
+}
+
+b8 taskGraphExecute(TaskGraph *graph) {
+    if (!graph) {
+        return false;
+    }
+
+    if (!graph->compiled) {
+        compile(graph);
+    }
+
+    if (graph->taskCount == 0) {
+        return true;
+    }
+
+    atomicStore64(&graph->failed, false);
+    atomicStore64(&graph->remainingTasks, graph->taskCount);
+    atomicStore64(&graph->mainReadyCount, 0);
+    for (u32 i = 0; i < graph->taskCount; ++i) {
+        TaskGraphTask *task = &graph->tasks[i];
+        task->graph = graph;
+        atomicStore64(&graph->mainReady[i], 0);
+        atomicStore64(&task->remaining, task->dependencyCount);
+    }
+
+    for (u32 i = 0; i < graph->taskCount; ++i) {
+        if (graph->tasks[i].dependencyCount == 0) {
+            makeReady(graph, i);
+        }
+    }
+
+    /** Main-thread tasks in the order they became ready; a slot reads 0 until its writer finishes. */
+    u64 nextMainTask = 0;
+    while (atomicLoad64(&graph->remainingTasks)) {
+        if (nextMainTask < atomicLoad64(&graph->mainReadyCount)) {
+            u64 ready = atomicLoad64(&graph->mainReady[nextMainTask]);
+            if (ready) {
+                nextMainTask++;
+                runTask(&graph->tasks[ready - 1]);
+                continue;
+            }
+        }
+
+        if (!jobSystemRunOne()) {
+            platformThreadYield();
+        }
+    }
+
+    return !atomicLoad64(&graph->failed);
+}
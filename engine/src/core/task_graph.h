@@ -0,0 +1,128 @@
+#ifndef __ENGINE_TASK_GRAPH_H__
+#define __ENGINE_TASK_GRAPH_H__
+
+#include "../defines.h"
+
+/** @brief A task's work. Return false to fail the run; tasks after it are then skipped. */
+typedef b8 (*PFN_taskGraphTask)(void *userData);
+
+typedef struct TaskGraphTask {
+    const char *name;
+    PFN_taskGraphTask run;
+    void *userData;
+
+    /** Runs on the thread that calls taskGraphExecute rather than on a job worker. */
+    b8 mainThread;
+
+    /** Tasks that must finish first, and where this task's successors start in the graph's list. */
+    u32 dependencyCount;
+    u32 successorOffset;
+    u32 successorCount;
+
+    /** Dependencies still running during an execution. */
+    volatile u64 remaining;
+
+    struct TaskGraph *graph;
+} TaskGraphTask;
+
+typedef struct TaskGraphResource {
+    const char *name;
+} TaskGraphResource;
+
+typedef struct TaskGraphAccess {
+    u32 task;
+    u32 resource;
+    b8 write;
+} TaskGraphAccess;
+
+/**
+ * @brief Tasks that declare which named resources they read and write, run
+ * as a dependency graph. Build it once, then execute it as often as needed;
+ * execution allocates nothing. Members of this structure should not be
+ * modified outside the functions associated with it.
+ *
+ * Declaration order decides who goes first on a shared resource: a reader
+ * waits for the last task declared before it that writes the resource, and
+ * a writer waits for every reader since that write (or for the writer itself
+ * if none read it). Tasks that share no resource can run at the same time.
+ */
+typedef struct TaskGraph {
+    u32 maxTasks;
+    u32 maxResources;
+    u32 maxAccesses;
+
+    u32 taskCount;
+    u32 resourceCount;
+    u32 accessCount;
+
+    TaskGraphTask *tasks;
+    TaskGraphResource *resources;
+    TaskGraphAccess *accesses;
+
+    /** Compile output: every task's successors, back to back. Two per access at most. */
+    u32 *successors;
+    u32 edgeCount;
+    u32 *edges;
+
+    /** Main-thread tasks that are ready, as task index + 1 so 0 can mean not yet written. */
+    volatile u64 *mainReady;
+    volatile u64 mainReadyCount;
+
+    volatile u64 remainingTasks;
+    volatile u64 failed;
+
+    /** False after tasks or accesses were added; the next execution compiles first. */
+    b8 compiled;
+} TaskGraph;
+
+/**
+ * @brief Creates an empty task graph, or obtains the memory requirement for one.
+ * Call twice; once passing 0 to memory to obtain the memory requirement,
+ * and a second time passing an allocated block to memory.
+ *
+ * @param maxTasks The most tasks the graph can hold.
+ * @param maxResources The most distinct resource names.
+ * @param maxAccesses The most reads and writes declared over all tasks.
+ * @param memoryRequirement A pointer to hold the memory requirement.
+ * @param memory 0, or a pre-allocated block of memory for the graph to use.
+ * @param outGraph A pointer to hold the graph.
+ * @return True on success; otherwise false.
+ */
+ENGINE_API b8 taskGraphCreate(u32 maxTasks, u32 maxResources, u32 maxAccesses,
+    u64 *memoryRequirement, void *memory, TaskGraph *outGraph);
+
+/**
+ * @brief Adds a task. Its reads and writes are declared afterwards.
+ *
+ * @param graph The graph.
+ * @param name Used in logs; must outlive the graph.
+ * @param run The task's work. Required.
+ * @param userData Passed to run.
+ * @param mainThread True if the task must run on the thread that executes the graph.
+ * @return The task's index; INVALID_ID if the graph is full.
+ */
+ENGINE_API u32 taskGraphAddTask(TaskGraph *graph, const char *name, PFN_taskGraphTask run, void *userData,
+    b8 mainThread);
+
+/**
+ * @brief Declares that task reads the named resource. Names are compared by
+ * content and must outlive the graph.
+ *
+ * @return True on success; false if the graph is out of resources or accesses.
+ */
+ENGINE_API b8 taskGraphRead(TaskGraph *graph, u32 task, const char *resource);
+
+/** @brief Declares that task writes the named resource. See taskGraphRead. */
+ENGINE_API b8 taskGraphWrite(TaskGraph *graph, u32 task, const char *resource);
+
+/**
+ * @brief Runs every task once, respecting their dependencies, and returns
+ * when all have finished. Tasks without mainThread go to the job system; the
+ * calling thread runs the main-thread tasks and helps with jobs in between.
+ * The first call after tasks were added works out the dependencies.
+ *
+ * @return True if every task succeeded; otherwise false.
+ */
+ENGINE_API b8 taskGraphExecute(TaskGraph *graph);
+
+#endif
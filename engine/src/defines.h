@@ -124,6 +124,13 @@ STATIC_ASSERT(sizeof(f64) == 8, "Expected u8 to be 1 byte.");
 
 #define ENGINE_CLAMP(value, min, max) (value <= min) ? min : (value >= max) ? max : value;
 
+/** Thread-local storage. */
+#ifdef _MSC_VER
+#define ENGINE_THREAD_LOCAL __declspec(thread)
+#else
+#define ENGINE_THREAD_LOCAL _Thread_local
+#endif
+
 /** Inlining */
 #ifdef _MSC_VER
 #define ENGINE_INLINE __forceinline
@@ -131,7 +138,7 @@ STATIC_ASSERT(sizeof(f64) == 8, "Expected u8 to be 1 byte.");
 
 #else
 #define ENGINE_INLINE static inline
-#define ENGINE_NOINLINE
+#define ENGINE_NOINLINE __attribute__((noinline))
 #endif
 
 #endif
@@ -0,0 +1,60 @@
+#include "allocator.h"
+
+#include "linear_allocator.h"
+#include "stack_allocator.h"
+#include "virtual_arena.h"
+#include "buddy_allocator.h"
+
+/** The heap tag travels in the instance pointer. */
+static void *heapAllocate(void *instance, u64 size, u64 alignment) {
+    return engineAllocateAligned(size, alignment ? alignment : 1, (MemoryTag)(u64)instance);
+}
+
+static void heapFree(void *instance, void *block, u64 size, u64 alignment) {
+    engineFreeAligned(block, size, alignment ? alignment : 1, (MemoryTag)(u64)instance);
+}
+
+static void *linearAllocate(void *instance, u64 size, u64 alignment) {
+    return linearAllocatorAllocateAligned(instance, size, alignment ? alignment : 1);
+}
+
+static void *stackAllocate(void *instance, u64 size, u64 alignment) {
+    return stackAllocatorAllocate(instance, size, alignment ? alignment : 1);
+}
+
+static void *arenaAllocate(void *instance, u64 size, u64 alignment) {
+    return virtualArenaAllocateAligned(instance, size, alignment ? alignment : 1);
+}
+
+static void *buddyAllocate(void *instance, u64 size, u64 alignment) {
+    return buddyAllocatorAllocate(instance, size);
+}
+
+static void buddyFree(void *instance, void *block, u64 size, u64 alignment) {
+    buddyAllocatorFree(instance, block, size);
+}
+
+EngineAllocator engineAllocatorHeap(MemoryTag tag) {
+    EngineAllocator allocator = { heapAllocate, heapFree, (void*)(u64)tag };
+    return allocator;
+}
+
+EngineAllocator engineAllocatorLinear(LinearAllocator *allocator) {
+    EngineAllocator result = { linearAllocate, 0, allocator };
+    return result;
+}
+
+EngineAllocator engineAllocatorStack(StackAllocator *allocator) {
+    EngineAllocator result = { stackAllocate, 0, allocator };
+    return result;
+}
+
+EngineAllocator engineAllocatorVirtualArena(VirtualArena *arena) {
+    EngineAllocator result = { arenaAllocate, 0, arena };
+    return result;
+}
+
+EngineAllocator engineAllocatorBuddy(BuddyAllocator *allocator) {
+    EngineAllocator result = { buddyAllocate, buddyFree, allocator };
+    return result;
+}
@@ -0,0 +1,62 @@
+#ifndef __ENGINE_ALLOCATOR_H__
+#define __ENGINE_ALLOCATOR_H__
+
+#include "../defines.h"
+#include "engine_memory.h"
+
+struct LinearAllocator;
+struct StackAllocator;
+struct VirtualArena;
+struct BuddyAllocator;
+
+typedef void *(*PFN_allocatorAllocate)(void *instance, u64 size, u64 alignment);
+typedef void (*PFN_allocatorFree)(void *instance, void *block, u64 size, u64 alignment);
+
+/**
+ * @brief A handle to any of the engine allocators, so containers can be
+ * pointed at one without knowing which. Held by value; instance must outlive
+ * whatever uses it.
+ */
+typedef struct EngineAllocator {
+    PFN_allocatorAllocate allocate;
+
+    /** 0 for allocators that only release everything at once. */
+    PFN_allocatorFree free;
+    void *instance;
+} EngineAllocator;
+
+/** @brief The engine heap (engineAllocateAligned/engineFreeAligned), under the given tag. */
+ENGINE_API EngineAllocator engineAllocatorHeap(MemoryTag tag);
+
+/** @brief A linear allocator; individual frees are ignored. */
+ENGINE_API EngineAllocator engineAllocatorLinear(struct LinearAllocator *allocator);
+
+/** @brief A stack allocator; individual frees are ignored, roll back with markers. */
+ENGINE_API EngineAllocator engineAllocatorStack(struct StackAllocator *allocator);
+
+/** @brief A virtual arena; individual frees are ignored. */
+ENGINE_API EngineAllocator engineAllocatorVirtualArena(struct VirtualArena *arena);
+
+/** @brief A buddy allocator. Blocks are aligned to at least its minimum block size. */
+ENGINE_API EngineAllocator engineAllocatorBuddy(struct BuddyAllocator *allocator);
+
+/**
+ * @brief Allocates from the given allocator.
+ *
+ * @return The block, or 0 if the allocator is out of space.
+ */
+ENGINE_INLINE void *engineAllocatorAllocate(const EngineAllocator *allocator, u64 size, u64 alignment) {
+    return allocator->allocate(allocator->instance, size, alignment);
+}
+
+/**
+ * @brief Frees a block, if the allocator supports individual frees. size and
+ * alignment must match those passed to engineAllocatorAllocate.
+ */
+ENGINE_INLINE void engineAllocatorFree(const EngineAllocator *allocator, void *block, u64 size, u64 alignment) {
+    if (allocator->free) {
+        allocator->free(allocator->instance, block, size, alignment);
+    }
+}
+
+#endif
@@ -0,0 +1,269 @@
+#include "buddy_allocator.h"
+
+#include "engine_memory.h"
+#include "../core/logger.h"
+
+/** Block table entries: 0 for bytes inside a block, order + 1 for a block head, plus this bit when free. */
+#define BUDDY_BLOCK_FREE 0x80
+
+typedef struct BuddyFreeBlock {
+    struct BuddyFreeBlock *prev;
+    struct BuddyFreeBlock *next;
+} BuddyFreeBlock;
+
+typedef struct BuddyAllocatorState {
+    u64 totalSize;
+    u64 minBlockSize;
+    u32 minBlockShift;
+    u32 orderCount;
+
+    u64 requestedSize;
+    u64 usedSize;
+    u64 allocationCount;
+
+    BuddyFreeBlock *freeLists[BUDDY_ALLOCATOR_MAX_ORDERS];
+    u64 freeCounts[BUDDY_ALLOCATOR_MAX_ORDERS];
+
+    /** One entry per minimum-size block. */
+    u8 *blockTable;
+    u8 *region;
+} BuddyAllocatorState;
+
+/** Rounded to a cache line so the region keeps the alignment of the block it is carved from. */
+static u64 roundToCacheLine(u64 size) {
+    return (size + 63) & ~63ULL;
+}
+
+static u64 roundToPowerOfTwo(u64 size) {
+    u64 result = 1;
+    while (result < size) {
+        result <<= 1;
+    }
+
+    return result;
+}
+
+static void pushFreeBlock(BuddyAllocatorState *state, u64 index, u32 order) {
+    BuddyFreeBlock *block = (BuddyFreeBlock*)(state->region + (index << state->minBlockShift));
+    block->prev = 0;
+    block->next = state->freeLists[order];
+    if (block->next) {
+        block->next->prev = block;
+    }
+
+    state->freeLists[order] = block;
+    state->freeCounts[order]++;
+    state->blockTable[index] = (u8)(order + 1) | BUDDY_BLOCK_FREE;
+}
+
+static void removeFreeBlock(BuddyAllocatorState *state, u64 index, u32 order) {
+    BuddyFreeBlock *block = (BuddyFreeBlock*)(state->region + (index << state->minBlockShift));
+    if (block->prev) {
+        block->prev->next = block->next;
+    } else {
+        state->freeLists[order] = block->next;
+    }
+
+    if (block->next) {
+        block->next->prev = block->prev;
+    }
+
+    state->freeCounts[order]--;
+    state->blockTable[index] = 0;
+}
+
+b8 buddyAllocatorCreate(u64 totalSize, u64 minBlockSize, u64 *memoryRequirement,
+    void *memory, BuddyAllocator *outAllocator) {
+
+    if (!memoryRequirement) {
+        ENGINE_ERROR("buddyAllocatorCreate requires memoryRequirement to exist. Create failed.")
+        return false;
+    }
+
+    if (minBlockSize < sizeof(BuddyFreeBlock) || (minBlockSize & (minBlockSize - 1))) {
+        ENGINE_ERROR("buddyAllocatorCreate - minBlockSize %llu must be a power of two of at least %lluB.",
+            minBlockSize, (u64)sizeof(BuddyFreeBlock))
+        return false;
+    }
+
+    totalSize = roundToPowerOfTwo(totalSize < minBlockSize ? minBlockSize : totalSize);
+
+    u32 orderCount = 1;
+    while ((minBlockSize << (orderCount - 1)) < totalSize) {
+        ++orderCount;
+    }
+
+    if (orderCount > BUDDY_ALLOCATOR_MAX_ORDERS) {
+        ENGINE_ERROR("buddyAllocatorCreate - %lluB in %lluB blocks needs more than %u orders.",
+            totalSize, minBlockSize, BUDDY_ALLOCATOR_MAX_ORDERS)
+        return false;
+    }
+
+    /** State, then the block table, then the region itself. */
+    u64 blockCount = totalSize / minBlockSize;
+    u64 stateRequirement = roundToCacheLine(sizeof(BuddyAllocatorState));
+    u64 tableRequirement = roundToCacheLine(blockCount);
+    *memoryRequirement = stateRequirement + tableRequirement + totalSize;
+
+    if (!memory) {
+        return true;
+    }
+
+    if (!outAllocator) {
+        ENGINE_ERROR("buddyAllocatorCreate requires outAllocator to exist. Create failed.")
+        return false;
+    }
+
+    outAllocator->memory = memory;
+    BuddyAllocatorState *state = memory;
+    engineZeroMemory(state, sizeof(BuddyAllocatorState));
+    state->totalSize = totalSize;
+    state->minBlockSize = minBlockSize;
+    state->orderCount = orderCount;
+    while (((u64)1 << state->minBlockShift) < minBlockSize) {
+        state->minBlockShift++;
+    }
+
+    state->blockTable = (u8*)memory + stateRequirement;
+    state->region = state->blockTable + tableRequirement;
+    engineZeroMemory(state->blockTable, blockCount);
+
+    /** The whole region starts out as a single free block of the top order. */
+    pushFreeBlock(state, 0, orderCount - 1);
+
+    return true;
+}
+
+void buddyAllocatorDestroy(BuddyAllocator *allocator) {
+    if (allocator && allocator->memory) {
+        engineZeroMemory(allocator->memory, sizeof(BuddyAllocatorState));
+        allocator->memory = 0;
+    }
+}
+
+void *buddyAllocatorAllocate(BuddyAllocator *allocator, u64 size) {
+    if (!allocator || !allocator->memory || !size) {
+        return 0;
+    }
+
+    BuddyAllocatorState *state = allocator->memory;
+
+    u32 order = 0;
+    while ((state->minBlockSize << order) < size) {
+        if (++order >= state->orderCount) {
+            return 0;
+        }
+    }
+
+    /** Smallest order with a free block, then split it down. */
+    u32 available = order;
+    while (available < state->orderCount && !state->freeLists[available]) {
+        ++available;
+    }
+
+    if (available >= state->orderCount) {
+        return 0;
+    }
+
+    u64 index = (u64)((u8*)state->freeLists[available] - state->region) >> state->minBlockShift;
+    removeFreeBlock(state, index, available);
+
+    while (available > order) {
+        --available;
+        pushFreeBlock(state, index + ((u64)1 << available), available);
+    }
+
+    state->blockTable[index] = (u8)(order + 1);
+    state->requestedSize += size;
+    state->usedSize += state->minBlockSize << order;
+    state->allocationCount++;
+
+    return state->region + (index << state->minBlockShift);
+}
+
+b8 buddyAllocatorFree(BuddyAllocator *allocator, void *block, u64 size) {
+    if (!allocator || !allocator->memory || !block) {
+        ENGINE_ERROR("buddyAllocatorFree requires both a valid allocator and a block to be freed.")
+        return false;
+    }
+
+    if (!buddyAllocatorOwns(allocator, block)) {
+        ENGINE_ERROR("buddyAllocatorFree - block (%p) is not owned by this allocator.", block)
+        return false;
+    }
+
+    BuddyAllocatorState *state = allocator->memory;
+    u64 offset = (u64)((u8*)block - state->region);
+    u64 index = offset >> state->minBlockShift;
+    u8 entry = state->blockTable[index];
+    if ((offset & (state->minBlockSize - 1)) || entry == 0 || (entry & BUDDY_BLOCK_FREE)) {
+        ENGINE_ERROR("buddyAllocatorFree - block (%p) is not a live allocation; double free?", block)
+        return false;
+    }
+
+    u32 order = entry - 1;
+    state->requestedSize -= size;
+    state->usedSize -= state->minBlockSize << order;
+    state->allocationCount--;
+
+    /** Merge upwards while the buddy is a free block of the same order. */
+    while (order + 1 < state->orderCount) {
+        u64 buddy = index ^ ((u64)1 << order);
+        if (state->blockTable[buddy] != ((u8)(order + 1) | BUDDY_BLOCK_FREE)) {
+            break;
+        }
+
+        removeFreeBlock(state, buddy, order);
+        state->blockTable[index] = 0;
+        index = index < buddy ? index : buddy;
+        ++order;
+    }
+
+    pushFreeBlock(state, index, order);
+
+    return true;
+}
+
+b8 buddyAllocatorOwns(BuddyAllocator *allocator, const void *block) {
+    if (!allocator || !allocator->memory || !block) {
+        return false;
+    }
+
+    BuddyAllocatorState *state = allocator->memory;
+    return (const u8*)block >= state->region && (const u8*)block < state->region + state->totalSize;
+}
+
+void buddyAllocatorGetStats(BuddyAllocator *allocator, BuddyAllocatorStats *outStats) {
+    if (!outStats) {
+        return;
+    }
+
+    engineZeroMemory(outStats, sizeof(BuddyAllocatorStats));
+    if (!allocator || !allocator->memory) {
+        return;
+    }
+
+    BuddyAllocatorState *state = allocator->memory;
+    outStats->totalSize = state->totalSize;
+    outStats->minBlockSize = state->minBlockSize;
+    outStats->requestedSize = state->requestedSize;
+    outStats->usedSize = state->usedSize;
+    outStats->freeSpace = state->totalSize - state->usedSize;
+    outStats->allocationCount = state->allocationCount;
+    outStats->orderCount = state->orderCount;
+
+    for (u32 i = 0; i < state->orderCount; ++i) {
+        outStats->freeBlocksPerOrder[i] = state->freeCounts[i];
+        if (state->freeCounts[i]) {
+            outStats->largestFreeBlock = state->minBlockSize << i;
+        }
+    }
+
+    if (outStats->usedSize) {
+        outStats->internalFragmentation = 1.0f - ((f32)outStats->requestedSize / (f32)outStats->usedSize);
+    }
+
+    if (outStats->freeSpace) {
+        outStats->externalFragmentation = 1.0f - ((f32)outStats->largestFreeBlock / (f32)outStats->freeSpace);
+    }
+}
@@ -0,0 +1,96 @@
+#ifndef __ENGINE_BUDDY_ALLOCATOR_H__
+#define __ENGINE_BUDDY_ALLOCATOR_H__
+
+#include "../defines.h"
+
+/** Upper bound on the number of block orders, min block size through the whole region. */
+#define BUDDY_ALLOCATOR_MAX_ORDERS 32
+
+/**
+ * @brief A binary buddy allocator over a power-of-two region. Requests are
+ * rounded up to a power-of-two block, which is split off a larger free block
+ * and merged back with its buddy when freed, so allocating and freeing are
+ * both O(log n) and fragmentation stays bounded. Suits variable-size blocks
+ * that are freed in any order.
+ */
+typedef struct BuddyAllocator {
+    /** Internal state, block table and region. */
+    void *memory;
+} BuddyAllocator;
+
+typedef struct BuddyAllocatorStats {
+    u64 totalSize;
+    u64 minBlockSize;
+
+    /** Bytes asked for by live allocations. */
+    u64 requestedSize;
+
+    /** Bytes of the blocks backing those allocations. */
+    u64 usedSize;
+    u64 freeSpace;
+    u64 largestFreeBlock;
+    u64 allocationCount;
+
+    /** Number of free blocks of each order; order n blocks are minBlockSize << n bytes. */
+    u64 freeBlocksPerOrder[BUDDY_ALLOCATOR_MAX_ORDERS];
+    u32 orderCount;
+
+    /** Share of used block bytes lost to rounding up to a power of two. */
+    f32 internalFragmentation;
+
+    /** Share of free space outside the largest free block. */
+    f32 externalFragmentation;
+} BuddyAllocatorStats;
+
+/**
+ * @brief Creates a new buddy allocator or obtains the memory requirement for one.
+ * Call twice; once passing 0 to memory to obtain the memory requirement,
+ * and a second time passing an allocated block to memory.
+ *
+ * @param totalSize The size of the managed region. Rounded up to a power of two.
+ * @param minBlockSize The smallest block handed out. Power of two, at least 16.
+ * @param memoryRequirement A pointer to hold the memory requirement, region included.
+ * @param memory 0, or a pre-allocated block of memory for the allocator to use.
+ * @param outAllocator A pointer to hold the allocator.
+ * @return True on success; otherwise false.
+ */
+ENGINE_API b8 buddyAllocatorCreate(u64 totalSize, u64 minBlockSize, u64 *memoryRequirement,
+    void *memory, BuddyAllocator *outAllocator);
+
+/**
+ * @brief Destroys the given allocator. Does not release the memory passed to
+ * buddyAllocatorCreate.
+ */
+ENGINE_API void buddyAllocatorDestroy(BuddyAllocator *allocator);
+
+/**
+ * @brief Allocates the smallest power-of-two block that holds size bytes.
+ *
+ * @param allocator A pointer to the allocator to allocate from.
+ * @param size The amount in bytes to be allocated.
+ * @return The block, or 0 if no free block is large enough.
+ */
+ENGINE_API void *buddyAllocatorAllocate(BuddyAllocator *allocator, u64 size);
+
+/**
+ * @brief Frees a block and merges it with its buddy for as long as the buddy is free.
+ *
+ * @param allocator A pointer to the allocator that owns the block.
+ * @param block The block to be freed.
+ * @param size The size passed when allocating; only used for the stats.
+ * @return True on success; otherwise false.
+ */
+ENGINE_API b8 buddyAllocatorFree(BuddyAllocator *allocator, void *block, u64 size);
+
+/** @brief Indicates if the given block lies within the allocator's region. */
+ENGINE_API b8 buddyAllocatorOwns(BuddyAllocator *allocator, const void *block);
+
+/**
+ * @brief Obtains usage and fragmentation figures.
+ *
+ * @param allocator A pointer to the allocator.
+ * @param outStats A pointer to hold the stats.
+ */
+ENGINE_API void buddyAllocatorGetStats(BuddyAllocator *allocator, BuddyAllocatorStats *outStats);
+
+#endif
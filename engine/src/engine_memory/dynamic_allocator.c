@@ -0,0 +1,155 @@
+#include "dynamic_allocator.h"
+
+#include "engine_memory.h"
+#include "freelist.h"
+#include "../core/logger.h"
+
+typedef struct DynamicAllocatorState {
+    u64 totalSize;
+    Freelist list;
+    void *freelistBlock;
+    void *memoryBlock;
+} DynamicAllocatorState;
+
+static u64 roundToGranularity(u64 size) {
+    return (size + DYNAMIC_ALLOCATOR_GRANULARITY - 1) & ~((u64)DYNAMIC_ALLOCATOR_GRANULARITY - 1);
+}
+
+b8 dynamicAllocatorCreate(u64 totalSize, u64 *memoryRequirement, void *memory,
+    DynamicAllocator *outAllocator) {
+
+    if (totalSize < 1) {
+        ENGINE_ERROR("dynamicAllocatorCreate cannot have a totalSize of 0. Create failed.")
+        return false;
+    }
+
+    if (!memoryRequirement) {
+        ENGINE_ERROR("dynamicAllocatorCreate requires memoryRequirement to exist. Create failed.")
+        return false;
+    }
+
+    totalSize = roundToGranularity(totalSize);
+
+    /**
+     * State, then freelist bookkeeping, then the managed block itself, moved
+     * up to the next granule so every block keeps the granule alignment.
+     */
+    u64 stateRequirement = roundToGranularity(sizeof(DynamicAllocatorState));
+    u64 freelistRequirement = 0;
+    freelistCreate(totalSize, 0, &freelistRequirement, 0, 0);
+    freelistRequirement = roundToGranularity(freelistRequirement);
+
+    *memoryRequirement = stateRequirement + freelistRequirement + DYNAMIC_ALLOCATOR_GRANULARITY + totalSize;
+
+    if (!memory) {
+        return true;
+    }
+
+    if (!outAllocator) {
+        ENGINE_ERROR("dynamicAllocatorCreate requires outAllocator to exist. Create failed.")
+        return false;
+    }
+
+    outAllocator->memory = memory;
+    DynamicAllocatorState *state = outAllocator->memory;
+    state->totalSize = totalSize;
+    state->freelistBlock = (u8*)memory + stateRequirement;
+    state->memoryBlock = (void*)roundToGranularity((u64)state->freelistBlock + freelistRequirement);
+
+    freelistCreate(totalSize, state->memoryBlock, &freelistRequirement, state->freelistBlock, &state->list);
+
+    return true;
+}
+
+b8 dynamicAllocatorDestroy(DynamicAllocator *allocator) {
+    if (allocator && allocator->memory) {
+        DynamicAllocatorState *state = allocator->memory;
+        freelistDestroy(&state->list);
+        state->totalSize = 0;
+        allocator->memory = 0;
+
+        return true;
+    }
+
+    ENGINE_WARNING("dynamicAllocatorDestroy requires a pointer to an allocator. Destroy failed.")
+    return false;
+}
+
+void *dynamicAllocatorAllocate(DynamicAllocator *allocator, u64 size) {
+    if (allocator && allocator->memory && size) {
+        DynamicAllocatorState *state = allocator->memory;
+        u64 offset = 0;
+
+        if (freelistAllocateBlock(&state->list, roundToGranularity(size), &offset)) {
+            return (u8*)state->memoryBlock + offset;
+        }
+
+        return 0;
+    }
+
+    ENGINE_ERROR("dynamicAllocatorAllocate requires a valid allocator and size.")
+    return 0;
+}
+
+b8 dynamicAllocatorFree(DynamicAllocator *allocator, void *block, u64 size) {
+    if (!allocator || !allocator->memory || !block || !size) {
+        ENGINE_ERROR("dynamicAllocatorFree requires both a valid allocator and a block to be freed.")
+        return false;
+    }
+
+    if (!dynamicAllocatorOwns(allocator, block)) {
+        ENGINE_ERROR("dynamicAllocatorFree - trying to release block (%p) outside of allocator range.",
+            block)
+        return false;
+    }
+
+    DynamicAllocatorState *state = allocator->memory;
+    u64 offset = (u64)((u8*)block - (u8*)state->memoryBlock);
+    if (!freelistFreeBlock(&state->list, roundToGranularity(size), offset)) {
+        ENGINE_ERROR("dynamicAllocatorFree failed.")
+        return false;
+    }
+
+    return true;
+}
+
+b8 dynamicAllocatorOwns(DynamicAllocator *allocator, const void *block) {
+    if (!allocator || !allocator->memory || !block) {
+        return false;
+    }
+
+    DynamicAllocatorState *state = allocator->memory;
+    const u8 *begin = state->memoryBlock;
+
+    return (const u8*)block >= begin && (const u8*)block < begin + state->totalSize;
+}
+
+u64 dynamicAllocatorFreeSpace(DynamicAllocator *allocator) {
+    if (!allocator || !allocator->memory) {
+        return 0;
+    }
+
+    DynamicAllocatorState *state = allocator->memory;
+    return freelistFreeSpace(&state->list);
+}
+
+void dynamicAllocatorGetStats(DynamicAllocator *allocator, DynamicAllocatorStats *outStats) {
+    if (!outStats) {
+        return;
+    }
+
+    engineZeroMemory(outStats, sizeof(DynamicAllocatorStats));
+    if (!allocator || !allocator->memory) {
+        return;
+    }
+
+    DynamicAllocatorState *state = allocator->memory;
+    outStats->totalSize = state->totalSize;
+    outStats->freeSpace = freelistFreeSpace(&state->list);
+    outStats->largestFreeBlock = freelistLargestFreeBlock(&state->list);
+    outStats->freeBlockCount = freelistFreeBlockCount(&state->list);
+
+    if (outStats->freeSpace) {
+        outStats->fragmentation = 1.0f - ((f32)outStats->largestFreeBlock / (f32)outStats->freeSpace);
+    }
+}
@@ -0,0 +1,85 @@
+#ifndef __ENGINE_DYNAMIC_ALLOCATOR_H__
+#define __ENGINE_DYNAMIC_ALLOCATOR_H__
+
+#include "../defines.h"
+
+/**
+ * @brief A general-purpose allocator over one fixed block of memory. Free
+ * space is tracked with a freelist, so blocks may be freed in any order
+ * and neighbouring free ranges are coalesced.
+ */
+typedef struct DynamicAllocator {
+    /** Internal state, freelist and managed block. */
+    void *memory;
+} DynamicAllocator;
+
+/** @brief A snapshot of how a dynamic allocator's block is being used. */
+typedef struct DynamicAllocatorStats {
+    u64 totalSize;
+    u64 freeSpace;
+    u64 largestFreeBlock;
+    u64 freeBlockCount;
+
+    /** 0.0 when all free space is contiguous, approaching 1.0 as it scatters. */
+    f32 fragmentation;
+} DynamicAllocatorStats;
+
+/**
+ * @brief Creates a new dynamic allocator or obtains the memory requirement for one.
+ * Call twice; once passing 0 to memory to obtain the memory requirement,
+ * and a second time passing an allocated block to memory.
+ *
+ * @param totalSize The total size in bytes the allocator should be able to hand out.
+ * @param memoryRequirement A pointer to hold the memory requirement, block included.
+ * @param memory 0, or a pre-allocated block of memory for the allocator to use.
+ * @param outAllocator A pointer to hold the allocator.
+ * @return True on success; otherwise false.
+ */
+ENGINE_API b8 dynamicAllocatorCreate(u64 totalSize, u64 *memoryRequirement, void *memory,
+    DynamicAllocator *outAllocator);
+
+/**
+ * @brief Destroys the given allocator. Does not release the memory passed to
+ * dynamicAllocatorCreate.
+ *
+ * @param allocator A pointer to the allocator to be destroyed.
+ * @return True on success; otherwise false.
+ */
+ENGINE_API b8 dynamicAllocatorDestroy(DynamicAllocator *allocator);
+
+/**
+ * @brief Allocates the given amount of memory from the provided allocator.
+ * Sizes are rounded up to DYNAMIC_ALLOCATOR_GRANULARITY, so every block
+ * starts on a 32-byte boundary.
+ *
+ * @param allocator A pointer to the allocator to allocate from.
+ * @param size The amount in bytes to be allocated.
+ * @return The allocated block of memory, or 0. Running out of space is not
+ * logged; callers decide whether it is an error.
+ */
+ENGINE_API void *dynamicAllocatorAllocate(DynamicAllocator *allocator, u64 size);
+
+/**
+ * @brief Frees the given block of memory.
+ *
+ * @param allocator A pointer to the allocator that owns the block.
+ * @param block The block to be freed. Must have been allocated by this allocator.
+ * @param size The size of the block, as passed to dynamicAllocatorAllocate.
+ * @return True on success; otherwise false.
+ */
+ENGINE_API b8 dynamicAllocatorFree(DynamicAllocator *allocator, void *block, u64 size);
+
+/** @brief Indicates if the given block lies within the allocator's managed block. */
+ENGINE_API b8 dynamicAllocatorOwns(DynamicAllocator *allocator, const void *block);
+
+/** @brief Obtains the amount of free space left in the provided allocator. */
+ENGINE_API u64 dynamicAllocatorFreeSpace(DynamicAllocator *allocator);
+
+/** @brief Fills outStats with usage and fragmentation figures. */
+ENGINE_API void dynamicAllocatorGetStats(DynamicAllocator *allocator,
+    DynamicAllocatorStats *outStats);
+
+/** Matches the freelist's smallest range, which has to hold the range's links. */
+#define DYNAMIC_ALLOCATOR_GRANULARITY 32
+
+#endif
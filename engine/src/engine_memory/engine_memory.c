@@ -1,15 +1,37 @@
 #include "engine_memory.h"
 #include "engine_string.h"
+#include "virtual_arena.h"
 
 #include "../core/logger.h"
+#include "../core/atomic.h"
 #include "../platform/platform.h"
 
 #include <string.h>
 #include <stdio.h>
 
+/**
+ * Only the counters are atomic, and they are updated outside
+ * allocatorMutex. The allocators and the tracker behind them rely on
+ * that mutex instead.
+ */
 struct MemoryStats {
     u64 totalAllocated;
+    u64 peakTotalAllocated;
+
+    /** Running totals of bytes ever allocated and freed. */
+    u64 bytesAllocated;
+    u64 bytesFreed;
+
     u64 taggedAllocations[MEMORY_TAG_MAX_TAGS];
+    u64 taggedPeaks[MEMORY_TAG_MAX_TAGS];
+    u64 taggedAllocationCounts[MEMORY_TAG_MAX_TAGS];
+    u64 taggedFreeCounts[MEMORY_TAG_MAX_TAGS];
+
+    /** Live blocks from engineAllocateAligned. */
+    u64 alignedAllocations;
+
+    /** Padding and headers underneath those blocks, not included in the tagged totals. */
+    u64 alignmentOverhead;
 };
 
 static const char* memoryTagStrings[MEMORY_TAG_MAX_TAGS] = {
@@ -34,56 +56,424 @@ static const char* memoryTagStrings[MEMORY_TAG_MAX_TAGS] = {
 };
 
 typedef struct MemorySystemState {
+    MemorySystemConfig config;
     struct MemoryStats stats;
     u64 allocationCount;
+
+    /** Totals when the current frame began, and what the last complete frame did. */
+    u64 frameNumber;
+    MemoryStatsSnapshot frameStart;
+    MemoryFrameDelta lastFrame;
+
+    u64 allocatorMemoryRequirement;
+    DynamicAllocator allocator;
+    void *allocatorBlock;
+
+    u64 poolMemoryRequirement;
+    PoolAllocator pool;
+    void *poolBlock;
+
+    u64 buddyMemoryRequirement;
+    BuddyAllocator buddy;
+    void *buddyBlock;
+
+    u64 trackerMemoryRequirement;
+    MemoryTracker tracker;
+    void *trackerBlock;
+
+    /**
+     * Held while a block is routed to or from the pool, buddy and dynamic
+     * allocators and while the tracker is touched; none of them are
+     * thread-safe on their own.
+     */
+    PlatformMutex allocatorMutex;
 } MemorySystemState;
 
+/** Callsites listed by each report. */
+#define MEMORY_REPORT_MAX_CALLSITES 32
+
 /** Pointer to system state. */
 static MemorySystemState* statePtr;
 
-void memorySystemInitialize(u64* memoryRequirement, void* state) {
+b8 memorySystemInitialize(u64* memoryRequirement, void* state, MemorySystemConfig config) {
     *memoryRequirement = sizeof(MemorySystemState);
     if (state == 0) {
-        return;
+        return true;
     }
 
     statePtr = state;
+    statePtr->config = config;
     statePtr->allocationCount = 0;
+    statePtr->frameNumber = 0;
+    platformZeroMemory(&statePtr->frameStart, sizeof(statePtr->frameStart));
+    platformZeroMemory(&statePtr->lastFrame, sizeof(statePtr->lastFrame));
+    statePtr->allocatorMemoryRequirement = 0;
+    statePtr->allocatorBlock = 0;
+    statePtr->poolMemoryRequirement = 0;
+    statePtr->poolBlock = 0;
+    statePtr->buddyMemoryRequirement = 0;
+    statePtr->buddyBlock = 0;
+    statePtr->trackerMemoryRequirement = 0;
+    statePtr->trackerBlock = 0;
     platformZeroMemory(&statePtr->stats, sizeof(statePtr->stats));
+    platformZeroMemory(&statePtr->allocator, sizeof(statePtr->allocator));
+    platformZeroMemory(&statePtr->pool, sizeof(statePtr->pool));
+    platformZeroMemory(&statePtr->buddy, sizeof(statePtr->buddy));
+    platformZeroMemory(&statePtr->tracker, sizeof(statePtr->tracker));
+    platformZeroMemory(&statePtr->allocatorMutex, sizeof(statePtr->allocatorMutex));
+
+    if (config.trackAllocations && config.trackingCapacity > 0) {
+        memoryTrackerCreate(config.trackingCapacity, &statePtr->trackerMemoryRequirement, 0, 0);
+        statePtr->trackerBlock = platformAllocate(statePtr->trackerMemoryRequirement, true);
+        if (!statePtr->trackerBlock) {
+            ENGINE_FATAL("Memory system is unable to reserve %lluB for allocation tracking.",
+                statePtr->trackerMemoryRequirement)
+            return false;
+        }
+
+        memoryTrackerCreate(config.trackingCapacity, &statePtr->trackerMemoryRequirement,
+            statePtr->trackerBlock, &statePtr->tracker);
+    }
+
+    if (config.poolBlocksPerClass > 0 && config.pooledTagMask) {
+        poolAllocatorCreate(config.poolBlocksPerClass, &statePtr->poolMemoryRequirement, 0, 0);
+        statePtr->poolBlock = platformAllocate(statePtr->poolMemoryRequirement, true);
+        if (!statePtr->poolBlock) {
+            ENGINE_FATAL("Memory system is unable to reserve %lluB for the pool allocator.",
+                statePtr->poolMemoryRequirement)
+            return false;
+        }
+
+        poolAllocatorCreate(config.poolBlocksPerClass, &statePtr->poolMemoryRequirement,
+            statePtr->poolBlock, &statePtr->pool);
+    }
+
+    if (config.buddyAllocSize > 0 && config.buddyTagMask) {
+        if (!buddyAllocatorCreate(config.buddyAllocSize, config.buddyMinBlockSize,
+            &statePtr->buddyMemoryRequirement, 0, 0)) {
+
+            ENGINE_FATAL("Memory system is unable to set up the buddy allocator.")
+            return false;
+        }
+
+        statePtr->buddyBlock = platformAllocate(statePtr->buddyMemoryRequirement, true);
+        if (!statePtr->buddyBlock) {
+            ENGINE_FATAL("Memory system is unable to reserve %lluB for the buddy allocator.",
+                statePtr->buddyMemoryRequirement)
+            return false;
+        }
+
+        buddyAllocatorCreate(config.buddyAllocSize, config.buddyMinBlockSize,
+            &statePtr->buddyMemoryRequirement, statePtr->buddyBlock, &statePtr->buddy);
+    }
+
+    if (config.totalAllocSize == 0) {
+        return true;
+    }
+
+    /** Reserve the whole block for the dynamic allocator in one go. */
+    dynamicAllocatorCreate(config.totalAllocSize, &statePtr->allocatorMemoryRequirement, 0, 0);
+    void *block = platformAllocate(statePtr->allocatorMemoryRequirement, true);
+    if (!block) {
+        ENGINE_FATAL("Memory system is unable to reserve %lluB for the dynamic allocator.",
+            statePtr->allocatorMemoryRequirement)
+        return false;
+    }
+
+    if (!dynamicAllocatorCreate(config.totalAllocSize, &statePtr->allocatorMemoryRequirement,
+        block, &statePtr->allocator)) {
+
+        ENGINE_FATAL("Memory system is unable to set up the dynamic allocator.")
+        platformFree(block, true);
+        return false;
+    }
+
+    statePtr->allocatorBlock = block;
+    ENGINE_DEBUG("Memory system reserved %lluB for the dynamic allocator.", config.totalAllocSize)
+
+    return true;
+}
+
+/** Logs every callsite that still has live blocks. */
+static void reportLeaks() {
+    u64 liveCount = 0;
+    u64 droppedCount = 0;
+    memoryTrackerGetCounts(&statePtr->tracker, &liveCount, &droppedCount);
+    if (!liveCount) {
+        ENGINE_DEBUG("Memory system: no tracked allocations left at shutdown.")
+        return;
+    }
+
+    MemoryCallsiteStats callsites[MEMORY_REPORT_MAX_CALLSITES];
+    u32 count = memoryTrackerGetTopCallsites(&statePtr->tracker, MEMORY_CALLSITE_SORT_LIVE_BYTES,
+        MEMORY_REPORT_MAX_CALLSITES, callsites);
+
+    ENGINE_WARNING("Memory system: %llu blocks never freed (%llu allocations went untracked):",
+        liveCount, droppedCount)
+    for (u32 i = 0; i < count; ++i) {
+        ENGINE_WARNING("  %s:%u [%s] %llu blocks, %lluB", callsites[i].file, callsites[i].line,
+            memoryTagStrings[callsites[i].tag], callsites[i].liveCount, callsites[i].liveBytes)
+    }
 }
 
 void memorySystemShutdown(void *state) {
+    if (statePtr && statePtr->trackerBlock) {
+        reportLeaks();
+        memoryTrackerDestroy(&statePtr->tracker);
+        platformFree(statePtr->trackerBlock, true);
+        statePtr->trackerBlock = 0;
+    }
+
+    if (statePtr && statePtr->poolBlock) {
+        poolAllocatorDestroy(&statePtr->pool);
+        platformFree(statePtr->poolBlock, true);
+        statePtr->poolBlock = 0;
+    }
+
+    if (statePtr && statePtr->buddyBlock) {
+        buddyAllocatorDestroy(&statePtr->buddy);
+        platformFree(statePtr->buddyBlock, true);
+        statePtr->buddyBlock = 0;
+    }
+
+    if (statePtr && statePtr->allocatorBlock) {
+        dynamicAllocatorDestroy(&statePtr->allocator);
+        platformFree(statePtr->allocatorBlock, true);
+        statePtr->allocatorBlock = 0;
+    }
+
     statePtr = 0;
 }
 
-void* engineAllocate(u64 size, MemoryTag tag) {
+/** Sits immediately before every block returned by engineAllocateAligned. */
+typedef struct AlignedAllocationHeader {
+    void *start;
+    u64 totalSize;
+} AlignedAllocationHeader;
+
+/** Bytes reserved underneath an aligned block of the given size and alignment. */
+static u64 alignedTotalSize(u64 size, u64 alignment) {
+    return size + alignment - 1 + sizeof(AlignedAllocationHeader);
+}
+
+/** Allocator and tracker access goes through these; before the system is up there is nothing to guard. */
+static void lockAllocators() {
+    if (statePtr) {
+        platformMutexLock(&statePtr->allocatorMutex);
+    }
+}
+
+static void unlockAllocators() {
+    if (statePtr) {
+        platformMutexUnlock(&statePtr->allocatorMutex);
+    }
+}
+
+/** Routes a raw block to the pool, buddy allocator, dynamic allocator or platform, in that order. No accounting. */
+static void *allocateBlock(u64 size, MemoryTag tag) {
+    /** Empty requests skip the sub-allocators, which reject them, and get a unique heap block. */
+    if (!size) {
+        return platformAllocate(0, false);
+    }
+
+    void* block = 0;
+    if (statePtr && statePtr->poolBlock && (statePtr->config.pooledTagMask & MEMORY_TAG_BIT(tag))) {
+        block = poolAllocatorAllocate(&statePtr->pool, size);
+    }
+
+    if (!block && statePtr && statePtr->buddyBlock && (statePtr->config.buddyTagMask & MEMORY_TAG_BIT(tag))) {
+        block = buddyAllocatorAllocate(&statePtr->buddy, size);
+    }
+
+    if (!block && statePtr && statePtr->allocatorBlock) {
+        block = dynamicAllocatorAllocate(&statePtr->allocator, size);
+        if (!block) {
+            ENGINE_WARNING("engineAllocate - dynamic allocator exhausted, falling back to the platform heap.")
+        }
+    }
+
+    if (!block) {
+        block = platformAllocate(size, false);
+    }
+
+    return block;
+}
+
+/** Returns a raw block to whichever allocator owns it. No accounting. */
+static void freeBlock(void *block, u64 size) {
+    if (statePtr && poolAllocatorOwns(&statePtr->pool, block)) {
+        poolAllocatorFree(&statePtr->pool, block);
+        return;
+    }
+
+    if (statePtr && buddyAllocatorOwns(&statePtr->buddy, block)) {
+        buddyAllocatorFree(&statePtr->buddy, block, size);
+        return;
+    }
+
+    /** Blocks handed out before the allocator existed, or on fallback, came from the platform. */
+    if (statePtr && dynamicAllocatorOwns(&statePtr->allocator, block)) {
+        if (!dynamicAllocatorFree(&statePtr->allocator, block, size)) {
+            ENGINE_ERROR("engineFree - unable to return block (%p, %lluB) to the dynamic allocator.",
+                block, size)
+        }
+        return;
+    }
+
+    platformFree(block, false);
+}
+
+static void recordAllocation(u64 size, MemoryTag tag) {
+    struct MemoryStats *stats = &statePtr->stats;
+    atomicMax64(&stats->peakTotalAllocated, atomicFetchAdd64(&stats->totalAllocated, size) + size);
+    atomicMax64(&stats->taggedPeaks[tag], atomicFetchAdd64(&stats->taggedAllocations[tag], size) + size);
+    atomicFetchAdd64(&stats->taggedAllocationCounts[tag], 1);
+    atomicFetchAdd64(&stats->bytesAllocated, size);
+    atomicFetchAdd64(&statePtr->allocationCount, 1);
+}
+
+static void recordFree(u64 size, MemoryTag tag) {
+    struct MemoryStats *stats = &statePtr->stats;
+    atomicFetchSub64(&stats->totalAllocated, size);
+    atomicFetchSub64(&stats->taggedAllocations[tag], size);
+    atomicFetchAdd64(&stats->taggedFreeCounts[tag], 1);
+    atomicFetchAdd64(&stats->bytesFreed, size);
+}
+
+static void* allocateTagged(u64 size, MemoryTag tag, b8 zero, const char *file, u32 line) {
     if (tag == MEMORY_TAG_UNKNOWN) {
         ENGINE_WARNING("kallocate called using MEMORY_TAG_UNKNOWN. Re-class this allocation.");
     }
 
-    if (statePtr) {
-        statePtr->stats.totalAllocated += size;
-        statePtr->stats.taggedAllocations[tag] += size;
-        ++(statePtr->allocationCount);
+    lockAllocators();
+    void* block = allocateBlock(size, tag);
+    if (statePtr && statePtr->trackerBlock) {
+        memoryTrackerAdd(&statePtr->tracker, block, size, tag, file, line);
+    }
+    unlockAllocators();
+
+    /** A failed allocation is never freed, so it is not counted either. */
+    if (statePtr && block) {
+        recordAllocation(size, tag);
+    }
+
+    if (zero && block) {
+        platformZeroMemory(block, size);
     }
 
-    // TODO: Memory alignment
-    void* block = platformAllocate(size, false);
-    platformZeroMemory(block, size);
     return block;
 }
 
+void* _engineAllocate(u64 size, MemoryTag tag, const char *file, u32 line) {
+    return allocateTagged(size, tag, true, file, line);
+}
+
+void* _engineAllocateUninitialized(u64 size, MemoryTag tag, const char *file, u32 line) {
+    return allocateTagged(size, tag, false, file, line);
+}
+
 void engineFree(void* block, u64 size, MemoryTag tag) {
     if (tag == MEMORY_TAG_UNKNOWN) {
         ENGINE_WARNING("kfree called using MEMORY_TAG_UNKNOWN. Re-class this allocation.");
     }
 
     if (statePtr) {
-        statePtr->stats.totalAllocated -= size;
-        statePtr->stats.taggedAllocations[tag] -= size;
+        recordFree(size, tag);
     }
 
-    platformFree(block, false);
+    lockAllocators();
+    if (statePtr && statePtr->trackerBlock) {
+        memoryTrackerRemove(&statePtr->tracker, block);
+    }
+
+    freeBlock(block, size);
+    unlockAllocators();
+}
+
+static void* allocateAlignedTagged(u64 size, u64 alignment, MemoryTag tag, b8 zero,
+    const char *file, u32 line) {
+
+    if (alignment == 0 || (alignment & (alignment - 1))) {
+        ENGINE_ERROR("engineAllocateAligned - alignment %llu is not a power of two.", alignment)
+        return 0;
+    }
+
+    if (tag == MEMORY_TAG_UNKNOWN) {
+        ENGINE_WARNING("engineAllocateAligned called using MEMORY_TAG_UNKNOWN. Re-class this allocation.");
+    }
+
+    u64 totalSize = alignedTotalSize(size, alignment);
+    lockAllocators();
+    u8 *start = allocateBlock(totalSize, tag);
+    if (!start) {
+        unlockAllocators();
+        return 0;
+    }
+
+    u64 address = (u64)start + sizeof(AlignedAllocationHeader);
+    u8 *block = (u8*)((address + alignment - 1) & ~(alignment - 1));
+    if (statePtr && statePtr->trackerBlock) {
+        memoryTrackerAdd(&statePtr->tracker, block, size, tag, file, line);
+    }
+    unlockAllocators();
+
+    if (statePtr) {
+        recordAllocation(size, tag);
+        atomicFetchAdd64(&statePtr->stats.alignedAllocations, 1);
+        atomicFetchAdd64(&statePtr->stats.alignmentOverhead, totalSize - size);
+    }
+
+    AlignedAllocationHeader *header = (AlignedAllocationHeader*)(block - sizeof(AlignedAllocationHeader));
+    header->start = start;
+    header->totalSize = totalSize;
+
+    if (zero) {
+        platformZeroMemory(block, size);
+    }
+
+    return block;
+}
+
+void* _engineAllocateAligned(u64 size, u64 alignment, MemoryTag tag, const char *file, u32 line) {
+    return allocateAlignedTagged(size, alignment, tag, true, file, line);
+}
+
+void* _engineAllocateAlignedUninitialized(u64 size, u64 alignment, MemoryTag tag,
+    const char *file, u32 line) {
+
+    return allocateAlignedTagged(size, alignment, tag, false, file, line);
+}
+
+void engineFreeAligned(void* block, u64 size, u64 alignment, MemoryTag tag) {
+    if (!block) {
+        return;
+    }
+
+    if (tag == MEMORY_TAG_UNKNOWN) {
+        ENGINE_WARNING("engineFreeAligned called using MEMORY_TAG_UNKNOWN. Re-class this allocation.");
+    }
+
+    AlignedAllocationHeader *header =
+        (AlignedAllocationHeader*)((u8*)block - sizeof(AlignedAllocationHeader));
+    if (header->totalSize != alignedTotalSize(size, alignment)) {
+        ENGINE_ERROR("engineFreeAligned - size/alignment (%lluB, %llu) do not match the allocation "
+            "at %p.", size, alignment, block)
+        return;
+    }
+
+    if (statePtr) {
+        recordFree(size, tag);
+        atomicFetchSub64(&statePtr->stats.alignedAllocations, 1);
+        atomicFetchSub64(&statePtr->stats.alignmentOverhead, header->totalSize - size);
+    }
+
+    lockAllocators();
+    if (statePtr && statePtr->trackerBlock) {
+        memoryTrackerRemove(&statePtr->tracker, block);
+    }
+
+    freeBlock(header->start, header->totalSize);
+    unlockAllocators();
 }
 
 void* engineZeroMemory(void* block, u64 size) {
@@ -94,46 +484,313 @@ void* engineCopyMemory(void* dest, const void* source, u64 size) {
     return platformCopyMemory(dest, source, size);
 }
 
+void* engineMoveMemory(void* dest, const void* source, u64 size) {
+    return platformMoveMemory(dest, source, size);
+}
+
 void* engineSetMemory(void* dest, i32 value, u64 size) {
     return platformSetMemory(dest, value, size);
 }
 
-char* engineGetMemoryUsageStr() {
+/** Scales bytes to the largest unit it reaches; unit must hold 4 chars. */
+static f32 scaleBytes(u64 bytes, char *unit) {
     const u64 gib = 1024 * 1024 * 1024;
     const u64 mib = 1024 * 1024;
     const u64 kib = 1024;
 
+    unit[1] = 'i';
+    unit[2] = 'B';
+    unit[3] = 0;
+    if (bytes >= gib) {
+        unit[0] = 'G';
+        return bytes / (f32)gib;
+    } else if (bytes >= mib) {
+        unit[0] = 'M';
+        return bytes / (f32)mib;
+    } else if (bytes >= kib) {
+        unit[0] = 'K';
+        return bytes / (f32)kib;
+    }
+
+    unit[0] = 'B';
+    unit[1] = 0;
+    return (f32)bytes;
+}
+
+char* engineGetMemoryUsageStr() {
+    const u64 mib = 1024 * 1024;
+
+    MemoryStatsSnapshot snapshot;
+    engineGetMemoryStats(&snapshot);
+
     char buffer[8000] = "System memory use (tagged):\n";
     u64 offset = strlen(buffer);
     for (u32 i = 0; i < MEMORY_TAG_MAX_TAGS; ++i) {
-        char unit[4] = "XiB";
-        float amount = 1.0f;
-        if (statePtr->stats.taggedAllocations[i] >= gib) {
-            unit[0] = 'G';
-            amount = statePtr->stats.taggedAllocations[i] / (float)gib;
-        } else if (statePtr->stats.taggedAllocations[i] >= mib) {
-            unit[0] = 'M';
-            amount = statePtr->stats.taggedAllocations[i] / (float)mib;
-        } else if (statePtr->stats.taggedAllocations[i] >= kib) {
-            unit[0] = 'K';
-            amount = statePtr->stats.taggedAllocations[i] / (float)kib;
-        } else {
-            unit[0] = 'B';
-            unit[1] = 0;
-            amount = (float)statePtr->stats.taggedAllocations[i];
-        }
+        char unit[4];
+        char peakUnit[4];
+        f32 amount = scaleBytes(snapshot.tags[i].currentBytes, unit);
+        f32 peak = scaleBytes(snapshot.tags[i].peakBytes, peakUnit);
 
-        i32 length = snprintf(buffer + offset, 8000, "  %s: %.2f%s\n", memoryTagStrings[i], amount, unit);
+        i32 length = snprintf(buffer + offset, 8000 - offset, "  %s: %.2f%s (peak %.2f%s, %llu allocs, %llu frees)\n",
+            memoryTagStrings[i], amount, unit, peak, peakUnit,
+            snapshot.tags[i].allocationCount, snapshot.tags[i].freeCount);
         offset += length;
     }
+
+    char unit[4];
+    f32 peak = scaleBytes(snapshot.peakTotalAllocated, unit);
+    offset += snprintf(buffer + offset, 8000 - offset, "  Peak total: %.2f%s\n", peak, unit);
+
+    offset += snprintf(buffer + offset, 8000 - offset, "  Aligned blocks: %llu (%lluB overhead)\n",
+        atomicLoad64(&statePtr->stats.alignedAllocations), atomicLoad64(&statePtr->stats.alignmentOverhead));
+
+    DynamicAllocatorStats allocatorStats;
+    if (engineGetMemoryAllocatorStats(&allocatorStats)) {
+        offset += snprintf(buffer + offset, 8000 - offset,
+            "Dynamic allocator:\n"
+            "  used         : %.2fMiB / %.2fMiB\n"
+            "  largest free : %.2fMiB\n"
+            "  free ranges  : %llu\n"
+            "  fragmentation: %.2f%%\n",
+            (allocatorStats.totalSize - allocatorStats.freeSpace) / (f32)mib,
+            allocatorStats.totalSize / (f32)mib,
+            allocatorStats.largestFreeBlock / (f32)mib,
+            allocatorStats.freeBlockCount,
+            allocatorStats.fragmentation * 100.0f);
+    }
+
+    PoolAllocatorClassStats poolStats;
+    for (u32 i = 0; i < POOL_ALLOCATOR_CLASS_COUNT && engineGetMemoryPoolStats(i, &poolStats); ++i) {
+        if (i == 0) {
+            offset += snprintf(buffer + offset, 8000 - offset, "Pool allocator:\n");
+        }
+
+        offset += snprintf(buffer + offset, 8000 - offset, "  %4lluB: %llu/%llu, peak %llu, exhausted %llu\n",
+            poolStats.blockSize, poolStats.used, poolStats.capacity, poolStats.peakUsed,
+            poolStats.exhaustedCount);
+    }
+
+    BuddyAllocatorStats buddyStats;
+    if (engineGetMemoryBuddyStats(&buddyStats)) {
+        offset += snprintf(buffer + offset, 8000 - offset,
+            "Buddy allocator:\n"
+            "  used         : %.2fMiB in %llu blocks / %.2fMiB (%.2fMiB requested)\n"
+            "  largest free : %.2fMiB\n"
+            "  fragmentation: %.2f%% internal, %.2f%% external\n"
+            "  free blocks  :",
+            buddyStats.usedSize / (f32)mib, buddyStats.allocationCount, buddyStats.totalSize / (f32)mib,
+            buddyStats.requestedSize / (f32)mib, buddyStats.largestFreeBlock / (f32)mib,
+            buddyStats.internalFragmentation * 100.0f, buddyStats.externalFragmentation * 100.0f);
+
+        for (u32 i = 0; i < buddyStats.orderCount; ++i) {
+            if (buddyStats.freeBlocksPerOrder[i]) {
+                offset += snprintf(buffer + offset, 8000 - offset, " %lluB x%llu",
+                    buddyStats.minBlockSize << i, buddyStats.freeBlocksPerOrder[i]);
+            }
+        }
+        offset += snprintf(buffer + offset, 8000 - offset, "\n");
+    }
+
+    u64 reserved = 0;
+    u64 committed = 0;
+    virtualArenaGetTotals(&reserved, &committed);
+    if (reserved) {
+        offset += snprintf(buffer + offset, 8000 - offset,
+            "Virtual arenas:\n"
+            "  committed: %.2fMiB / %.2fMiB reserved\n",
+            committed / (f32)mib, reserved / (f32)mib);
+    }
+
     char* out_string = stringDuplicate(buffer);
     return out_string;
 }
 
 u64 getMemoryAllocationCount() {
     if (statePtr) {
-        return statePtr->allocationCount;
+        return atomicLoad64(&statePtr->allocationCount);
     }
 
     return 0;
 }
+
+void engineGetMemoryStats(MemoryStatsSnapshot *outSnapshot) {
+    if (!outSnapshot) {
+        return;
+    }
+
+    platformZeroMemory(outSnapshot, sizeof(MemoryStatsSnapshot));
+    if (!statePtr) {
+        return;
+    }
+
+    /** Each counter is read atomically, but not all of them at the same instant. */
+    struct MemoryStats *stats = &statePtr->stats;
+    outSnapshot->totalAllocated = atomicLoad64(&stats->totalAllocated);
+    outSnapshot->peakTotalAllocated = atomicLoad64(&stats->peakTotalAllocated);
+    outSnapshot->bytesAllocated = atomicLoad64(&stats->bytesAllocated);
+    outSnapshot->bytesFreed = atomicLoad64(&stats->bytesFreed);
+
+    for (u32 i = 0; i < MEMORY_TAG_MAX_TAGS; ++i) {
+        MemoryTagStats *tag = &outSnapshot->tags[i];
+        tag->currentBytes = atomicLoad64(&stats->taggedAllocations[i]);
+        tag->peakBytes = atomicLoad64(&stats->taggedPeaks[i]);
+        tag->allocationCount = atomicLoad64(&stats->taggedAllocationCounts[i]);
+        tag->freeCount = atomicLoad64(&stats->taggedFreeCounts[i]);
+
+        outSnapshot->allocationCount += tag->allocationCount;
+        outSnapshot->freeCount += tag->freeCount;
+    }
+}
+
+b8 engineGetMemoryFrameDelta(MemoryFrameDelta *outDelta) {
+    if (!outDelta) {
+        return false;
+    }
+
+    if (!statePtr) {
+        platformZeroMemory(outDelta, sizeof(MemoryFrameDelta));
+        return false;
+    }
+
+    *outDelta = statePtr->lastFrame;
+    return true;
+}
+
+b8 engineGetMemoryAllocatorStats(DynamicAllocatorStats *outStats) {
+    if (!outStats) {
+        return false;
+    }
+
+    if (statePtr && statePtr->allocatorBlock) {
+        lockAllocators();
+        dynamicAllocatorGetStats(&statePtr->allocator, outStats);
+        unlockAllocators();
+        return true;
+    }
+
+    platformZeroMemory(outStats, sizeof(DynamicAllocatorStats));
+    return false;
+}
+
+b8 engineGetMemoryPoolStats(u32 classIndex, PoolAllocatorClassStats *outStats) {
+    if (!outStats || !statePtr || !statePtr->poolBlock) {
+        return false;
+    }
+
+    lockAllocators();
+    b8 result = poolAllocatorGetClassStats(&statePtr->pool, classIndex, outStats);
+    unlockAllocators();
+
+    return result;
+}
+
+b8 engineGetMemoryBuddyStats(BuddyAllocatorStats *outStats) {
+    if (!outStats) {
+        return false;
+    }
+
+    if (statePtr && statePtr->buddyBlock) {
+        lockAllocators();
+        buddyAllocatorGetStats(&statePtr->buddy, outStats);
+        unlockAllocators();
+        return true;
+    }
+
+    platformZeroMemory(outStats, sizeof(BuddyAllocatorStats));
+    return false;
+}
+
+b8 memorySystemBeginFrame() {
+    if (!statePtr) {
+        return true;
+    }
+
+    if (statePtr->trackerBlock) {
+        lockAllocators();
+        memoryTrackerBeginFrame(&statePtr->tracker);
+        unlockAllocators();
+    }
+
+    MemoryStatsSnapshot now;
+    engineGetMemoryStats(&now);
+
+    MemoryStatsSnapshot *start = &statePtr->frameStart;
+    MemoryFrameDelta *delta = &statePtr->lastFrame;
+    delta->frameNumber = statePtr->frameNumber++;
+    delta->allocationCount = now.allocationCount - start->allocationCount;
+    delta->freeCount = now.freeCount - start->freeCount;
+    delta->bytesAllocated = now.bytesAllocated - start->bytesAllocated;
+    delta->bytesFreed = now.bytesFreed - start->bytesFreed;
+    for (u32 i = 0; i < MEMORY_TAG_MAX_TAGS; ++i) {
+        delta->taggedAllocationCounts[i] = now.tags[i].allocationCount - start->tags[i].allocationCount;
+    }
+
+    delta->overBudget = statePtr->config.frameAllocationBudget > 0 &&
+        delta->allocationCount > statePtr->config.frameAllocationBudget;
+
+    *start = now;
+
+    return !delta->overBudget;
+}
+
+u32 engineGetMemoryCallsites(MemoryCallsiteSort sort, u32 maxCount, MemoryCallsiteStats *outCallsites) {
+    if (!statePtr || !statePtr->trackerBlock) {
+        return 0;
+    }
+
+    lockAllocators();
+    u32 count = memoryTrackerGetTopCallsites(&statePtr->tracker, sort, maxCount, outCallsites);
+    unlockAllocators();
+
+    return count;
+}
+
+void engineReportTopAllocators(u32 maxCount) {
+    if (!statePtr || !statePtr->trackerBlock) {
+        ENGINE_INFO("Allocation tracking is off; set MemorySystemConfig.trackAllocations.")
+        return;
+    }
+
+    MemoryCallsiteStats callsites[MEMORY_REPORT_MAX_CALLSITES];
+    if (maxCount > MEMORY_REPORT_MAX_CALLSITES) {
+        maxCount = MEMORY_REPORT_MAX_CALLSITES;
+    }
+
+    u32 count = engineGetMemoryCallsites(MEMORY_CALLSITE_SORT_LIVE_BYTES, maxCount, callsites);
+    ENGINE_INFO("Top allocators by live bytes:")
+    for (u32 i = 0; i < count; ++i) {
+        ENGINE_INFO("  %s:%u [%s] %lluB in %llu blocks", callsites[i].file, callsites[i].line,
+            memoryTagStrings[callsites[i].tag], callsites[i].liveBytes, callsites[i].liveCount)
+    }
+
+    count = engineGetMemoryCallsites(MEMORY_CALLSITE_SORT_TOTAL_COUNT, maxCount, callsites);
+    ENGINE_INFO("Top allocators by allocation count:")
+    for (u32 i = 0; i < count; ++i) {
+        ENGINE_INFO("  %s:%u [%s] %llu allocations, %lluB", callsites[i].file, callsites[i].line,
+            memoryTagStrings[callsites[i].tag], callsites[i].totalCount, callsites[i].totalBytes)
+    }
+}
+
+void engineReportFrameHotSpots(u32 maxCount) {
+    if (!statePtr || !statePtr->trackerBlock) {
+        ENGINE_INFO("Allocation tracking is off; set MemorySystemConfig.trackAllocations.")
+        return;
+    }
+
+    MemoryCallsiteStats callsites[MEMORY_REPORT_MAX_CALLSITES];
+    if (maxCount > MEMORY_REPORT_MAX_CALLSITES) {
+        maxCount = MEMORY_REPORT_MAX_CALLSITES;
+    }
+
+    u32 count = engineGetMemoryCallsites(MEMORY_CALLSITE_SORT_LAST_FRAME_COUNT, maxCount, callsites);
+    if (!count) {
+        ENGINE_INFO("No allocations last frame.")
+        return;
+    }
+
+    ENGINE_INFO("Allocation hot spots last frame:")
+    for (u32 i = 0; i < count; ++i) {
+        ENGINE_INFO("  %s:%u [%s] %llu allocations, %lluB", callsites[i].file, callsites[i].line,
+            memoryTagStrings[callsites[i].tag], callsites[i].lastFrameCount, callsites[i].lastFrameBytes)
+    }
+}
@@ -2,6 +2,10 @@
 #define __ENGINE_MEMORY_H__
 
 #include "../defines.h"
+#include "dynamic_allocator.h"
+#include "pool_allocator.h"
+#include "buddy_allocator.h"
+#include "memory_tracker.h"
 
 /** For temporary use. Should be assigned one of the below or have a new tag created. */
 typedef enum MemoryTag {
@@ -27,21 +31,230 @@ typedef enum MemoryTag {
     MEMORY_TAG_MAX_TAGS
 } MemoryTag;
 
-ENGINE_API void memorySystemInitialize(u64 *memoryRequirement, void *state);
+/** @brief Usage figures for a single tag. */
+typedef struct MemoryTagStats {
+    u64 currentBytes;
+    u64 peakBytes;
+    u64 allocationCount;
+    u64 freeCount;
+} MemoryTagStats;
+
+/** @brief Point-in-time copy of the memory system's counters. */
+typedef struct MemoryStatsSnapshot {
+    u64 totalAllocated;
+    u64 peakTotalAllocated;
+    u64 allocationCount;
+    u64 freeCount;
+
+    /** Running totals of bytes ever allocated and freed. */
+    u64 bytesAllocated;
+    u64 bytesFreed;
+
+    MemoryTagStats tags[MEMORY_TAG_MAX_TAGS];
+} MemoryStatsSnapshot;
+
+/** @brief What a single frame allocated and freed, between two memorySystemBeginFrame calls. */
+typedef struct MemoryFrameDelta {
+    u64 frameNumber;
+    u64 allocationCount;
+    u64 freeCount;
+    u64 bytesAllocated;
+    u64 bytesFreed;
+    u64 taggedAllocationCounts[MEMORY_TAG_MAX_TAGS];
+
+    /** True if allocationCount went over MemorySystemConfig.frameAllocationBudget. */
+    b8 overBudget;
+} MemoryFrameDelta;
+
+/** Bit for the given tag in MemorySystemConfig.pooledTagMask. */
+#define MEMORY_TAG_BIT(tag) (1u << (tag))
+
+/** @brief Configuration for the memory system. */
+typedef struct MemorySystemConfig {
+    /**
+     * Size in bytes of the block reserved up front for the engine's dynamic
+     * allocator. engineAllocate/engineFree route through it when non-zero;
+     * 0 sends every allocation straight to the platform heap.
+     */
+    u64 totalAllocSize;
+
+    /** Number of blocks in each pool size class. 0 disables the pool. */
+    u64 poolBlocksPerClass;
+
+    /**
+     * Tags, as MEMORY_TAG_BIT()s, whose allocations of up to
+     * POOL_ALLOCATOR_MAX_BLOCK_SIZE bytes are served from the pool.
+     */
+    u32 pooledTagMask;
+
+    /** Size in bytes of the buddy allocator's region. 0 disables it. */
+    u64 buddyAllocSize;
+
+    /** Smallest block the buddy allocator hands out; a power of two. */
+    u64 buddyMinBlockSize;
+
+    /**
+     * Tags, as MEMORY_TAG_BIT()s, served by the buddy allocator. The pool is
+     * tried first for tags in both masks.
+     */
+    u32 buddyTagMask;
+
+    /**
+     * Records every live allocation against the __FILE__/__LINE__ that made it,
+     * for the callsite reports and the leak report at shutdown. Costs a hash
+     * insert and remove per allocation.
+     */
+    b8 trackAllocations;
+
+    /** Most live allocations tracked at once when trackAllocations is set. */
+    u64 trackingCapacity;
+
+    /** Allocations a single frame may make before it is flagged. 0 disables the check. */
+    u64 frameAllocationBudget;
+} MemorySystemConfig;
+
+/**
+ * @brief Initializes the memory system. Call twice; once with state = 0 to get
+ * the required memory size, then a second time passing allocated memory to state.
+ * The dynamic allocator's block is reserved from the platform separately.
+ *
+ * @param memoryRequirement A pointer to hold the required memory size of internal state.
+ * @param state 0 if just requesting memory requirement, otherwise allocated block of memory.
+ * @param config The memory system configuration.
+ * @return True on success; otherwise false.
+ */
+ENGINE_API b8 memorySystemInitialize(u64 *memoryRequirement, void *state, MemorySystemConfig config);
+
+/** @brief Shuts the memory system down, logging any tracked allocations that were never freed. */
 ENGINE_API void memorySystemShutdown(void *state);
 
-ENGINE_API void* engineAllocate(u64 size, MemoryTag tag);
+/**
+ * @brief Marks a frame boundary: closes the per-frame counters of the frame
+ * that just ended and starts new ones. Called by the application once per frame.
+ *
+ * @return False if the frame that just ended went over MemorySystemConfig.frameAllocationBudget.
+ */
+ENGINE_API b8 memorySystemBeginFrame();
+
+/**
+ * The allocation functions take the caller's __FILE__/__LINE__ for allocation
+ * tracking; call them through the macros below rather than directly.
+ */
+ENGINE_API void* _engineAllocate(u64 size, MemoryTag tag, const char *file, u32 line);
+ENGINE_API void* _engineAllocateUninitialized(u64 size, MemoryTag tag, const char *file, u32 line);
+ENGINE_API void* _engineAllocateAligned(u64 size, u64 alignment, MemoryTag tag, const char *file, u32 line);
+ENGINE_API void* _engineAllocateAlignedUninitialized(u64 size, u64 alignment, MemoryTag tag,
+    const char *file, u32 line);
+
+/** @brief Allocates a zeroed block of size bytes, accounted under tag. Free with engineFree. */
+#define engineAllocate(size, tag) \
+    _engineAllocate(size, tag, __FILE__, __LINE__)
+
+/**
+ * @brief Same as engineAllocate, but the contents of the block are left as they
+ * are. For buffers that are about to be overwritten in full (file contents,
+ * pixel and vertex data, arrays filled by an API call). Free with engineFree.
+ */
+#define engineAllocateUninitialized(size, tag) \
+    _engineAllocateUninitialized(size, tag, __FILE__, __LINE__)
 
 ENGINE_API void engineFree(void* block, u64 size, MemoryTag tag);
 
+/**
+ * @brief Allocates a zeroed block whose address is a multiple of alignment.
+ * Must be released with engineFreeAligned, passing the same size and alignment.
+ * alignment must be a power of two (16, 32, 64...). Evaluates to 0 on failure.
+ */
+#define engineAllocateAligned(size, alignment, tag) \
+    _engineAllocateAligned(size, alignment, tag, __FILE__, __LINE__)
+
+/**
+ * @brief Same as engineAllocateAligned, but the contents of the block are left
+ * as they are. Free with engineFreeAligned.
+ */
+#define engineAllocateAlignedUninitialized(size, alignment, tag) \
+    _engineAllocateAlignedUninitialized(size, alignment, tag, __FILE__, __LINE__)
+
+/**
+ * @brief Frees a block obtained from engineAllocateAligned.
+ *
+ * @param block The block to be freed.
+ * @param size The size passed to engineAllocateAligned.
+ * @param alignment The alignment passed to engineAllocateAligned.
+ * @param tag The tag passed to engineAllocateAligned.
+ */
+ENGINE_API void engineFreeAligned(void* block, u64 size, u64 alignment, MemoryTag tag);
+
 ENGINE_API void* engineZeroMemory(void* block, u64 size);
 
 ENGINE_API void* engineCopyMemory(void* dest, const void* source, u64 size);
 
+/** @brief Like engineCopyMemory, but dest and source may overlap. */
+ENGINE_API void* engineMoveMemory(void* dest, const void* source, u64 size);
+
 ENGINE_API void* engineSetMemory(void* dest, i32 value, u64 size);
 
 ENGINE_API char* engineGetMemoryUsageStr();
 
 ENGINE_API u64 getMemoryAllocationCount();
 
+/**
+ * @brief Obtains current and peak usage per tag, plus allocation and free
+ * counts. Safe to call from any thread.
+ *
+ * @param outSnapshot A pointer to hold the counters.
+ */
+ENGINE_API void engineGetMemoryStats(MemoryStatsSnapshot *outSnapshot);
+
+/**
+ * @brief Obtains what the last complete frame allocated and freed.
+ *
+ * @param outDelta A pointer to hold the figures.
+ * @return True if the memory system is running; otherwise false and outDelta is zeroed.
+ */
+ENGINE_API b8 engineGetMemoryFrameDelta(MemoryFrameDelta *outDelta);
+
+/**
+ * @brief Obtains usage and fragmentation figures for the engine's dynamic allocator.
+ *
+ * @param outStats A pointer to hold the stats.
+ * @return True if the dynamic allocator is active; otherwise false and outStats is zeroed.
+ */
+ENGINE_API b8 engineGetMemoryAllocatorStats(DynamicAllocatorStats *outStats);
+
+/**
+ * @brief Obtains occupancy counters for one of the pool's size classes.
+ *
+ * @param classIndex The size class, 0 to POOL_ALLOCATOR_CLASS_COUNT - 1.
+ * @param outStats A pointer to hold the counters.
+ * @return True if the pool is active and classIndex is valid; otherwise false.
+ */
+ENGINE_API b8 engineGetMemoryPoolStats(u32 classIndex, PoolAllocatorClassStats *outStats);
+
+/**
+ * @brief Obtains usage and fragmentation figures for the buddy allocator.
+ *
+ * @param outStats A pointer to hold the stats.
+ * @return True if the buddy allocator is active; otherwise false and outStats is zeroed.
+ */
+ENGINE_API b8 engineGetMemoryBuddyStats(BuddyAllocatorStats *outStats);
+
+/**
+ * @brief Copies out the allocation callsites that rank highest by the given
+ * measure. Requires MemorySystemConfig.trackAllocations.
+ *
+ * @param sort What to rank callsites by.
+ * @param maxCount The capacity of outCallsites.
+ * @param outCallsites An array to hold up to maxCount callsites, highest first.
+ * @return The number of callsites written; 0 when tracking is off.
+ */
+ENGINE_API u32 engineGetMemoryCallsites(MemoryCallsiteSort sort, u32 maxCount,
+    MemoryCallsiteStats *outCallsites);
+
+/** @brief Logs the maxCount callsites holding the most live bytes, and those that allocated most often. */
+ENGINE_API void engineReportTopAllocators(u32 maxCount);
+
+/** @brief Logs the maxCount callsites that allocated most often during the last frame. */
+ENGINE_API void engineReportFrameHotSpots(u32 maxCount);
+
 #endif
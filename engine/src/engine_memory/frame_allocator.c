@@ -0,0 +1,111 @@
+#include "frame_allocator.h"
+
+#include "linear_allocator.h"
+#include "engine_memory.h"
+#include "../core/logger.h"
+
+typedef struct FrameAllocatorState {
+    FrameAllocatorConfig config;
+    LinearAllocator arenas[FRAME_ALLOCATOR_ARENA_COUNT];
+    u32 currentArena;
+    u64 frameNumber;
+    u64 highWaterMark;
+    u64 failedAllocations;
+} FrameAllocatorState;
+
+static FrameAllocatorState *statePtr;
+
+b8 frameAllocatorSystemInitialize(u64 *memoryRequirement, void *state, FrameAllocatorConfig config) {
+    if (config.arenaSize == 0) {
+        ENGINE_FATAL("frameAllocatorSystemInitialize - config.arenaSize must be > 0.")
+        return false;
+    }
+
+    /** Block of memory will contain state structure, then the arenas back to back. */
+    u64 structRequirement = (sizeof(FrameAllocatorState) + 63) & ~63ULL;
+    u64 arenaRequirement = (config.arenaSize + 63) & ~63ULL;
+    *memoryRequirement = structRequirement + (arenaRequirement * FRAME_ALLOCATOR_ARENA_COUNT);
+
+    if (!state) {
+        return true;
+    }
+
+    statePtr = state;
+    engineZeroMemory(statePtr, sizeof(FrameAllocatorState));
+    statePtr->config = config;
+
+    u8 *arenaBlock = (u8*)state + structRequirement;
+    for (u32 i = 0; i < FRAME_ALLOCATOR_ARENA_COUNT; ++i) {
+        linearAllocatorCreate(config.arenaSize, arenaBlock + (arenaRequirement * i),
+            &statePtr->arenas[i]);
+    }
+
+    return true;
+}
+
+void frameAllocatorSystemShutdown(void *state) {
+    if (statePtr) {
+        ENGINE_DEBUG("Frame allocator high-water mark: %lluB of %lluB per frame, %llu failed allocations.",
+            statePtr->highWaterMark, statePtr->config.arenaSize, statePtr->failedAllocations)
+
+        for (u32 i = 0; i < FRAME_ALLOCATOR_ARENA_COUNT; ++i) {
+            linearAllocatorDestroy(&statePtr->arenas[i]);
+        }
+    }
+
+    statePtr = 0;
+}
+
+void frameAllocatorBeginFrame() {
+    if (!statePtr) {
+        return;
+    }
+
+    LinearAllocator *previous = &statePtr->arenas[statePtr->currentArena];
+    if (previous->allocated > statePtr->highWaterMark) {
+        statePtr->highWaterMark = previous->allocated;
+    }
+
+    statePtr->frameNumber++;
+    statePtr->currentArena = statePtr->frameNumber % FRAME_ALLOCATOR_ARENA_COUNT;
+
+    /**
+     * The arena being reset was last used FRAME_ALLOCATOR_ARENA_COUNT frames ago.
+     * Frame memory is handed out uninitialized, so it is not cleared.
+     */
+    linearAllocatorFreeAll(&statePtr->arenas[statePtr->currentArena], false);
+}
+
+void *frameAllocate(u64 size, u64 alignment) {
+    if (!statePtr) {
+        ENGINE_ERROR("frameAllocate called before the frame allocator was initialized.")
+        return 0;
+    }
+
+    LinearAllocator *arena = &statePtr->arenas[statePtr->currentArena];
+    void *block = linearAllocatorAllocateAligned(arena, size, alignment > 1 ? alignment : 1);
+    if (!block) {
+        statePtr->failedAllocations++;
+    }
+
+    return block;
+}
+
+void frameAllocatorGetStats(FrameAllocatorStats *outStats) {
+    if (!outStats) {
+        return;
+    }
+
+    engineZeroMemory(outStats, sizeof(FrameAllocatorStats));
+    if (!statePtr) {
+        return;
+    }
+
+    LinearAllocator *arena = &statePtr->arenas[statePtr->currentArena];
+    outStats->arenaSize = statePtr->config.arenaSize;
+    outStats->currentUsed = arena->allocated;
+    outStats->highWaterMark = statePtr->highWaterMark > arena->allocated ?
+        statePtr->highWaterMark : arena->allocated;
+    outStats->failedAllocations = statePtr->failedAllocations;
+    outStats->frameNumber = statePtr->frameNumber;
+}
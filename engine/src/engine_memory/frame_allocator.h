@@ -0,0 +1,66 @@
+#ifndef __ENGINE_FRAME_ALLOCATOR_H__
+#define __ENGINE_FRAME_ALLOCATOR_H__
+
+#include "../defines.h"
+
+/** Number of arenas cycled through; data from the previous frame stays valid. */
+#define FRAME_ALLOCATOR_ARENA_COUNT 2
+
+typedef struct FrameAllocatorConfig {
+    /** Size in bytes of each of the FRAME_ALLOCATOR_ARENA_COUNT arenas. */
+    u64 arenaSize;
+} FrameAllocatorConfig;
+
+typedef struct FrameAllocatorStats {
+    u64 arenaSize;
+
+    /** Bytes used so far by the current frame. */
+    u64 currentUsed;
+
+    /** The most bytes any single frame has used. Size arenaSize from this. */
+    u64 highWaterMark;
+
+    /** Number of frameAllocate calls that did not fit. */
+    u64 failedAllocations;
+
+    u64 frameNumber;
+} FrameAllocatorStats;
+
+/**
+ * @brief Initializes the frame allocator. Call twice; once with state = 0 to get
+ * required memory size, then a second time passing allocated memory to state.
+ * The arenas live in the same block as the state.
+ *
+ * @param memoryRequirement A pointer to hold the required memory size, arenas included.
+ * @param state 0 if just requesting memory requirement, otherwise allocated block of memory.
+ * @param config The frame allocator configuration.
+ * @return True on success; otherwise false.
+ */
+b8 frameAllocatorSystemInitialize(u64 *memoryRequirement, void *state, FrameAllocatorConfig config);
+void frameAllocatorSystemShutdown(void *state);
+
+/**
+ * @brief Switches to the next arena and resets it. Called by the application
+ * once per frame before anything is updated, so blocks handed out during
+ * frame N stay valid until frame N + FRAME_ALLOCATOR_ARENA_COUNT begins.
+ */
+void frameAllocatorBeginFrame();
+
+/**
+ * @brief Allocates transient memory that lives until the frame after next begins.
+ * The contents are uninitialized. Never free blocks obtained from here.
+ *
+ * @param size The size of the allocation in bytes.
+ * @param alignment The required alignment. Must be a power of two; 0 or 1 for none.
+ * @return The block, or 0 if the arena is exhausted.
+ */
+ENGINE_API void *frameAllocate(u64 size, u64 alignment);
+
+/**
+ * @brief Obtains usage figures for the frame allocator.
+ *
+ * @param outStats A pointer to hold the stats.
+ */
+ENGINE_API void frameAllocatorGetStats(FrameAllocatorStats *outStats);
+
+#endif
@@ -0,0 +1,313 @@
+#include "freelist.h"
+
+#include "engine_memory.h"
+#include "../core/logger.h"
+#include "../containers/bitset.h"
+
+/** One bin per power of two of granules. */
+#define FREELIST_BIN_COUNT 64
+
+/** Ranges of its own size class checked before settling for a larger class. */
+#define FREELIST_BIN_SEARCH_LIMIT 8
+
+/**
+ * Written at the start of every free range. The range's size is repeated in
+ * its last 8 bytes, so the range after it can find where it starts; 32 bytes
+ * holds both.
+ */
+typedef struct FreelistRange {
+    u64 size;
+    struct FreelistRange *prev;
+    struct FreelistRange *next;
+} FreelistRange;
+
+typedef struct FreelistState {
+    u64 totalSize;
+    u8 *block;
+
+    u64 freeSpace;
+    u64 rangeCount;
+
+    /** Bit n is set while bins[n] holds any range. */
+    u64 binMask;
+    FreelistRange *bins[FREELIST_BIN_COUNT];
+
+    /** One bit per granule of the block, set while the granule is free. */
+    u64 *freeGranules;
+} FreelistState;
+
+static u64 roundToMinBlock(u64 size) {
+    return (size + FREELIST_MIN_BLOCK_SIZE - 1) & ~((u64)FREELIST_MIN_BLOCK_SIZE - 1);
+}
+
+static u64 granuleWordCount(u64 totalSize) {
+    return ((totalSize / FREELIST_MIN_BLOCK_SIZE) + 63) / 64;
+}
+
+/** Bin for a range of the given size: floor(log2(granules)). */
+static u32 binIndex(u64 size) {
+    u64 granules = size / FREELIST_MIN_BLOCK_SIZE;
+    u32 bin = 0;
+    while (granules >>= 1) {
+        ++bin;
+    }
+
+    return bin;
+}
+
+static b8 granuleFree(FreelistState *state, u64 granule) {
+    return (state->freeGranules[granule / 64] >> (granule % 64)) & 1;
+}
+
+/** Sets or clears the bits for [offset, offset + size), a whole word at a time where possible. */
+static void markGranules(FreelistState *state, u64 offset, u64 size, b8 free) {
+    u64 first = offset / FREELIST_MIN_BLOCK_SIZE;
+    u64 end = first + (size / FREELIST_MIN_BLOCK_SIZE);
+    while (first < end) {
+        u64 bit = first % 64;
+        u64 count = end - first < 64 - bit ? end - first : 64 - bit;
+        u64 mask = (count == 64 ? ~0ULL : ((1ULL << count) - 1)) << bit;
+        if (free) {
+            state->freeGranules[first / 64] |= mask;
+        } else {
+            state->freeGranules[first / 64] &= ~mask;
+        }
+
+        first += count;
+    }
+}
+
+static b8 anyGranuleFree(FreelistState *state, u64 offset, u64 size) {
+    u64 first = offset / FREELIST_MIN_BLOCK_SIZE;
+    u64 end = first + (size / FREELIST_MIN_BLOCK_SIZE);
+    while (first < end) {
+        u64 bit = first % 64;
+        u64 count = end - first < 64 - bit ? end - first : 64 - bit;
+        u64 mask = (count == 64 ? ~0ULL : ((1ULL << count) - 1)) << bit;
+        if (state->freeGranules[first / 64] & mask) {
+            return true;
+        }
+
+        first += count;
+    }
+
+    return false;
+}
+
+static void insertRange(FreelistState *state, u64 offset, u64 size) {
+    FreelistRange *range = (FreelistRange*)(state->block + offset);
+    *(u64*)(state->block + offset + size - sizeof(u64)) = size;
+    range->size = size;
+
+    u32 bin = binIndex(size);
+    range->prev = 0;
+    range->next = state->bins[bin];
+    if (range->next) {
+        range->next->prev = range;
+    }
+
+    state->bins[bin] = range;
+    state->binMask |= 1ULL << bin;
+    state->rangeCount++;
+}
+
+static void removeRange(FreelistState *state, FreelistRange *range) {
+    u32 bin = binIndex(range->size);
+    if (range->prev) {
+        range->prev->next = range->next;
+    } else {
+        state->bins[bin] = range->next;
+    }
+
+    if (range->next) {
+        range->next->prev = range->prev;
+    }
+
+    if (!state->bins[bin]) {
+        state->binMask &= ~(1ULL << bin);
+    }
+
+    state->rangeCount--;
+}
+
+/** Looks through at most limit ranges of the bin (all of them for limit 0) for one of at least size. */
+static FreelistRange *searchBin(FreelistState *state, u32 bin, u64 size, u32 limit) {
+    u32 checked = 0;
+    for (FreelistRange *range = state->bins[bin]; range; range = range->next) {
+        if (range->size >= size) {
+            return range;
+        }
+
+        if (limit && ++checked == limit) {
+            break;
+        }
+    }
+
+    return 0;
+}
+
+void freelistCreate(u64 totalSize, void *block, u64 *memoryRequirement, void *memory, Freelist *outList) {
+    totalSize &= ~((u64)FREELIST_MIN_BLOCK_SIZE - 1);
+    *memoryRequirement = sizeof(FreelistState) + (sizeof(u64) * granuleWordCount(totalSize));
+    if (!memory) {
+        return;
+    }
+
+    engineZeroMemory(memory, *memoryRequirement);
+    outList->memory = memory;
+
+    FreelistState *state = outList->memory;
+    state->freeGranules = (u64*)((u8*)memory + sizeof(FreelistState));
+    state->totalSize = totalSize;
+    state->block = block;
+
+    freelistClear(outList);
+}
+
+void freelistDestroy(Freelist *list) {
+    if (list && list->memory) {
+        FreelistState *state = list->memory;
+        engineZeroMemory(list->memory,
+            sizeof(FreelistState) + (sizeof(u64) * granuleWordCount(state->totalSize)));
+        list->memory = 0;
+    }
+}
+
+b8 freelistAllocateBlock(Freelist *list, u64 size, u64 *outOffset) {
+    if (!list || !outOffset || !list->memory || !size) {
+        return false;
+    }
+
+    FreelistState *state = list->memory;
+    size = roundToMinBlock(size);
+    u32 bin = binIndex(size);
+
+    /** Any range in a larger class fits; its own class may only hold ranges that are too small. */
+    FreelistRange *range = searchBin(state, bin, size, FREELIST_BIN_SEARCH_LIMIT);
+    u64 largerBins = bin + 1 < FREELIST_BIN_COUNT ? state->binMask & ~((2ULL << bin) - 1) : 0;
+    if (!range && largerBins) {
+        range = state->bins[bitCountTrailingZeros64(largerBins)];
+    }
+
+    if (!range) {
+        range = searchBin(state, bin, size, 0);
+    }
+
+    /** Running out is left to the caller to report; the engine heap expects it and falls back. */
+    if (!range) {
+        return false;
+    }
+
+    /** Carve the block off the front of the range and put back what is left. */
+    u64 offset = (u64)((u8*)range - state->block);
+    u64 rangeSize = range->size;
+    removeRange(state, range);
+    if (rangeSize > size) {
+        insertRange(state, offset + size, rangeSize - size);
+    }
+
+    markGranules(state, offset, size, false);
+    state->freeSpace -= size;
+    *outOffset = offset;
+
+    return true;
+}
+
+b8 freelistFreeBlock(Freelist *list, u64 size, u64 offset) {
+    if (!list || !list->memory || !size) {
+        return false;
+    }
+
+    FreelistState *state = list->memory;
+    size = roundToMinBlock(size);
+    if ((offset % FREELIST_MIN_BLOCK_SIZE) || offset + size > state->totalSize) {
+        ENGINE_ERROR("freelistFreeBlock - block (offset: %llu, size: %llu) is not a block of the list.",
+            offset, size)
+        return false;
+    }
+
+    if (anyGranuleFree(state, offset, size)) {
+        ENGINE_ERROR("freelistFreeBlock - block (offset: %llu, size: %llu) overlaps a free range. "
+            "Possible double free.", offset, size)
+        return false;
+    }
+
+    markGranules(state, offset, size, true);
+    state->freeSpace += size;
+
+    /** Merge with the free range ending right before the block, found through its trailing size. */
+    u64 start = offset;
+    u64 end = offset + size;
+    if (start > 0 && granuleFree(state, (start / FREELIST_MIN_BLOCK_SIZE) - 1)) {
+        start -= *(u64*)(state->block + start - sizeof(u64));
+        removeRange(state, (FreelistRange*)(state->block + start));
+    }
+
+    if (end < state->totalSize && granuleFree(state, end / FREELIST_MIN_BLOCK_SIZE)) {
+        FreelistRange *next = (FreelistRange*)(state->block + end);
+        end += next->size;
+        removeRange(state, next);
+    }
+
+    insertRange(state, start, end - start);
+
+    return true;
+}
+
+void freelistClear(Freelist *list) {
+    if (!list || !list->memory) {
+        return;
+    }
+
+    FreelistState *state = list->memory;
+    state->binMask = 0;
+    state->rangeCount = 0;
+    engineZeroMemory(state->bins, sizeof(state->bins));
+    engineZeroMemory(state->freeGranules, sizeof(u64) * granuleWordCount(state->totalSize));
+
+    state->freeSpace = state->totalSize;
+    if (state->totalSize) {
+        markGranules(state, 0, state->totalSize, true);
+        insertRange(state, 0, state->totalSize);
+    }
+}
+
+u64 freelistFreeSpace(Freelist *list) {
+    if (!list || !list->memory) {
+        return 0;
+    }
+
+    FreelistState *state = list->memory;
+    return state->freeSpace;
+}
+
+u64 freelistLargestFreeBlock(Freelist *list) {
+    if (!list || !list->memory) {
+        return 0;
+    }
+
+    /** Only the highest occupied bin can hold the largest range. */
+    FreelistState *state = list->memory;
+    u64 largest = 0;
+    for (u32 bin = FREELIST_BIN_COUNT; bin > 0; --bin) {
+        if (state->binMask & (1ULL << (bin - 1))) {
+            for (FreelistRange *range = state->bins[bin - 1]; range; range = range->next) {
+                if (range->size > largest) {
+                    largest = range->size;
+                }
+            }
+            break;
+        }
+    }
+
+    return largest;
+}
+
+u64 freelistFreeBlockCount(Freelist *list) {
+    if (!list || !list->memory) {
+        return 0;
+    }
+
+    FreelistState *state = list->memory;
+    return state->rangeCount;
+}
@@ -0,0 +1,87 @@
+#ifndef __ENGINE_FREELIST_H__
+#define __ENGINE_FREELIST_H__
+
+#include "../defines.h"
+
+/** Smallest range the list hands out or tracks; sizes are rounded up to it. */
+#define FREELIST_MIN_BLOCK_SIZE 32
+
+/**
+ * @brief A free list of ranges inside a block of memory. Each free range
+ * keeps its links and size inside itself, so any number of ranges can be
+ * tracked; the list's own memory only holds one bit per 32-byte granule,
+ * marking which are free, so a freed block finds and merges with its free
+ * neighbours in constant time. Free ranges are binned by size, power of two
+ * by power of two, so a fit is found without walking every range.
+ * Members should not be modified outside the functions associated with it.
+ */
+typedef struct Freelist {
+    /** Internal state, free-granule bits included. */
+    void *memory;
+} Freelist;
+
+/**
+ * @brief Creates a new freelist or obtains the memory requirement for one.
+ * Call twice; once passing 0 to memory to obtain the memory requirement,
+ * and a second time passing an allocated block to memory.
+ *
+ * @param totalSize The total size in bytes that the freelist should track.
+ * Rounded down to FREELIST_MIN_BLOCK_SIZE.
+ * @param block The memory being tracked, at least 8-byte aligned. Free ranges
+ * are written into it; only required when memory is passed.
+ * @param memoryRequirement A pointer to hold the memory requirement for the freelist itself.
+ * @param memory 0, or a pre-allocated block of memory for the freelist to use.
+ * @param outList A pointer to hold the created freelist.
+ */
+ENGINE_API void freelistCreate(u64 totalSize, void *block, u64 *memoryRequirement, void *memory,
+    Freelist *outList);
+
+/**
+ * @brief Destroys the provided list. Does not release the memory passed to freelistCreate.
+ *
+ * @param list The list to be destroyed.
+ */
+ENGINE_API void freelistDestroy(Freelist *list);
+
+/**
+ * @brief Attempts to find a free block of memory of the given size. Looks
+ * through a few ranges of the same size class first, then takes the first
+ * range of a larger class, and only then searches its own class in full.
+ *
+ * @param list A pointer to the list to search.
+ * @param size The size to allocate.
+ * @param outOffset A pointer to hold the offset to the allocated memory.
+ * @return True if a block of memory was found and allocated; false, without
+ * logging, if no range is large enough.
+ */
+ENGINE_API b8 freelistAllocateBlock(Freelist *list, u64 size, u64 *outOffset);
+
+/**
+ * @brief Attempts to free a block of memory at the given offset, and of the given size.
+ * Coalesces with neighbouring free ranges where possible. Freeing memory
+ * that is already partly free is reported and ignored.
+ *
+ * @param list A pointer to the list to free from.
+ * @param size The size of the block to be freed.
+ * @param offset The offset of the block to be freed.
+ * @return True if successful; otherwise false. False should be treated as an error.
+ */
+ENGINE_API b8 freelistFreeBlock(Freelist *list, u64 size, u64 offset);
+
+/**
+ * @brief Clears the free list, marking the whole tracked range as free.
+ *
+ * @param list The list to be cleared.
+ */
+ENGINE_API void freelistClear(Freelist *list);
+
+/** @brief Returns the total amount of free space in bytes. */
+ENGINE_API u64 freelistFreeSpace(Freelist *list);
+
+/** @brief Returns the size in bytes of the largest single free range. */
+ENGINE_API u64 freelistLargestFreeBlock(Freelist *list);
+
+/** @brief Returns the number of separate free ranges currently tracked. */
+ENGINE_API u64 freelistFreeBlockCount(Freelist *list);
+
+#endif
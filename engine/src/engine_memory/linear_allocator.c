@@ -7,6 +7,7 @@ void linearAllocatorCreate(u64 totalSize, void* memory, LinearAllocator* outAllo
     if (outAllocator) {
         outAllocator->totalSize = totalSize;
         outAllocator->allocated = 0;
+        outAllocator->dirty = 0;
         outAllocator->ownsMemory = memory == 0;
         if (memory) {
             outAllocator->memory = memory;
@@ -18,6 +19,7 @@ void linearAllocatorCreate(u64 totalSize, void* memory, LinearAllocator* outAllo
 void linearAllocatorDestroy(LinearAllocator* allocator) {
     if (allocator) {
         allocator->allocated = 0;
+        allocator->dirty = 0;
         if (allocator->ownsMemory && allocator->memory) {
             engineFree(allocator->memory, allocator->totalSize, MEMORY_TAG_LINEAR_ALLOCATOR);
         } 
@@ -28,15 +30,30 @@ void linearAllocatorDestroy(LinearAllocator* allocator) {
 }
 
 void* linearAllocatorAllocate(LinearAllocator* allocator, u64 size) {
+    return linearAllocatorAllocateAligned(allocator, size, 1);
+}
+
+void* linearAllocatorAllocateAligned(LinearAllocator* allocator, u64 size, u64 alignment) {
+    if (alignment == 0 || (alignment & (alignment - 1))) {
+        ENGINE_ERROR("linear_allocator_allocate - alignment %llu is not a power of two.", alignment);
+        return 0;
+    }
+
     if (allocator && allocator->memory) {
-        if (allocator->allocated + size > allocator->totalSize) {
+        u64 address = (u64)allocator->memory + allocator->allocated;
+        u64 padding = (alignment - (address & (alignment - 1))) & (alignment - 1);
+
+        if (allocator->allocated + padding + size > allocator->totalSize) {
             u64 remaining = allocator->totalSize - allocator->allocated;
             ENGINE_ERROR("linear_allocator_allocate - Tried to allocate %lluB, only %lluB remaining.", size, remaining);
             return 0;
         }
 
-        void* block = ((u8*)allocator->memory) + allocator->allocated;
-        allocator->allocated += size;
+        void* block = ((u8*)allocator->memory) + allocator->allocated + padding;
+        allocator->allocated += padding + size;
+        if (allocator->allocated > allocator->dirty) {
+            allocator->dirty = allocator->allocated;
+        }
 
         return block;
     }
@@ -46,9 +63,12 @@ void* linearAllocatorAllocate(LinearAllocator* allocator, u64 size) {
     return 0;
 }
 
-void linearAllocatorFreeAll(LinearAllocator* allocator) {
+void linearAllocatorFreeAll(LinearAllocator* allocator, b8 clear) {
     if (allocator && allocator->memory) {
         allocator->allocated = 0;
-        engineZeroMemory(allocator->memory, allocator->totalSize);
+        if (clear) {
+            engineZeroMemory(allocator->memory, allocator->dirty);
+            allocator->dirty = 0;
+        }
     }
 }
@@ -6,6 +6,9 @@
 typedef struct LinearAllocator {
     u64 totalSize;
     u64 allocated;
+
+    /** High-water mark of bytes handed out since memory was last cleared. */
+    u64 dirty;
     void* memory;
     b8 ownsMemory;
 } LinearAllocator;
@@ -14,6 +17,25 @@ ENGINE_API void linearAllocatorCreate(u64 totalSize, void* memory, LinearAllocat
 ENGINE_API void linearAllocatorDestroy(LinearAllocator* allocator);
 
 ENGINE_API void* linearAllocatorAllocate(LinearAllocator* allocator, u64 size);
-ENGINE_API void linearAllocatorFreeAll(LinearAllocator* allocator);
+
+/**
+ * @brief Allocates size bytes starting on a multiple of alignment, skipping
+ * whatever padding that needs.
+ *
+ * @param allocator The allocator to allocate from.
+ * @param size The size of the allocation in bytes.
+ * @param alignment The required alignment. Must be a power of two; 1 for none.
+ * @return The block, or 0 if it does not fit.
+ */
+ENGINE_API void* linearAllocatorAllocateAligned(LinearAllocator* allocator, u64 size, u64 alignment);
+/**
+ * @brief Releases every allocation at once.
+ *
+ * @param allocator The allocator to reset.
+ * @param clear True to zero the memory handed out since the last clear (only up
+ * to the dirty high-water mark, never the whole block). False skips zeroing;
+ * later allocations may then contain stale data.
+ */
+ENGINE_API void linearAllocatorFreeAll(LinearAllocator* allocator, b8 clear);
 
 #endif /** __ENGINE_LINEAR_ALLOCATOR_H__ */
@@ -0,0 +1,238 @@
+#include "memory_tracker.h"
+
+#include "../platform/platform.h"
+
+typedef struct LiveAllocation {
+    /** 0 marks an empty slot. */
+    const void *block;
+    u64 size;
+    u32 callsite;
+} LiveAllocation;
+
+typedef struct MemoryTrackerState {
+    u64 capacity;
+    u64 liveCount;
+    u64 droppedCount;
+
+    /** Live allocations keyed by address; linear probing, at most half full. */
+    LiveAllocation *slots;
+    u64 slotMask;
+
+    /** Callsites are stored densely; the slots hold index + 1, 0 when empty. */
+    u32 callsiteCount;
+    u32 callsiteSlots[MEMORY_TRACKER_MAX_CALLSITES * 2];
+    MemoryCallsiteStats callsites[MEMORY_TRACKER_MAX_CALLSITES];
+} MemoryTrackerState;
+
+static u64 hashPointer(const void *pointer) {
+    u64 hash = (u64)pointer;
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+
+    return hash;
+}
+
+static u64 stateSize() {
+    return (sizeof(MemoryTrackerState) + 63) & ~63ULL;
+}
+
+static u64 slotCountFor(u64 capacity) {
+    u64 count = 16;
+    while (count < capacity * 2) {
+        count <<= 1;
+    }
+
+    return count;
+}
+
+void memoryTrackerCreate(u64 capacity, u64 *memoryRequirement, void *memory, MemoryTracker *outTracker) {
+    u64 slotCount = slotCountFor(capacity);
+    *memoryRequirement = stateSize() + (slotCount * sizeof(LiveAllocation));
+    if (!memory) {
+        return;
+    }
+
+    outTracker->memory = memory;
+    MemoryTrackerState *state = memory;
+    platformZeroMemory(memory, *memoryRequirement);
+    state->capacity = capacity;
+    state->slots = (LiveAllocation*)((u8*)memory + stateSize());
+    state->slotMask = slotCount - 1;
+}
+
+void memoryTrackerDestroy(MemoryTracker *tracker) {
+    if (tracker && tracker->memory) {
+        platformZeroMemory(tracker->memory, sizeof(MemoryTrackerState));
+        tracker->memory = 0;
+    }
+}
+
+/** Index of the callsite for file/line, created on first sight. INVALID_ID once the table is full. */
+static u32 findCallsite(MemoryTrackerState *state, const char *file, u32 line, u32 tag) {
+    const u32 mask = (MEMORY_TRACKER_MAX_CALLSITES * 2) - 1;
+    u32 slot = (u32)(hashPointer(file) ^ (line * 0x9e3779b9u)) & mask;
+
+    while (state->callsiteSlots[slot]) {
+        MemoryCallsiteStats *callsite = &state->callsites[state->callsiteSlots[slot] - 1];
+        if (callsite->file == file && callsite->line == line) {
+            return state->callsiteSlots[slot] - 1;
+        }
+
+        slot = (slot + 1) & mask;
+    }
+
+    if (state->callsiteCount >= MEMORY_TRACKER_MAX_CALLSITES) {
+        return INVALID_ID;
+    }
+
+    u32 index = state->callsiteCount++;
+    state->callsiteSlots[slot] = index + 1;
+    state->callsites[index].file = file;
+    state->callsites[index].line = line;
+    state->callsites[index].tag = tag;
+
+    return index;
+}
+
+void memoryTrackerAdd(MemoryTracker *tracker, const void *block, u64 size, u32 tag,
+    const char *file, u32 line) {
+
+    if (!tracker || !tracker->memory || !block) {
+        return;
+    }
+
+    MemoryTrackerState *state = tracker->memory;
+    u32 index = state->liveCount < state->capacity ? findCallsite(state, file, line, tag) : INVALID_ID;
+    if (index == INVALID_ID) {
+        state->droppedCount++;
+        return;
+    }
+
+    MemoryCallsiteStats *callsite = &state->callsites[index];
+    callsite->liveCount++;
+    callsite->liveBytes += size;
+    callsite->totalCount++;
+    callsite->totalBytes += size;
+    callsite->frameCount++;
+    callsite->frameBytes += size;
+
+    u64 slot = hashPointer(block) & state->slotMask;
+    while (state->slots[slot].block) {
+        slot = (slot + 1) & state->slotMask;
+    }
+
+    state->slots[slot].block = block;
+    state->slots[slot].size = size;
+    state->slots[slot].callsite = index;
+    state->liveCount++;
+}
+
+b8 memoryTrackerRemove(MemoryTracker *tracker, const void *block) {
+    if (!tracker || !tracker->memory || !block) {
+        return false;
+    }
+
+    MemoryTrackerState *state = tracker->memory;
+    u64 slot = hashPointer(block) & state->slotMask;
+    while (state->slots[slot].block != block) {
+        if (!state->slots[slot].block) {
+            return false;
+        }
+
+        slot = (slot + 1) & state->slotMask;
+    }
+
+    MemoryCallsiteStats *callsite = &state->callsites[state->slots[slot].callsite];
+    callsite->liveCount--;
+    callsite->liveBytes -= state->slots[slot].size;
+    state->liveCount--;
+
+    /** Backward-shift deletion: pull later entries of the run into the hole, no tombstones. */
+    u64 hole = slot;
+    u64 next = slot;
+    for (;;) {
+        next = (next + 1) & state->slotMask;
+        if (!state->slots[next].block) {
+            break;
+        }
+
+        u64 home = hashPointer(state->slots[next].block) & state->slotMask;
+        b8 staysPut = hole <= next ? (hole < home && home <= next) : (hole < home || home <= next);
+        if (!staysPut) {
+            state->slots[hole] = state->slots[next];
+            hole = next;
+        }
+    }
+
+    state->slots[hole].block = 0;
+
+    return true;
+}
+
+void memoryTrackerBeginFrame(MemoryTracker *tracker) {
+    if (!tracker || !tracker->memory) {
+        return;
+    }
+
+    MemoryTrackerState *state = tracker->memory;
+    for (u32 i = 0; i < state->callsiteCount; ++i) {
+        MemoryCallsiteStats *callsite = &state->callsites[i];
+        callsite->lastFrameCount = callsite->frameCount;
+        callsite->lastFrameBytes = callsite->frameBytes;
+        callsite->frameCount = 0;
+        callsite->frameBytes = 0;
+    }
+}
+
+static u64 callsiteScore(const MemoryCallsiteStats *callsite, MemoryCallsiteSort sort) {
+    switch (sort) {
+        case MEMORY_CALLSITE_SORT_LIVE_BYTES:
+            return callsite->liveBytes;
+        case MEMORY_CALLSITE_SORT_TOTAL_COUNT:
+            return callsite->totalCount;
+        case MEMORY_CALLSITE_SORT_LAST_FRAME_COUNT:
+            return callsite->lastFrameCount;
+    }
+
+    return 0;
+}
+
+u32 memoryTrackerGetTopCallsites(MemoryTracker *tracker, MemoryCallsiteSort sort, u32 maxCount,
+    MemoryCallsiteStats *outCallsites) {
+
+    if (!tracker || !tracker->memory || !outCallsites || !maxCount) {
+        return 0;
+    }
+
+    /** Insertion into a short sorted list; maxCount is expected to be small. */
+    MemoryTrackerState *state = tracker->memory;
+    u32 count = 0;
+    for (u32 i = 0; i < state->callsiteCount; ++i) {
+        u64 score = callsiteScore(&state->callsites[i], sort);
+        if (!score || (count == maxCount && score <= callsiteScore(&outCallsites[count - 1], sort))) {
+            continue;
+        }
+
+        u32 position = count < maxCount ? count++ : count - 1;
+        while (position > 0 && callsiteScore(&outCallsites[position - 1], sort) < score) {
+            outCallsites[position] = outCallsites[position - 1];
+            --position;
+        }
+
+        outCallsites[position] = state->callsites[i];
+    }
+
+    return count;
+}
+
+void memoryTrackerGetCounts(MemoryTracker *tracker, u64 *outLiveCount, u64 *outDroppedCount) {
+    MemoryTrackerState *state = tracker ? tracker->memory : 0;
+    if (outLiveCount) {
+        *outLiveCount = state ? state->liveCount : 0;
+    }
+
+    if (outDroppedCount) {
+        *outDroppedCount = state ? state->droppedCount : 0;
+    }
+}
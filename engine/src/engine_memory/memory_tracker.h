@@ -0,0 +1,104 @@
+#ifndef __ENGINE_MEMORY_TRACKER_H__
+#define __ENGINE_MEMORY_TRACKER_H__
+
+#include "../defines.h"
+
+/** Most distinct allocation callsites a tracker can tell apart; a power of two. */
+#define MEMORY_TRACKER_MAX_CALLSITES 4096
+
+/** @brief Allocation figures for a single __FILE__/__LINE__. */
+typedef struct MemoryCallsiteStats {
+    const char *file;
+    u32 line;
+
+    /** MemoryTag of the first allocation seen from here. */
+    u32 tag;
+
+    /** Blocks from here that have not been freed yet. */
+    u64 liveCount;
+    u64 liveBytes;
+
+    /** Everything ever allocated from here. */
+    u64 totalCount;
+    u64 totalBytes;
+
+    /** Allocations made during the last complete frame. */
+    u64 lastFrameCount;
+    u64 lastFrameBytes;
+
+    /** Allocations made so far during the current frame. */
+    u64 frameCount;
+    u64 frameBytes;
+} MemoryCallsiteStats;
+
+typedef enum MemoryCallsiteSort {
+    MEMORY_CALLSITE_SORT_LIVE_BYTES,
+    MEMORY_CALLSITE_SORT_TOTAL_COUNT,
+    MEMORY_CALLSITE_SORT_LAST_FRAME_COUNT
+} MemoryCallsiteSort;
+
+/**
+ * @brief Records live allocations by address, and per-callsite totals, in two
+ * open-addressing hash indices over fixed memory. Nothing is allocated after
+ * creation; once capacity is reached new blocks simply go untracked.
+ */
+typedef struct MemoryTracker {
+    /** Internal state and both indices. */
+    void *memory;
+} MemoryTracker;
+
+/**
+ * @brief Creates a new tracker or obtains the memory requirement for one.
+ * Call twice; once passing 0 to memory to obtain the memory requirement,
+ * and a second time passing an allocated block to memory.
+ *
+ * @param capacity The most live allocations tracked at once.
+ * @param memoryRequirement A pointer to hold the memory requirement.
+ * @param memory 0, or a pre-allocated block of memory for the tracker to use.
+ * @param outTracker A pointer to hold the tracker.
+ */
+void memoryTrackerCreate(u64 capacity, u64 *memoryRequirement, void *memory, MemoryTracker *outTracker);
+void memoryTrackerDestroy(MemoryTracker *tracker);
+
+/**
+ * @brief Records a new live block against the callsite that allocated it.
+ *
+ * @param tracker The tracker.
+ * @param block The block handed to the caller.
+ * @param size The size in bytes the caller asked for.
+ * @param tag The MemoryTag of the allocation.
+ * @param file The allocating source file; must be a string literal (__FILE__).
+ * @param line The allocating source line.
+ */
+void memoryTrackerAdd(MemoryTracker *tracker, const void *block, u64 size, u32 tag,
+    const char *file, u32 line);
+
+/**
+ * @brief Forgets a freed block.
+ *
+ * @return True if the block was being tracked; otherwise false.
+ */
+b8 memoryTrackerRemove(MemoryTracker *tracker, const void *block);
+
+/** @brief Closes the current frame's per-callsite counters and starts new ones. */
+void memoryTrackerBeginFrame(MemoryTracker *tracker);
+
+/**
+ * @brief Copies out the callsites that rank highest by the given measure.
+ *
+ * @param tracker The tracker.
+ * @param sort What to rank callsites by. Callsites scoring 0 are left out.
+ * @param maxCount The capacity of outCallsites.
+ * @param outCallsites An array to hold up to maxCount callsites, highest first.
+ * @return The number of callsites written.
+ */
+u32 memoryTrackerGetTopCallsites(MemoryTracker *tracker, MemoryCallsiteSort sort, u32 maxCount,
+    MemoryCallsiteStats *outCallsites);
+
+/**
+ * @brief Obtains the number of live blocks being tracked, and the number of
+ * allocations that went untracked because the tracker was full.
+ */
+void memoryTrackerGetCounts(MemoryTracker *tracker, u64 *outLiveCount, u64 *outDroppedCount);
+
+#endif
@@ -0,0 +1,166 @@
+#include "pool_allocator.h"
+
+#include "engine_memory.h"
+#include "../core/logger.h"
+
+typedef struct PoolFreeBlock {
+    struct PoolFreeBlock *next;
+} PoolFreeBlock;
+
+typedef struct PoolSizeClass {
+    u8 *begin;
+    u8 *end;
+    PoolFreeBlock *freeList;
+    PoolAllocatorClassStats stats;
+} PoolSizeClass;
+
+typedef struct PoolAllocatorState {
+    u64 blocksPerClass;
+    PoolSizeClass classes[POOL_ALLOCATOR_CLASS_COUNT];
+} PoolAllocatorState;
+
+/** Rounded to a cache line so slabs keep the alignment of the block they are carved from. */
+static u64 poolStateSize() {
+    return (sizeof(PoolAllocatorState) + 63) & ~63ULL;
+}
+
+/** Index of the smallest class whose block size is >= size. */
+static u32 poolClassIndex(u64 size) {
+    u32 index = 0;
+    u64 blockSize = POOL_ALLOCATOR_MIN_BLOCK_SIZE;
+    while (blockSize < size) {
+        blockSize <<= 1;
+        ++index;
+    }
+
+    return index;
+}
+
+void poolAllocatorCreate(u64 blocksPerClass, u64 *memoryRequirement, void *memory,
+    PoolAllocator *outAllocator) {
+
+    u64 slabRequirement = 0;
+    for (u32 i = 0; i < POOL_ALLOCATOR_CLASS_COUNT; ++i) {
+        slabRequirement += blocksPerClass * ((u64)POOL_ALLOCATOR_MIN_BLOCK_SIZE << i);
+    }
+
+    *memoryRequirement = poolStateSize() + slabRequirement;
+    if (!memory) {
+        return;
+    }
+
+    outAllocator->memory = memory;
+    PoolAllocatorState *state = memory;
+    engineZeroMemory(state, sizeof(PoolAllocatorState));
+    state->blocksPerClass = blocksPerClass;
+
+    /**
+     * Largest class first; every slab then starts on a multiple of its own
+     * block size (up to the alignment of memory), keeping blocks naturally aligned.
+     */
+    u8 *slab = (u8*)memory + poolStateSize();
+    for (u32 i = POOL_ALLOCATOR_CLASS_COUNT; i-- > 0;) {
+        PoolSizeClass *sizeClass = &state->classes[i];
+        u64 blockSize = (u64)POOL_ALLOCATOR_MIN_BLOCK_SIZE << i;
+
+        sizeClass->begin = slab;
+        sizeClass->end = slab + (blocksPerClass * blockSize);
+        sizeClass->stats.blockSize = blockSize;
+        sizeClass->stats.capacity = blocksPerClass;
+
+        /** Thread the free list back to front so blocks are handed out in address order. */
+        sizeClass->freeList = 0;
+        for (u64 j = blocksPerClass; j > 0; --j) {
+            PoolFreeBlock *block = (PoolFreeBlock*)(slab + ((j - 1) * blockSize));
+            block->next = sizeClass->freeList;
+            sizeClass->freeList = block;
+        }
+
+        slab = sizeClass->end;
+    }
+}
+
+void poolAllocatorDestroy(PoolAllocator *allocator) {
+    if (allocator && allocator->memory) {
+        engineZeroMemory(allocator->memory, sizeof(PoolAllocatorState));
+        allocator->memory = 0;
+    }
+}
+
+void *poolAllocatorAllocate(PoolAllocator *allocator, u64 size) {
+    if (!allocator || !allocator->memory || !size || size > POOL_ALLOCATOR_MAX_BLOCK_SIZE) {
+        return 0;
+    }
+
+    PoolAllocatorState *state = allocator->memory;
+    PoolSizeClass *sizeClass = &state->classes[poolClassIndex(size)];
+
+    PoolFreeBlock *block = sizeClass->freeList;
+    if (!block) {
+        sizeClass->stats.exhaustedCount++;
+        return 0;
+    }
+
+    sizeClass->freeList = block->next;
+    sizeClass->stats.used++;
+    if (sizeClass->stats.used > sizeClass->stats.peakUsed) {
+        sizeClass->stats.peakUsed = sizeClass->stats.used;
+    }
+
+    return block;
+}
+
+b8 poolAllocatorFree(PoolAllocator *allocator, void *block) {
+    if (!allocator || !allocator->memory || !block) {
+        return false;
+    }
+
+    PoolAllocatorState *state = allocator->memory;
+    for (u32 i = 0; i < POOL_ALLOCATOR_CLASS_COUNT; ++i) {
+        PoolSizeClass *sizeClass = &state->classes[i];
+        if ((u8*)block < sizeClass->begin || (u8*)block >= sizeClass->end) {
+            continue;
+        }
+
+        if (((u8*)block - sizeClass->begin) % sizeClass->stats.blockSize) {
+            ENGINE_ERROR("poolAllocatorFree - block (%p) is not on a %lluB block boundary.",
+                block, sizeClass->stats.blockSize)
+            return false;
+        }
+
+        PoolFreeBlock *freeBlock = block;
+        freeBlock->next = sizeClass->freeList;
+        sizeClass->freeList = freeBlock;
+        sizeClass->stats.used--;
+
+        return true;
+    }
+
+    ENGINE_ERROR("poolAllocatorFree - block (%p) is not owned by this allocator.", block)
+    return false;
+}
+
+b8 poolAllocatorOwns(PoolAllocator *allocator, const void *block) {
+    if (!allocator || !allocator->memory || !block) {
+        return false;
+    }
+
+    PoolAllocatorState *state = allocator->memory;
+    const u8 *begin = state->classes[POOL_ALLOCATOR_CLASS_COUNT - 1].begin;
+    const u8 *end = state->classes[0].end;
+
+    return (const u8*)block >= begin && (const u8*)block < end;
+}
+
+b8 poolAllocatorGetClassStats(PoolAllocator *allocator, u32 classIndex,
+    PoolAllocatorClassStats *outStats) {
+
+    if (!allocator || !allocator->memory || !outStats || classIndex >= POOL_ALLOCATOR_CLASS_COUNT) {
+        return false;
+    }
+
+    PoolAllocatorState *state = allocator->memory;
+    *outStats = state->classes[classIndex].stats;
+
+    return true;
+}
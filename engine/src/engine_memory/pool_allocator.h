@@ -0,0 +1,85 @@
+#ifndef __ENGINE_POOL_ALLOCATOR_H__
+#define __ENGINE_POOL_ALLOCATOR_H__
+
+#include "../defines.h"
+
+/** Number of power-of-two size classes, 16B through 512B. */
+#define POOL_ALLOCATOR_CLASS_COUNT 6
+#define POOL_ALLOCATOR_MIN_BLOCK_SIZE 16
+#define POOL_ALLOCATOR_MAX_BLOCK_SIZE (POOL_ALLOCATOR_MIN_BLOCK_SIZE << (POOL_ALLOCATOR_CLASS_COUNT - 1))
+
+/**
+ * @brief A pool of fixed-size blocks split into power-of-two size classes.
+ * Each class owns a contiguous slab and an intrusive free list, so both
+ * allocating and freeing are O(1). Requests larger than
+ * POOL_ALLOCATOR_MAX_BLOCK_SIZE, or for an exhausted class, fail and should
+ * be served elsewhere.
+ */
+typedef struct PoolAllocator {
+    /** Internal state and slabs. */
+    void *memory;
+} PoolAllocator;
+
+/** @brief Occupancy counters for a single size class. */
+typedef struct PoolAllocatorClassStats {
+    u64 blockSize;
+    u64 capacity;
+    u64 used;
+    u64 peakUsed;
+
+    /** Number of allocations turned away because the class was full. */
+    u64 exhaustedCount;
+} PoolAllocatorClassStats;
+
+/**
+ * @brief Creates a new pool allocator or obtains the memory requirement for one.
+ * Call twice; once passing 0 to memory to obtain the memory requirement,
+ * and a second time passing an allocated block to memory.
+ *
+ * @param blocksPerClass The number of blocks each size class can hold.
+ * @param memoryRequirement A pointer to hold the memory requirement, slabs included.
+ * @param memory 0, or a pre-allocated block of memory for the allocator to use.
+ * @param outAllocator A pointer to hold the allocator.
+ */
+ENGINE_API void poolAllocatorCreate(u64 blocksPerClass, u64 *memoryRequirement, void *memory,
+    PoolAllocator *outAllocator);
+
+/**
+ * @brief Destroys the given allocator. Does not release the memory passed to
+ * poolAllocatorCreate.
+ */
+ENGINE_API void poolAllocatorDestroy(PoolAllocator *allocator);
+
+/**
+ * @brief Allocates a block from the smallest size class that fits size.
+ *
+ * @param allocator A pointer to the allocator to allocate from.
+ * @param size The amount in bytes to be allocated.
+ * @return The block, or 0 if size is too large or the class is exhausted.
+ */
+ENGINE_API void *poolAllocatorAllocate(PoolAllocator *allocator, u64 size);
+
+/**
+ * @brief Returns a block to its size class. The class is worked out from the address.
+ *
+ * @param allocator A pointer to the allocator that owns the block.
+ * @param block The block to be freed.
+ * @return True on success; otherwise false.
+ */
+ENGINE_API b8 poolAllocatorFree(PoolAllocator *allocator, void *block);
+
+/** @brief Indicates if the given block lies within one of the allocator's slabs. */
+ENGINE_API b8 poolAllocatorOwns(PoolAllocator *allocator, const void *block);
+
+/**
+ * @brief Obtains the occupancy counters for one size class.
+ *
+ * @param allocator A pointer to the allocator.
+ * @param classIndex The size class, 0 to POOL_ALLOCATOR_CLASS_COUNT - 1.
+ * @param outStats A pointer to hold the counters.
+ * @return True on success; otherwise false.
+ */
+ENGINE_API b8 poolAllocatorGetClassStats(PoolAllocator *allocator, u32 classIndex,
+    PoolAllocatorClassStats *outStats);
+
+#endif
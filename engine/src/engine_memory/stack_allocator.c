@@ -0,0 +1,127 @@
+#include "stack_allocator.h"
+
+#include "engine_memory.h"
+#include "../core/logger.h"
+
+static ENGINE_THREAD_LOCAL StackAllocator *scratchStack = 0;
+
+void stackAllocatorCreate(u64 totalSize, void *memory, StackAllocator *outAllocator) {
+    if (!outAllocator) {
+        return;
+    }
+
+    engineZeroMemory(outAllocator, sizeof(StackAllocator));
+    outAllocator->totalSize = totalSize;
+    outAllocator->ownsMemory = memory == 0;
+    if (memory) {
+        outAllocator->memory = memory;
+    } else {
+        outAllocator->memory = engineAllocateUninitialized(totalSize, MEMORY_TAG_LINEAR_ALLOCATOR);
+    }
+}
+
+void stackAllocatorDestroy(StackAllocator *allocator) {
+    if (!allocator) {
+        return;
+    }
+
+#ifdef _DEBUG
+    if (allocator->markerDepth) {
+        ENGINE_WARNING("stackAllocatorDestroy - %u markers were never freed to.", allocator->markerDepth)
+    }
+#endif
+
+    if (allocator->ownsMemory && allocator->memory) {
+        engineFree(allocator->memory, allocator->totalSize, MEMORY_TAG_LINEAR_ALLOCATOR);
+    }
+
+    engineZeroMemory(allocator, sizeof(StackAllocator));
+}
+
+void *stackAllocatorAllocate(StackAllocator *allocator, u64 size, u64 alignment) {
+    if (!allocator || !allocator->memory) {
+        ENGINE_ERROR("stackAllocatorAllocate - provided allocator not initialized.")
+        return 0;
+    }
+
+    if (alignment < 1) {
+        alignment = 1;
+    }
+
+    if (alignment & (alignment - 1)) {
+        ENGINE_ERROR("stackAllocatorAllocate - alignment %llu is not a power of two.", alignment)
+        return 0;
+    }
+
+    u64 address = (u64)allocator->memory + allocator->top;
+    u64 padding = (alignment - (address & (alignment - 1))) & (alignment - 1);
+
+    if (allocator->top + padding + size > allocator->totalSize) {
+        ENGINE_ERROR("stackAllocatorAllocate - Tried to allocate %lluB, only %lluB remaining.",
+            size, allocator->totalSize - allocator->top)
+        return 0;
+    }
+
+    void *block = (u8*)allocator->memory + allocator->top + padding;
+    allocator->top += padding + size;
+    if (allocator->top > allocator->highWaterMark) {
+        allocator->highWaterMark = allocator->top;
+    }
+
+    return block;
+}
+
+StackAllocatorMarker stackAllocatorGetMarker(StackAllocator *allocator) {
+    if (!allocator) {
+        return 0;
+    }
+
+#ifdef _DEBUG
+    if (allocator->markerDepth < STACK_ALLOCATOR_MAX_DEBUG_MARKERS) {
+        allocator->markers[allocator->markerDepth] = allocator->top;
+    }
+    allocator->markerDepth++;
+#endif
+
+    return allocator->top;
+}
+
+b8 stackAllocatorFreeToMarker(StackAllocator *allocator, StackAllocatorMarker marker) {
+    if (!allocator) {
+        return false;
+    }
+
+    if (marker > allocator->top) {
+        ENGINE_ERROR("stackAllocatorFreeToMarker - marker %llu is above the top of the stack (%llu); already freed?",
+            marker, allocator->top)
+        return false;
+    }
+
+#ifdef _DEBUG
+    if (!allocator->markerDepth) {
+        ENGINE_ERROR("stackAllocatorFreeToMarker - no outstanding markers.")
+        return false;
+    }
+
+    /** Nesting deeper than the tracked depth is only counted, not checked. */
+    u32 index = allocator->markerDepth - 1;
+    if (index < STACK_ALLOCATOR_MAX_DEBUG_MARKERS && allocator->markers[index] != marker) {
+        ENGINE_ERROR("stackAllocatorFreeToMarker - marker %llu freed out of order; innermost is %llu.",
+            marker, allocator->markers[index])
+        return false;
+    }
+    allocator->markerDepth--;
+#endif
+
+    allocator->top = marker;
+
+    return true;
+}
+
+void stackAllocatorSetScratch(StackAllocator *allocator) {
+    scratchStack = allocator;
+}
+
+StackAllocator *stackAllocatorGetScratch() {
+    return scratchStack;
+}
@@ -0,0 +1,80 @@
+#ifndef __ENGINE_STACK_ALLOCATOR_H__
+#define __ENGINE_STACK_ALLOCATOR_H__
+
+#include "../defines.h"
+
+/** Depth of nested markers tracked for out-of-order checks in debug builds. */
+#define STACK_ALLOCATOR_MAX_DEBUG_MARKERS 32
+
+/** Position on a stack allocator to roll back to. */
+typedef u64 StackAllocatorMarker;
+
+/**
+ * @brief A linear block that can be rolled back to an earlier marker, so
+ * temporaries with nested, last-in-first-out lifetimes can be released
+ * without touching the heap. Every marker obtained must later be passed to
+ * stackAllocatorFreeToMarker, innermost first.
+ */
+typedef struct StackAllocator {
+    u64 totalSize;
+    u64 top;
+
+    /** The most bytes in use at any one time. */
+    u64 highWaterMark;
+    void *memory;
+    b8 ownsMemory;
+
+    /**
+     * Outstanding markers, only filled in and checked by debug builds. Always
+     * present so the layout does not depend on how the caller was built.
+     */
+    StackAllocatorMarker markers[STACK_ALLOCATOR_MAX_DEBUG_MARKERS];
+    u32 markerDepth;
+} StackAllocator;
+
+/**
+ * @brief Creates a stack allocator over the given memory, or allocates its own if memory is 0.
+ *
+ * @param totalSize The size in bytes of the block.
+ * @param memory 0, or a pre-allocated block of memory for the allocator to use.
+ * @param outAllocator A pointer to hold the allocator.
+ */
+ENGINE_API void stackAllocatorCreate(u64 totalSize, void *memory, StackAllocator *outAllocator);
+ENGINE_API void stackAllocatorDestroy(StackAllocator *allocator);
+
+/**
+ * @brief Allocates size bytes from the top of the stack. The contents are uninitialized.
+ *
+ * @param allocator The allocator to allocate from.
+ * @param size The size of the allocation in bytes.
+ * @param alignment The required alignment. Must be a power of two; 0 or 1 for none.
+ * @return The block, or 0 if it does not fit.
+ */
+ENGINE_API void *stackAllocatorAllocate(StackAllocator *allocator, u64 size, u64 alignment);
+
+/** @brief Obtains a marker for the current top of the stack. */
+ENGINE_API StackAllocatorMarker stackAllocatorGetMarker(StackAllocator *allocator);
+
+/**
+ * @brief Releases everything allocated since marker was obtained. Debug
+ * builds reject markers freed out of order.
+ *
+ * @param allocator The allocator to roll back.
+ * @param marker A marker previously obtained from the same allocator.
+ * @return True on success; otherwise false.
+ */
+ENGINE_API b8 stackAllocatorFreeToMarker(StackAllocator *allocator, StackAllocatorMarker marker);
+
+/**
+ * @brief Binds a scratch stack to the calling thread; 0 unbinds it. Each
+ * thread that wants scratch memory must bind its own. The application binds
+ * one on the main thread and the job system one per worker (see
+ * JobSystemConfig.workerScratchSize); other threads, such as the parallel-for
+ * pool's, have none, so callers fall back to the heap when this returns 0.
+ */
+ENGINE_API void stackAllocatorSetScratch(StackAllocator *allocator);
+
+/** @brief The scratch stack bound to the calling thread, or 0 if none. */
+ENGINE_API StackAllocator *stackAllocatorGetScratch();
+
+#endif
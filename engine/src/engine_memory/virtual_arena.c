@@ -0,0 +1,118 @@
+#include "virtual_arena.h"
+
+#include "../core/logger.h"
+#include "../platform/platform.h"
+
+/** Running totals over every live arena, for the memory stats. */
+static u64 totalReserved = 0;
+static u64 totalCommitted = 0;
+
+static u64 roundUp(u64 value, u64 granularity) {
+    return ((value + granularity - 1) / granularity) * granularity;
+}
+
+b8 virtualArenaCreate(u64 reserveSize, VirtualArena *outArena) {
+    if (!outArena || reserveSize == 0) {
+        ENGINE_ERROR("virtualArenaCreate requires an arena and a reserveSize > 0.")
+        return false;
+    }
+
+    platformZeroMemory(outArena, sizeof(VirtualArena));
+
+    u64 pageSize = platformGetPageSize();
+    outArena->commitChunk = roundUp(VIRTUAL_ARENA_COMMIT_CHUNK, pageSize);
+    outArena->reservedSize = roundUp(reserveSize, outArena->commitChunk);
+
+    outArena->memory = platformReserveMemory(outArena->reservedSize);
+    if (!outArena->memory) {
+        ENGINE_ERROR("virtualArenaCreate - unable to reserve %lluB of address space.",
+            outArena->reservedSize)
+        outArena->reservedSize = 0;
+        return false;
+    }
+
+    totalReserved += outArena->reservedSize;
+
+    return true;
+}
+
+void virtualArenaDestroy(VirtualArena *arena) {
+    if (!arena || !arena->memory) {
+        return;
+    }
+
+    platformReleaseMemory(arena->memory, arena->reservedSize);
+    totalReserved -= arena->reservedSize;
+    totalCommitted -= arena->committedSize;
+
+    platformZeroMemory(arena, sizeof(VirtualArena));
+}
+
+void *virtualArenaAllocate(VirtualArena *arena, u64 size) {
+    return virtualArenaAllocateAligned(arena, size, VIRTUAL_ARENA_DEFAULT_ALIGNMENT);
+}
+
+void *virtualArenaAllocateAligned(VirtualArena *arena, u64 size, u64 alignment) {
+    if (!arena || !arena->memory) {
+        ENGINE_ERROR("virtualArenaAllocate - provided arena not initialized.")
+        return 0;
+    }
+
+    if (alignment == 0 || (alignment & (alignment - 1))) {
+        ENGINE_ERROR("virtualArenaAllocate - alignment %llu is not a power of two.", alignment)
+        return 0;
+    }
+
+    u64 offset = (arena->allocated + alignment - 1) & ~(alignment - 1);
+    u64 end = offset + size;
+    if (end > arena->reservedSize) {
+        ENGINE_ERROR("virtualArenaAllocate - Tried to allocate %lluB, only %lluB of the reservation remaining.",
+            size, arena->reservedSize - arena->allocated)
+        return 0;
+    }
+
+    if (end > arena->committedSize) {
+        u64 commitEnd = roundUp(end, arena->commitChunk);
+        if (commitEnd > arena->reservedSize) {
+            commitEnd = arena->reservedSize;
+        }
+
+        if (!platformCommitMemory((u8*)arena->memory + arena->committedSize,
+            commitEnd - arena->committedSize)) {
+
+            ENGINE_ERROR("virtualArenaAllocate - unable to commit %lluB.", commitEnd - arena->committedSize)
+            return 0;
+        }
+
+        totalCommitted += commitEnd - arena->committedSize;
+        arena->committedSize = commitEnd;
+    }
+
+    arena->allocated = end;
+
+    return (u8*)arena->memory + offset;
+}
+
+void virtualArenaFreeAll(VirtualArena *arena) {
+    if (!arena || !arena->memory) {
+        return;
+    }
+
+    if (arena->committedSize) {
+        platformDecommitMemory(arena->memory, arena->committedSize);
+        totalCommitted -= arena->committedSize;
+    }
+
+    arena->committedSize = 0;
+    arena->allocated = 0;
+}
+
+void virtualArenaGetTotals(u64 *outReserved, u64 *outCommitted) {
+    if (outReserved) {
+        *outReserved = totalReserved;
+    }
+
+    if (outCommitted) {
+        *outCommitted = totalCommitted;
+    }
+}
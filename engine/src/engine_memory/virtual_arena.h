@@ -0,0 +1,72 @@
+#ifndef __ENGINE_VIRTUAL_ARENA_H__
+#define __ENGINE_VIRTUAL_ARENA_H__
+
+#include "../defines.h"
+
+/** Pages are committed at least this many bytes at a time to keep commit calls rare. */
+#define VIRTUAL_ARENA_COMMIT_CHUNK (64 * 1024)
+
+/** Alignment of blocks from virtualArenaAllocate. */
+#define VIRTUAL_ARENA_DEFAULT_ALIGNMENT 16
+
+/**
+ * @brief A linear allocator over a reserved range of address space. Pages are
+ * committed only as allocations reach them, so the arena can be reserved far
+ * larger than it will ever need while resident memory tracks real use.
+ * Blocks never move and come back zeroed.
+ */
+typedef struct VirtualArena {
+    u64 reservedSize;
+    u64 committedSize;
+    u64 allocated;
+
+    /** Commit granularity; a multiple of the page size. */
+    u64 commitChunk;
+    void *memory;
+} VirtualArena;
+
+/**
+ * @brief Reserves address space for a new arena. Nothing is committed yet.
+ *
+ * @param reserveSize The most bytes the arena can ever hold. Rounded up to the commit chunk.
+ * @param outArena A pointer to hold the arena.
+ * @return True on success; otherwise false.
+ */
+ENGINE_API b8 virtualArenaCreate(u64 reserveSize, VirtualArena *outArena);
+
+/** @brief Releases the arena's whole range back to the OS. */
+ENGINE_API void virtualArenaDestroy(VirtualArena *arena);
+
+/**
+ * @brief Allocates size zeroed bytes aligned to VIRTUAL_ARENA_DEFAULT_ALIGNMENT,
+ * committing more pages if needed.
+ *
+ * @return The block, or 0 if the reservation is exhausted or the commit failed.
+ */
+ENGINE_API void *virtualArenaAllocate(VirtualArena *arena, u64 size);
+
+/**
+ * @brief Allocates size zeroed bytes starting on a multiple of alignment.
+ *
+ * @param arena The arena to allocate from.
+ * @param size The size of the allocation in bytes.
+ * @param alignment The required alignment. Must be a power of two.
+ * @return The block, or 0 if the reservation is exhausted or the commit failed.
+ */
+ENGINE_API void *virtualArenaAllocateAligned(VirtualArena *arena, u64 size, u64 alignment);
+
+/**
+ * @brief Releases every allocation and decommits all pages, returning the
+ * memory to the OS. The reservation is kept.
+ */
+ENGINE_API void virtualArenaFreeAll(VirtualArena *arena);
+
+/**
+ * @brief Obtains the bytes reserved and committed across every live arena.
+ *
+ * @param outReserved A pointer to hold the reserved byte count. May be 0.
+ * @param outCommitted A pointer to hold the committed byte count. May be 0.
+ */
+ENGINE_API void virtualArenaGetTotals(u64 *outReserved, u64 *outCommitted);
+
+#endif
@@ -102,14 +102,26 @@ b8 filesystemRead(FileHandle *handle, u64 dataSize, void *outData, u64 *outBytes
     return false;
 }
 
-b8 filesystemReadAllBytes(FileHandle *handle, u8 **outBytes, u64 *outBytesRead) {
+b8 filesystemSize(FileHandle *handle, u64 *outSize) {
     if (handle->handle) {
-        /** File size. */
         fseek((FILE*)handle->handle, 0, SEEK_END);
-        u64 size = ftell((FILE*)handle->handle);
+        *outSize = ftell((FILE*)handle->handle);
         rewind((FILE*)handle->handle);
 
-        *outBytes = engineAllocate(sizeof(u8) * size, MEMORY_TAG_STRING);
+        return true;
+    }
+
+    return false;
+}
+
+b8 filesystemReadAllBytes(FileHandle *handle, u8 **outBytes, u64 *outBytesRead) {
+    if (handle->handle) {
+        /** File size. */
+        u64 size = 0;
+        filesystemSize(handle, &size);
+
+        /** Overwritten by fread right away, so skip zeroing. */
+        *outBytes = engineAllocateUninitialized(sizeof(u8) * size, MEMORY_TAG_STRING);
         *outBytesRead = fread(*outBytes, 1, size, (FILE*)handle->handle);
 
         if (*outBytesRead != size) {
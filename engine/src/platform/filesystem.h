@@ -59,6 +59,14 @@ ENGINE_API b8 filesystemReadLine(FileHandle *handle, u64 maxLength, char **lineB
  */
 ENGINE_API b8 filesystemWriteLine(FileHandle *handle, const char *text);
 
+/**
+ * Obtains the size of an open file and rewinds it to the start.
+ * @param handle A pointer to a file_handle structure.
+ * @param outSize A pointer to hold the file size in bytes.
+ * @returns True if successful; otherwise false.
+ */
+ENGINE_API b8 filesystemSize(FileHandle *handle, u64 *outSize);
+
 /** 
  * Reads up to dataSize bytes of data into out_bytes_read. 
  * Allocates *out_data, which must be freed by the caller.
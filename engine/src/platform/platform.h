@@ -17,11 +17,39 @@ void platformSystemShutdown(void *state);
 
 b8 platformPumpMessages();
 
+/** Alignment of blocks from platformAllocate with aligned = true; one cache line. */
+#define PLATFORM_ALLOCATION_ALIGNMENT 64
+
+/**
+ * Allocates size bytes from the OS heap. When aligned is true the block starts
+ * on a PLATFORM_ALLOCATION_ALIGNMENT boundary and must be freed with aligned = true.
+ */
 void* platformAllocate(u64 size, b8 aligned);
 void platformFree(void* block, b8 aligned);
 
+/** Size in bytes of a virtual memory page; the granularity of commit and decommit. */
+u64 platformGetPageSize();
+
+/**
+ * Reserves size bytes of address space without backing it with memory.
+ * Touching the range faults until it is committed. Returns 0 on failure.
+ */
+void* platformReserveMemory(u64 size);
+
+/** Backs a page-aligned range of reserved space with zeroed, read/write memory. */
+b8 platformCommitMemory(void* block, u64 size);
+
+/** Returns the memory behind a committed range to the OS; the range stays reserved. */
+void platformDecommitMemory(void* block, u64 size);
+
+/** Releases a whole range obtained from platformReserveMemory. */
+void platformReleaseMemory(void* block, u64 size);
+
 void* platformZeroMemory(void* block, u64 size);
 void* platformCopyMemory(void* dest, const void* source, u64 size);
+
+/** Like platformCopyMemory, but dest and source may overlap. */
+void* platformMoveMemory(void* dest, const void* source, u64 size);
 void* platformSetMemory(void* dest, i32 value, u64 size);
 
 void platformConsoleWrite(const char* message, u8 color);
@@ -35,4 +63,136 @@ f64 platformGetAbsoluteTime();
  */
 void platformSleep(u64 ms);
 
+/** Number of logical processors available to the process; at least 1. */
+ENGINE_API u32 platformGetProcessorCount();
+
+/** Entry point of a platform thread. The return value is discarded. */
+typedef u32 (*PFN_platformThreadStart)(void *argument);
+
+typedef struct PlatformThread {
+    /** The OS handle; a pthread_t or a HANDLE. */
+    u64 handle;
+} PlatformThread;
+
+/**
+ * @brief Starts a thread running start(argument).
+ *
+ * @param start The function to run. Required.
+ * @param argument Passed to start.
+ * @param outThread A pointer to hold the thread.
+ * @return True if the thread was started; otherwise false.
+ */
+ENGINE_API b8 platformThreadCreate(PFN_platformThreadStart start, void *argument, PlatformThread *outThread);
+
+/** Waits for the thread to return and releases it. */
+ENGINE_API void platformThreadJoin(PlatformThread *thread);
+
+/** The calling thread. Good for naming and affinity; never join it. */
+ENGINE_API PlatformThread platformThreadGetCurrent();
+
+/**
+ * @brief Names the thread for debuggers and profilers. Linux keeps the
+ * first 15 characters.
+ */
+ENGINE_API void platformThreadSetName(PlatformThread *thread, const char *name);
+
+/**
+ * @brief Restricts the thread to the processors whose bits are set in
+ * processorMask; bit i is logical processor i.
+ *
+ * @return True if the OS accepted the mask; otherwise false.
+ */
+ENGINE_API b8 platformThreadSetAffinity(PlatformThread *thread, u64 processorMask);
+
+/** Gives the rest of this thread's time slice to another ready thread. */
+ENGINE_API void platformThreadYield();
+
+/**
+ * @brief A mutual exclusion lock. Zero-initialized is unlocked, so there is
+ * nothing to create or destroy. Uncontended lock and unlock stay in user
+ * space: a futex word on Linux, an SRW lock on Win32. Not recursive.
+ */
+typedef struct PlatformMutex {
+    void *internalData;
+} PlatformMutex;
+
+ENGINE_API void platformMutexLock(PlatformMutex *mutex);
+
+/** @return True if the mutex was free and is now held; otherwise false. */
+ENGINE_API b8 platformMutexTryLock(PlatformMutex *mutex);
+
+ENGINE_API void platformMutexUnlock(PlatformMutex *mutex);
+
+/**
+ * @brief Lets threads sleep until another thread changes state guarded by a
+ * mutex. Zero-initialized is ready to use. Wakeups can be spurious, so wait
+ * in a loop that rechecks the state.
+ */
+typedef struct PlatformConditionVariable {
+    void *internalData;
+} PlatformConditionVariable;
+
+/** Unlocks mutex, sleeps until signalled, and locks mutex again before returning. */
+ENGINE_API void platformConditionVariableWait(PlatformConditionVariable *condition, PlatformMutex *mutex);
+
+/** Wakes one waiter, if any. */
+ENGINE_API void platformConditionVariableSignal(PlatformConditionVariable *condition);
+
+/** Wakes every waiter. */
+ENGINE_API void platformConditionVariableBroadcast(PlatformConditionVariable *condition);
+
+/**
+ * @brief A counting semaphore. On Linux it is a futex word, so signalling
+ * with no one waiting and waiting while above zero make no system call.
+ */
+typedef struct PlatformSemaphore {
+    void *internalData;
+} PlatformSemaphore;
+
+/** Creates a counting semaphore holding initialCount. */
+ENGINE_API b8 platformSemaphoreCreate(u32 initialCount, PlatformSemaphore *outSemaphore);
+ENGINE_API void platformSemaphoreDestroy(PlatformSemaphore *semaphore);
+
+/** Adds count to the semaphore, waking up to count waiters. */
+ENGINE_API void platformSemaphoreSignal(PlatformSemaphore *semaphore, u32 count);
+
+/** Waits until the semaphore is above zero, then takes one from it. */
+ENGINE_API void platformSemaphoreWait(PlatformSemaphore *semaphore);
+
+/** Entry point of a fiber. It must never return; switch away instead. */
+typedef void (*PFN_platformFiberStart)(void *argument);
+
+/**
+ * @brief A user-mode execution context with its own stack. Fibers are
+ * switched explicitly and may be resumed on a different thread than the one
+ * that suspended them.
+ */
+typedef struct PlatformFiber {
+    void *internalData;
+} PlatformFiber;
+
+/**
+ * @brief Creates a fiber that runs start(argument) the first time it is
+ * switched to. The stack is reserved with a guard page below it, so an
+ * overflow faults instead of silently corrupting a neighbour.
+ *
+ * @param stackSize Usable stack size in bytes; rounded up to whole pages.
+ * @param start The function to run. Required.
+ * @param argument Passed to start.
+ * @param outFiber A pointer to hold the fiber.
+ * @return True on success; otherwise false.
+ */
+b8 platformFiberCreate(u64 stackSize, PFN_platformFiberStart start, void *argument, PlatformFiber *outFiber);
+void platformFiberDestroy(PlatformFiber *fiber);
+
+/**
+ * @brief Turns the calling thread into a fiber so it can switch to others.
+ * Undo with platformFiberRevertThread on the same thread.
+ */
+b8 platformFiberConvertThread(PlatformFiber *outFiber);
+void platformFiberRevertThread(PlatformFiber *fiber);
+
+/** Saves the running context into from and resumes to. */
+void platformFiberSwitch(PlatformFiber *from, PlatformFiber *to);
+
 #endif
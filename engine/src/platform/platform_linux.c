@@ -1,8 +1,14 @@
+/** For pthread_setname_np, pthread_setaffinity_np and cpu_set_t. */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
 #include "platform.h"
 
 /* Linux platform layer. */
 #if PLATFORM_LINUX
 
+#include "../core/atomic.h"
 #include "../core/logger.h"
 #include "../core/event.h"
 #include "../core/input.h"
@@ -15,6 +21,13 @@
 #include <X11/Xlib.h>
 #include <X11/Xlib-xcb.h> /* sudo apt-get install libxkbcommon-x11-dev */
 #include <sys/time.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+#include <ucontext.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
 
 #if _POSIX_C_SOURCE >= 199309L
 #include <time.h>
@@ -275,6 +288,14 @@ b8 platformPumpMessages(PlatformState* platformState) {
 }
 
 void* platformAllocate(u64 size, b8 aligned) {
+    if (aligned) {
+        void* block = 0;
+        if (posix_memalign(&block, PLATFORM_ALLOCATION_ALIGNMENT, size) != 0) {
+            return 0;
+        }
+        return block;
+    }
+
     return malloc(size);
 }
 
@@ -282,6 +303,29 @@ void platformFree(void* block, b8 aligned) {
     free(block);
 }
 
+u64 platformGetPageSize() {
+    return (u64)sysconf(_SC_PAGESIZE);
+}
+
+void* platformReserveMemory(u64 size) {
+    void* block = mmap(0, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    return block == MAP_FAILED ? 0 : block;
+}
+
+b8 platformCommitMemory(void* block, u64 size) {
+    return mprotect(block, size, PROT_READ | PROT_WRITE) == 0;
+}
+
+void platformDecommitMemory(void* block, u64 size) {
+    /** Drop the pages so they read back as zero once committed again. */
+    madvise(block, size, MADV_DONTNEED);
+    mprotect(block, size, PROT_NONE);
+}
+
+void platformReleaseMemory(void* block, u64 size) {
+    munmap(block, size);
+}
+
 void* platformZeroMemory(void* block, u64 size) {
     return memset(block, 0, size);
 }
@@ -290,6 +334,10 @@ void* platformCopyMemory(void* dest, const void* source, u64 size) {
     return memcpy(dest, source, size);
 }
 
+void* platformMoveMemory(void* dest, const void* source, u64 size) {
+    return memmove(dest, source, size);
+}
+
 void* platformSetMemory(void* dest, i32 value, u64 size) {
     return memset(dest, value, size);
 }
@@ -326,6 +374,399 @@ void platformSleep(u64 ms) {
 #endif
 }
 
+u32 platformGetProcessorCount() {
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (u32)count : 1;
+}
+
+typedef struct ThreadStart {
+    PFN_platformThreadStart start;
+    void *argument;
+} ThreadStart;
+
+static void* threadTrampoline(void *argument) {
+    ThreadStart threadStart = *(ThreadStart*)argument;
+    free(argument);
+    threadStart.start(threadStart.argument);
+    return 0;
+}
+
+b8 platformThreadCreate(PFN_platformThreadStart start, void *argument, PlatformThread *outThread) {
+    if (!start || !outThread) {
+        return false;
+    }
+
+    /** Freed by the new thread once it has read it. */
+    ThreadStart *threadStart = malloc(sizeof(ThreadStart));
+    if (!threadStart) {
+        return false;
+    }
+
+    threadStart->start = start;
+    threadStart->argument = argument;
+
+    pthread_t thread;
+    if (pthread_create(&thread, 0, threadTrampoline, threadStart) != 0) {
+        ENGINE_ERROR("pthread_create failed.")
+        free(threadStart);
+        return false;
+    }
+
+    outThread->handle = (u64)thread;
+    return true;
+}
+
+void platformThreadJoin(PlatformThread *thread) {
+    if (thread && thread->handle) {
+        pthread_join((pthread_t)thread->handle, 0);
+        thread->handle = 0;
+    }
+}
+
+PlatformThread platformThreadGetCurrent() {
+    PlatformThread thread;
+    thread.handle = (u64)pthread_self();
+    return thread;
+}
+
+void platformThreadSetName(PlatformThread *thread, const char *name) {
+    /** The kernel keeps 15 characters and the terminator; longer names are rejected outright. */
+    char truncated[16];
+    strncpy(truncated, name, sizeof(truncated) - 1);
+    truncated[sizeof(truncated) - 1] = 0;
+    pthread_setname_np((pthread_t)thread->handle, truncated);
+}
+
+b8 platformThreadSetAffinity(PlatformThread *thread, u64 processorMask) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (u32 i = 0; i < 64; ++i) {
+        if (processorMask & (1ULL << i)) {
+            CPU_SET(i, &set);
+        }
+    }
+
+    return pthread_setaffinity_np((pthread_t)thread->handle, sizeof(cpu_set_t), &set) == 0;
+}
+
+void platformThreadYield() {
+    sched_yield();
+}
+
+/**
+ * The mutex, condition variable and semaphore keep their state in the 8
+ * bytes of internalData: word 0 is the futex word, word 1 counts sleepers
+ * where that saves a wake call.
+ */
+static volatile u32* futexWords(void **internalData) {
+    return (volatile u32*)internalData;
+}
+
+static void futexWait(volatile u32 *word, u32 expected) {
+    syscall(SYS_futex, word, FUTEX_WAIT_PRIVATE, expected, 0, 0, 0);
+}
+
+static void futexWake(volatile u32 *word, u32 count) {
+    syscall(SYS_futex, word, FUTEX_WAKE_PRIVATE, count, 0, 0, 0);
+}
+
+/** Mutex states: 0 unlocked, 1 locked, 2 locked with possible sleepers. */
+#define MUTEX_SPIN_COUNT 64
+
+void platformMutexLock(PlatformMutex *mutex) {
+    volatile u32 *word = futexWords(&mutex->internalData);
+    u32 state = 0;
+    for (u32 spin = 0; spin < MUTEX_SPIN_COUNT; ++spin) {
+        if (atomicCompareExchange32(word, &state, 1)) {
+            return;
+        }
+
+        if (state == 2) {
+            break;
+        }
+
+        state = 0;
+        atomicPause();
+    }
+
+    /** From here on the lock is marked contended, so the holder knows to wake someone. */
+    state = atomicExchange32(word, 2);
+    while (state != 0) {
+        futexWait(word, 2);
+        state = atomicExchange32(word, 2);
+    }
+}
+
+b8 platformMutexTryLock(PlatformMutex *mutex) {
+    u32 state = 0;
+    return atomicCompareExchange32(futexWords(&mutex->internalData), &state, 1);
+}
+
+void platformMutexUnlock(PlatformMutex *mutex) {
+    volatile u32 *word = futexWords(&mutex->internalData);
+    if (atomicExchange32(word, 0) == 2) {
+        futexWake(word, 1);
+    }
+}
+
+void platformConditionVariableWait(PlatformConditionVariable *condition, PlatformMutex *mutex) {
+    volatile u32 *words = futexWords(&condition->internalData);
+    atomicFetchAdd32(&words[1], 1);
+    u32 sequence = atomicLoad32(&words[0]);
+    platformMutexUnlock(mutex);
+
+    /** Returns at once if a signal bumped the sequence since it was read. */
+    futexWait(&words[0], sequence);
+    atomicFetchSub32(&words[1], 1);
+
+    /** Relock as contended: other waiters may have been woken alongside this one. */
+    volatile u32 *mutexWord = futexWords(&mutex->internalData);
+    while (atomicExchange32(mutexWord, 2) != 0) {
+        futexWait(mutexWord, 2);
+    }
+}
+
+void platformConditionVariableSignal(PlatformConditionVariable *condition) {
+    volatile u32 *words = futexWords(&condition->internalData);
+    atomicFetchAdd32(&words[0], 1);
+    if (atomicLoad32(&words[1])) {
+        futexWake(&words[0], 1);
+    }
+}
+
+void platformConditionVariableBroadcast(PlatformConditionVariable *condition) {
+    volatile u32 *words = futexWords(&condition->internalData);
+    atomicFetchAdd32(&words[0], 1);
+    if (atomicLoad32(&words[1])) {
+        futexWake(&words[0], 0x7fffffff);
+    }
+}
+
+b8 platformSemaphoreCreate(u32 initialCount, PlatformSemaphore *outSemaphore) {
+    outSemaphore->internalData = 0;
+    atomicStore32(futexWords(&outSemaphore->internalData), initialCount);
+    return true;
+}
+
+void platformSemaphoreDestroy(PlatformSemaphore *semaphore) {
+    if (semaphore) {
+        semaphore->internalData = 0;
+    }
+}
+
+void platformSemaphoreSignal(PlatformSemaphore *semaphore, u32 count) {
+    volatile u32 *words = futexWords(&semaphore->internalData);
+    atomicFetchAdd32(&words[0], count);
+    if (count && atomicLoad32(&words[1])) {
+        futexWake(&words[0], count);
+    }
+}
+
+void platformSemaphoreWait(PlatformSemaphore *semaphore) {
+    volatile u32 *words = futexWords(&semaphore->internalData);
+    u32 count = atomicLoad32(&words[0]);
+    for (;;) {
+        if (count > 0) {
+            if (atomicCompareExchange32(&words[0], &count, count - 1)) {
+                return;
+            }
+
+            continue;
+        }
+
+        /** Count as a sleeper first so a signaller knows to wake; the futex rechecks the count itself. */
+        atomicFetchAdd32(&words[1], 1);
+        futexWait(&words[0], 0);
+        atomicFetchSub32(&words[1], 1);
+        count = atomicLoad32(&words[0]);
+    }
+}
+
+/**
+ * On x86-64 a switch only saves what the ABI says a call preserves, on the
+ * stack being left, and keeps the stack pointer; swapcontext also saves the
+ * signal mask, which costs two syscalls per switch. Sanitizer builds keep
+ * ucontext, since the sanitizers follow swapcontext but not a hand-rolled switch.
+ */
+#if defined(__x86_64__) && !defined(__SANITIZE_ADDRESS__) && !defined(__SANITIZE_THREAD__)
+#define LINUX_FIBER_REGISTER_SWITCH 1
+#else
+#define LINUX_FIBER_REGISTER_SWITCH 0
+#endif
+
+typedef struct LinuxFiber {
+#if LINUX_FIBER_REGISTER_SWITCH
+    /** Top of the saved registers on this fiber's stack while it is not running. */
+    void *stackPointer;
+#else
+    ucontext_t context;
+#endif
+    PFN_platformFiberStart start;
+    void *argument;
+
+    /** The whole mapping, guard page included; 0 for a converted thread. */
+    void *mapping;
+    u64 mappingSize;
+} LinuxFiber;
+
+static void fiberRun(LinuxFiber *fiber) {
+    fiber->start(fiber->argument);
+
+    ENGINE_FATAL("A fiber returned from its start function.")
+    abort();
+}
+
+#if LINUX_FIBER_REGISTER_SWITCH
+
+/**
+ * linuxFiberSwitch(&from->stackPointer, to->stackPointer): pushes rbp, rbx,
+ * r12-r15 and the SSE and x87 control words, parks the stack pointer in from,
+ * then pops the same from to's stack and returns into it.
+ */
+void linuxFiberSwitch(void **fromStackPointer, void *toStackPointer);
+
+/** Where a new fiber's first switch returns to: calls r13(r12), i.e. fiberRun(fiber), on an aligned stack. */
+void linuxFiberStart(void);
+
+__asm__(
+    ".text\n"
+    ".globl linuxFiberSwitch\n"
+    ".hidden linuxFiberSwitch\n"
+    ".type linuxFiberSwitch, @function\n"
+    "linuxFiberSwitch:\n"
+    "    pushq %rbp\n"
+    "    pushq %rbx\n"
+    "    pushq %r12\n"
+    "    pushq %r13\n"
+    "    pushq %r14\n"
+    "    pushq %r15\n"
+    "    subq $8, %rsp\n"
+    "    stmxcsr (%rsp)\n"
+    "    fnstcw 4(%rsp)\n"
+    "    movq %rsp, (%rdi)\n"
+    "    movq %rsi, %rsp\n"
+    "    ldmxcsr (%rsp)\n"
+    "    fldcw 4(%rsp)\n"
+    "    addq $8, %rsp\n"
+    "    popq %r15\n"
+    "    popq %r14\n"
+    "    popq %r13\n"
+    "    popq %r12\n"
+    "    popq %rbx\n"
+    "    popq %rbp\n"
+    "    ret\n"
+    ".size linuxFiberSwitch, .-linuxFiberSwitch\n"
+    ".globl linuxFiberStart\n"
+    ".hidden linuxFiberStart\n"
+    ".type linuxFiberStart, @function\n"
+    "linuxFiberStart:\n"
+    "    movq %r12, %rdi\n"
+    "    call *%r13\n"
+    "    ud2\n"
+    ".size linuxFiberStart, .-linuxFiberStart\n"
+);
+
+/** Lays out the frame linuxFiberSwitch pops, so the first switch lands in linuxFiberStart. */
+static void prepareFiberStack(LinuxFiber *fiber, u8 *stackTop) {
+    /** After the return into linuxFiberStart the stack is 16-byte aligned, ready for its call. */
+    u64 *frame = (u64*)(((u64)stackTop & ~15ULL) - 16);
+    *--frame = (u64)linuxFiberStart;
+    *--frame = 0;               /* rbp */
+    *--frame = 0;               /* rbx */
+    *--frame = (u64)fiber;      /* r12 */
+    *--frame = (u64)fiberRun;   /* r13 */
+    *--frame = 0;               /* r14 */
+    *--frame = 0;               /* r15 */
+
+    /** Default MXCSR and x87 control word. */
+    *--frame = 0x1F80ULL | (0x037FULL << 32);
+    fiber->stackPointer = frame;
+}
+
+#else
+
+/** makecontext only passes ints, so the fiber pointer arrives in two halves. */
+static void fiberTrampoline(unsigned int low, unsigned int high) {
+    fiberRun((LinuxFiber*)(((u64)high << 32) | (u64)low));
+}
+
+#endif
+
+b8 platformFiberCreate(u64 stackSize, PFN_platformFiberStart start, void *argument, PlatformFiber *outFiber) {
+    if (!start || !outFiber) {
+        return false;
+    }
+
+    LinuxFiber *fiber = malloc(sizeof(LinuxFiber));
+    if (!fiber) {
+        return false;
+    }
+
+    u64 pageSize = (u64)sysconf(_SC_PAGESIZE);
+    stackSize = (stackSize + pageSize - 1) & ~(pageSize - 1);
+    fiber->mappingSize = stackSize + pageSize;
+    fiber->mapping = mmap(0, fiber->mappingSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (fiber->mapping == MAP_FAILED) {
+        ENGINE_ERROR("platformFiberCreate - failed to map a %lluB stack.", stackSize)
+        free(fiber);
+        return false;
+    }
+
+    /** Stacks grow down, so the guard page is the lowest one. */
+    mprotect(fiber->mapping, pageSize, PROT_NONE);
+
+    fiber->start = start;
+    fiber->argument = argument;
+#if LINUX_FIBER_REGISTER_SWITCH
+    prepareFiberStack(fiber, (u8*)fiber->mapping + fiber->mappingSize);
+#else
+    getcontext(&fiber->context);
+    fiber->context.uc_stack.ss_sp = (u8*)fiber->mapping + pageSize;
+    fiber->context.uc_stack.ss_size = stackSize;
+    fiber->context.uc_link = 0;
+    makecontext(&fiber->context, (void (*)(void))fiberTrampoline, 2,
+        (unsigned int)(u64)fiber, (unsigned int)((u64)fiber >> 32));
+#endif
+
+    outFiber->internalData = fiber;
+    return true;
+}
+
+void platformFiberDestroy(PlatformFiber *fiber) {
+    if (fiber && fiber->internalData) {
+        LinuxFiber *linuxFiber = fiber->internalData;
+        if (linuxFiber->mapping) {
+            munmap(linuxFiber->mapping, linuxFiber->mappingSize);
+        }
+
+        free(linuxFiber);
+        fiber->internalData = 0;
+    }
+}
+
+b8 platformFiberConvertThread(PlatformFiber *outFiber) {
+    LinuxFiber *fiber = calloc(1, sizeof(LinuxFiber));
+    if (!fiber) {
+        return false;
+    }
+
+    /** Filled in by the first switch away from this thread. */
+    outFiber->internalData = fiber;
+    return true;
+}
+
+void platformFiberRevertThread(PlatformFiber *fiber) {
+    platformFiberDestroy(fiber);
+}
+
+void platformFiberSwitch(PlatformFiber *from, PlatformFiber *to) {
+#if LINUX_FIBER_REGISTER_SWITCH
+    linuxFiberSwitch(&((LinuxFiber*)from->internalData)->stackPointer, ((LinuxFiber*)to->internalData)->stackPointer);
+#else
+    swapcontext(&((LinuxFiber*)from->internalData)->context, &((LinuxFiber*)to->internalData)->context);
+#endif
+}
+
 void platformGetRequiredExtensionNames(const char*** namesDynamicArray) {
     dynamicArrayPush(*namesDynamicArray, &"VK_KHR_xcb_surface")
 }
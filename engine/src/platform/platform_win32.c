@@ -12,6 +12,7 @@
 #include <Windows.h>
 #include <windowsx.h>
 #include <stdlib.h>
+#include <malloc.h>
 
 /** For surface creation. */
 #include <vulkan/vulkan.h>
@@ -156,13 +157,44 @@ b8 platformPumpMessages() {
 }
 
 void* platformAllocate(u64 size, b8 aligned) {
+    if (aligned) {
+        return _aligned_malloc(size, PLATFORM_ALLOCATION_ALIGNMENT);
+    }
+
     return malloc(size);
 }
 
 void platformFree(void* block, b8 aligned) {
+    if (aligned) {
+        _aligned_free(block);
+        return;
+    }
+
     free(block);
 }
 
+u64 platformGetPageSize() {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (u64)info.dwPageSize;
+}
+
+void* platformReserveMemory(u64 size) {
+    return VirtualAlloc(0, size, MEM_RESERVE, PAGE_NOACCESS);
+}
+
+b8 platformCommitMemory(void* block, u64 size) {
+    return VirtualAlloc(block, size, MEM_COMMIT, PAGE_READWRITE) != 0;
+}
+
+void platformDecommitMemory(void* block, u64 size) {
+    VirtualFree(block, size, MEM_DECOMMIT);
+}
+
+void platformReleaseMemory(void* block, u64 size) {
+    VirtualFree(block, 0, MEM_RELEASE);
+}
+
 void* platformZeroMemory(void* block, u64 size) {
     return memset(block, 0, size);
 }
@@ -171,6 +203,10 @@ void* platformCopyMemory(void* dest, const void* source, u64 size) {
     return memcpy(dest, source, size);
 }
 
+void* platformMoveMemory(void* dest, const void* source, u64 size) {
+    return memmove(dest, source, size);
+}
+
 void* platformSetMemory(void* dest, i32 value, u64 size) {
     return memset(dest, value, size);
 }
@@ -214,6 +250,211 @@ void platformSleep(u64 ms) {
     Sleep(ms);
 }
 
+u32 platformGetProcessorCount() {
+    SYSTEM_INFO systemInfo;
+    GetSystemInfo(&systemInfo);
+    return systemInfo.dwNumberOfProcessors > 0 ? systemInfo.dwNumberOfProcessors : 1;
+}
+
+typedef struct ThreadStart {
+    PFN_platformThreadStart start;
+    void *argument;
+} ThreadStart;
+
+static DWORD WINAPI threadTrampoline(LPVOID argument) {
+    ThreadStart threadStart = *(ThreadStart*)argument;
+    free(argument);
+    return threadStart.start(threadStart.argument);
+}
+
+b8 platformThreadCreate(PFN_platformThreadStart start, void *argument, PlatformThread *outThread) {
+    if (!start || !outThread) {
+        return false;
+    }
+
+    /** Freed by the new thread once it has read it. */
+    ThreadStart *threadStart = malloc(sizeof(ThreadStart));
+    if (!threadStart) {
+        return false;
+    }
+
+    threadStart->start = start;
+    threadStart->argument = argument;
+
+    HANDLE thread = CreateThread(0, 0, threadTrampoline, threadStart, 0, 0);
+    if (!thread) {
+        ENGINE_ERROR("CreateThread failed.")
+        free(threadStart);
+        return false;
+    }
+
+    outThread->handle = (u64)thread;
+    return true;
+}
+
+void platformThreadJoin(PlatformThread *thread) {
+    if (thread && thread->handle) {
+        WaitForSingleObject((HANDLE)thread->handle, INFINITE);
+        CloseHandle((HANDLE)thread->handle);
+        thread->handle = 0;
+    }
+}
+
+PlatformThread platformThreadGetCurrent() {
+    PlatformThread thread;
+    thread.handle = (u64)GetCurrentThread();
+    return thread;
+}
+
+typedef HRESULT (WINAPI *PFN_SetThreadDescription)(HANDLE thread, PCWSTR description);
+
+void platformThreadSetName(PlatformThread *thread, const char *name) {
+    /** Only on Windows 10 1607 and later, so it is looked up rather than linked. */
+    PFN_SetThreadDescription setThreadDescription = (PFN_SetThreadDescription)GetProcAddress(
+        GetModuleHandleA("kernel32.dll"), "SetThreadDescription");
+    if (!setThreadDescription) {
+        return;
+    }
+
+    wchar_t wideName[64];
+    if (MultiByteToWideChar(CP_UTF8, 0, name, -1, wideName, 64)) {
+        setThreadDescription((HANDLE)thread->handle, wideName);
+    }
+}
+
+b8 platformThreadSetAffinity(PlatformThread *thread, u64 processorMask) {
+    return SetThreadAffinityMask((HANDLE)thread->handle, (DWORD_PTR)processorMask) != 0;
+}
+
+void platformThreadYield() {
+    SwitchToThread();
+}
+
+/** SRWLOCK and CONDITION_VARIABLE are one pointer each and zero when initialized, like internalData. */
+void platformMutexLock(PlatformMutex *mutex) {
+    AcquireSRWLockExclusive((PSRWLOCK)&mutex->internalData);
+}
+
+b8 platformMutexTryLock(PlatformMutex *mutex) {
+    return TryAcquireSRWLockExclusive((PSRWLOCK)&mutex->internalData) != 0;
+}
+
+void platformMutexUnlock(PlatformMutex *mutex) {
+    ReleaseSRWLockExclusive((PSRWLOCK)&mutex->internalData);
+}
+
+void platformConditionVariableWait(PlatformConditionVariable *condition, PlatformMutex *mutex) {
+    SleepConditionVariableSRW((PCONDITION_VARIABLE)&condition->internalData,
+        (PSRWLOCK)&mutex->internalData, INFINITE, 0);
+}
+
+void platformConditionVariableSignal(PlatformConditionVariable *condition) {
+    WakeConditionVariable((PCONDITION_VARIABLE)&condition->internalData);
+}
+
+void platformConditionVariableBroadcast(PlatformConditionVariable *condition) {
+    WakeAllConditionVariable((PCONDITION_VARIABLE)&condition->internalData);
+}
+
+b8 platformSemaphoreCreate(u32 initialCount, PlatformSemaphore *outSemaphore) {
+    outSemaphore->internalData = CreateSemaphoreA(0, initialCount, 0x7fffffff, 0);
+    return outSemaphore->internalData != 0;
+}
+
+void platformSemaphoreDestroy(PlatformSemaphore *semaphore) {
+    if (semaphore && semaphore->internalData) {
+        CloseHandle(semaphore->internalData);
+        semaphore->internalData = 0;
+    }
+}
+
+void platformSemaphoreSignal(PlatformSemaphore *semaphore, u32 count) {
+    if (count) {
+        ReleaseSemaphore(semaphore->internalData, count, 0);
+    }
+}
+
+void platformSemaphoreWait(PlatformSemaphore *semaphore) {
+    WaitForSingleObject(semaphore->internalData, INFINITE);
+}
+
+typedef struct Win32Fiber {
+    LPVOID handle;
+    PFN_platformFiberStart start;
+    void *argument;
+} Win32Fiber;
+
+static VOID CALLBACK fiberTrampoline(LPVOID argument) {
+    Win32Fiber *fiber = argument;
+    fiber->start(fiber->argument);
+
+    ENGINE_FATAL("A fiber returned from its start function.")
+    ExitThread(1);
+}
+
+b8 platformFiberCreate(u64 stackSize, PFN_platformFiberStart start, void *argument, PlatformFiber *outFiber) {
+    if (!start || !outFiber) {
+        return false;
+    }
+
+    Win32Fiber *fiber = malloc(sizeof(Win32Fiber));
+    if (!fiber) {
+        return false;
+    }
+
+    /** Windows reserves fiber stacks with a guard page of its own. */
+    fiber->start = start;
+    fiber->argument = argument;
+    fiber->handle = CreateFiberEx(0, (SIZE_T)stackSize, FIBER_FLAG_FLOAT_SWITCH, fiberTrampoline, fiber);
+    if (!fiber->handle) {
+        ENGINE_ERROR("CreateFiberEx failed.")
+        free(fiber);
+        return false;
+    }
+
+    outFiber->internalData = fiber;
+    return true;
+}
+
+void platformFiberDestroy(PlatformFiber *fiber) {
+    if (fiber && fiber->internalData) {
+        Win32Fiber *win32Fiber = fiber->internalData;
+        DeleteFiber(win32Fiber->handle);
+        free(win32Fiber);
+        fiber->internalData = 0;
+    }
+}
+
+b8 platformFiberConvertThread(PlatformFiber *outFiber) {
+    Win32Fiber *fiber = calloc(1, sizeof(Win32Fiber));
+    if (!fiber) {
+        return false;
+    }
+
+    fiber->handle = ConvertThreadToFiberEx(0, FIBER_FLAG_FLOAT_SWITCH);
+    if (!fiber->handle) {
+        ENGINE_ERROR("ConvertThreadToFiberEx failed.")
+        free(fiber);
+        return false;
+    }
+
+    outFiber->internalData = fiber;
+    return true;
+}
+
+void platformFiberRevertThread(PlatformFiber *fiber) {
+    if (fiber && fiber->internalData) {
+        ConvertFiberToThread();
+        free(fiber->internalData);
+        fiber->internalData = 0;
+    }
+}
+
+void platformFiberSwitch(PlatformFiber *from, PlatformFiber *to) {
+    (void)from;
+    SwitchToFiber(((Win32Fiber*)to->internalData)->handle);
+}
+
 void platformGetRequiredExtensionNames(const char*** namesDynamicArray) {
     dynamicArrayPush(*namesDynamicArray, &"VK_KHR_win32_surface")
 }
@@ -204,6 +204,17 @@ b8 vulkanMaterialShaderCreate(VulkanContext *context, VulkanMaterialShader *outS
         return false;
     }
 
+    /** Released instance ids are handed out again, lowest first. */
+    u64 instanceIdRequirement = 0;
+    indexAllocatorCreate(VULKAN_MAX_MATERIAL_COUNT, &instanceIdRequirement, 0, 0);
+    if (instanceIdRequirement > sizeof(outShader->instanceIdWords)) {
+        ENGINE_ERROR("Material shader instance id storage is too small.")
+        return false;
+    }
+
+    indexAllocatorCreate(VULKAN_MAX_MATERIAL_COUNT, &instanceIdRequirement, outShader->instanceIdWords,
+        &outShader->instanceIds);
+
     return true;
 }
 
@@ -397,8 +408,11 @@ void vulkanMaterialShaderUpdateObject(VulkanContext *context,
 b8 vulkanMaterialShaderAcquireResources(VulkanContext *context,
     struct VulkanMaterialShader *shader, Material *material) {
 
-    material->internalId = shader->objectUniformBufferIndex;
-    shader->objectUniformBufferIndex++;
+    material->internalId = indexAllocatorAcquire(&shader->instanceIds);
+    if (material->internalId == INVALID_ID) {
+        ENGINE_ERROR("Material shader is out of instance ids (%u).", VULKAN_MAX_MATERIAL_COUNT)
+        return false;
+    }
 
     VulkanMaterialShaderInstanceState *objectState = &shader->instanceStates[material->internalId];
     for (u32 i = 0; i < VULKAN_MATERIAL_SHADER_DESCRIPTOR_COUNT; ++i) {
@@ -422,6 +436,8 @@ b8 vulkanMaterialShaderAcquireResources(VulkanContext *context,
     VkResult result = vkAllocateDescriptorSets(context->device.logicalDevice, &allocateInfo, objectState->descriptorSets);
     if (result != VK_SUCCESS) {
         ENGINE_ERROR("Error allocating descriptor sets in shader!")
+        indexAllocatorRelease(&shader->instanceIds, material->internalId);
+        material->internalId = INVALID_ID;
         return false;
     }
 
@@ -446,5 +462,6 @@ void vulkanMaterialShaderReleaseResources(VulkanContext *context,
         }
     }
 
+    indexAllocatorRelease(&shader->instanceIds, material->internalId);
     material->internalId = INVALID_ID;
 }
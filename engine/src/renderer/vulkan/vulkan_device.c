@@ -96,7 +96,7 @@ b8 vulkanDeviceCreate(VulkanContext* context) {
     VK_CHECK(vkEnumerateDeviceExtensionProperties(context->device.physicalDevice, 0, &availableExtensionCount, 0))
 
     if (availableExtensionCount != 0) {
-        availableExtensions = engineAllocate(sizeof(VkExtensionProperties) * availableExtensionCount, MEMORY_TAG_RENDERER);
+        availableExtensions = engineAllocateUninitialized(sizeof(VkExtensionProperties) * availableExtensionCount, MEMORY_TAG_RENDERER);
         VK_CHECK(vkEnumerateDeviceExtensionProperties(context->device.physicalDevice, 0, &availableExtensionCount, availableExtensions))
 
         for (u32 i = 0; i < availableExtensionCount; ++i) {
@@ -542,7 +542,7 @@ b8 physicalDeviceMeetsRequirements(
                 &available_extension_count,
                 0));
             if (available_extension_count != 0) {
-                available_extensions = engineAllocate(sizeof(VkExtensionProperties) * available_extension_count, MEMORY_TAG_RENDERER);
+                available_extensions = engineAllocateUninitialized(sizeof(VkExtensionProperties) * available_extension_count, MEMORY_TAG_RENDERER);
                 VK_CHECK(vkEnumerateDeviceExtensionProperties(
                     device,
                     0,
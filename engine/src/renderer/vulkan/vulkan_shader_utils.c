@@ -3,6 +3,7 @@
 #include "../../engine_memory/engine_string.h"
 #include "../../core/logger.h"
 #include "../../engine_memory/engine_memory.h"
+#include "../../engine_memory/stack_allocator.h"
 
 #include "../../platform/filesystem.h"
 
@@ -29,26 +30,56 @@ b8 createShaderModule(
         return false;
     }
 
-    /** Read the entire file as binary. */
+    /**
+     * The SPIR-V is only needed until the module exists, so it goes on the
+     * calling thread's scratch stack when there is one with room, and on the
+     * heap otherwise.
+     */
+    StackAllocator *scratch = stackAllocatorGetScratch();
+    StackAllocatorMarker marker = scratch ? stackAllocatorGetMarker(scratch) : 0;
+
     u64 size = 0;
+    u64 bytesRead = 0;
     u8* fileBuffer = 0;
-    if (!filesystemReadAllBytes(&handle, &fileBuffer, &size)) {
-        ENGINE_ERROR("Unable to binary read shader module: %s.", fileName);
-        return false;
+    b8 fileOnHeap = false;
+    if (filesystemSize(&handle, &size) && size) {
+        if (scratch && scratch->totalSize - scratch->top >= size + sizeof(u32)) {
+            fileBuffer = stackAllocatorAllocate(scratch, sizeof(u8) * size, sizeof(u32));
+        } else {
+            fileBuffer = engineAllocateUninitialized(sizeof(u8) * size, MEMORY_TAG_RENDERER);
+            fileOnHeap = fileBuffer != 0;
+        }
     }
 
-    shaderStages[stageIndex].createInfo.codeSize = size;
-    shaderStages[stageIndex].createInfo.pCode = (u32*)fileBuffer;
+    b8 fileRead = fileBuffer && filesystemRead(&handle, size, fileBuffer, &bytesRead);
 
     /** Close the file. */
     filesystemClose(&handle);
 
-    VK_CHECK(vkCreateShaderModule(
-        context->device.logicalDevice,
-        &shaderStages[stageIndex].createInfo,
-        context->allocator,
-        &shaderStages[stageIndex].handle)
-    );
+    if (fileRead) {
+        shaderStages[stageIndex].createInfo.codeSize = size;
+        shaderStages[stageIndex].createInfo.pCode = (u32*)fileBuffer;
+
+        VK_CHECK(vkCreateShaderModule(
+            context->device.logicalDevice,
+            &shaderStages[stageIndex].createInfo,
+            context->allocator,
+            &shaderStages[stageIndex].handle)
+        );
+    }
+
+    if (fileOnHeap) {
+        engineFree(fileBuffer, sizeof(u8) * size, MEMORY_TAG_RENDERER);
+    }
+
+    if (scratch) {
+        stackAllocatorFreeToMarker(scratch, marker);
+    }
+
+    if (!fileRead) {
+        ENGINE_ERROR("Unable to binary read shader module: %s.", fileName);
+        return false;
+    }
 
     // Shader stage info
     engineZeroMemory(&shaderStages[stageIndex].shaderStageCreateInfo, sizeof(VkPipelineShaderStageCreateInfo));
@@ -57,10 +88,5 @@ b8 createShaderModule(
     shaderStages[stageIndex].shaderStageCreateInfo.module = shaderStages[stageIndex].handle;
     shaderStages[stageIndex].shaderStageCreateInfo.pName = "main";
 
-    if (fileBuffer) {
-        engineFree(fileBuffer, sizeof(u8) * size, MEMORY_TAG_STRING);
-        fileBuffer = 0;
-    }
-
     return true;
 }
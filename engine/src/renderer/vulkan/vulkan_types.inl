@@ -3,6 +3,7 @@
 
 #include "../../defines.h"
 #include "../../core/asserts.h"
+#include "../../containers/bitset.h"
 
 #include "../renderer_types.inl"
 
@@ -181,7 +182,11 @@ typedef struct VulkanMaterialShader {
 
     VulkanBuffer objectUniformBuffer;
 
-    u32 objectUniformBufferIndex;
+    /** Hands out material instance ids, which index instanceStates and the object buffer. */
+    IndexAllocator instanceIds;
+
+    /** Leaf words followed by the summary word for instanceIds. */
+    u64 instanceIdWords[(VULKAN_MAX_MATERIAL_COUNT / 64) + 1];
 
     TextureUse samplerUses[VULKAN_MATERIAL_SHADER_SAMPLER_COUNT];
 
@@ -2,6 +2,7 @@
 #define __ENGINE_RESOURCE_TYPES_H__
 
 #include "../engine_math/math_types.h"
+#include "../systems/string_intern_system.h"
 
 #define TEXTURE_NAME_MAX_LENGTH 512
 
@@ -14,7 +15,8 @@ typedef struct Texture {
     b8 hasTransparency;
     u32 generation;
 
-    char name[TEXTURE_NAME_MAX_LENGTH];
+    /** Interned; see stringInternGet. */
+    StringId name;
 
     void *internalData;
 } Texture;
@@ -34,7 +36,9 @@ typedef struct Material {
     u32 id;
     u32 generation;
     u32 internalId;
-    char name[MATERIAL_NAME_MAX_LENGTH];
+
+    /** Interned; see stringInternGet. */
+    StringId name;
     vec4 diffuseColour;
     TextureMap diffuseMap;
 } Material;
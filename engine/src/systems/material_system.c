@@ -3,6 +3,7 @@
 #include "../core/logger.h"
 #include "../engine_memory/engine_string.h"
 #include "../containers/hashtable.h"
+#include "../containers/slot_map.h"
 #include "../engine_math/engine_math.h"
 #include "../renderer/renderer_frontend.h"
 
@@ -13,13 +14,15 @@
 typedef struct MaterialSystemState {
     MaterialSystemConfig config;
     Material defaultMaterial;
-    Material *registeredMaterials;
+    SlotMap registeredMaterials;
+
+    /** Material lookups, keyed by the interned name. */
     Hashtable registeredMaterialTable;
 } MaterialSystemState;
 
 typedef struct MaterialReference {
     u64 referenceCount;
-    u32 handle;
+    SlotMapHandle handle;
     b8 autoRelease;
 } MaterialReference;
 
@@ -37,12 +40,14 @@ b8 materialSystemInitialize(u64* memoryRequirement, void* state, MaterialSystemC
     }
 
     /**
-     * Block of memory will contain state structure, then block for array,
+     * Block of memory will contain state structure, then block for slot map,
      * then block for hashtable.
      */
     u64 structRequirement = sizeof(MaterialSystemState);
-    u64 arrayRequirement = sizeof(Material) * config.maxMaterialCount;
-    u64 hashtableRequirement = sizeof(MaterialReference) * config.maxMaterialCount;
+    u64 arrayRequirement = 0;
+    slotMapCreate(sizeof(Material), config.maxMaterialCount, &arrayRequirement, 0, 0);
+    u64 hashtableRequirement = 0;
+    hashtableCreateU64(sizeof(MaterialReference), config.maxMaterialCount, &hashtableRequirement, 0, 0);
     *memoryRequirement = structRequirement + arrayRequirement + hashtableRequirement;
 
     if (!state) {
@@ -52,30 +57,31 @@ b8 materialSystemInitialize(u64* memoryRequirement, void* state, MaterialSystemC
     statePtr = state;
     statePtr->config = config;
 
-    /** The array is after the state. Already allocated, so just set the pointer. */
+    /** The slot map is after the state. */
     void *arrayBlock = state + structRequirement;
-    statePtr->registeredMaterials = arrayBlock;
+    slotMapCreate(sizeof(Material), config.maxMaterialCount, &arrayRequirement, arrayBlock,
+                  &statePtr->registeredMaterials);
 
-    /** Hashtable block is after array. */
+    /** Hashtable block is after the slot map. */
     void *hashtableBlock = arrayBlock + arrayRequirement;
 
     /** Create a hashtable for material lookups. */
-    hashtableCreate(sizeof(MaterialReference), config.maxMaterialCount, hashtableBlock,
-                    false, &statePtr->registeredMaterialTable);
+    hashtableCreateU64(sizeof(MaterialReference), config.maxMaterialCount, &hashtableRequirement,
+                       hashtableBlock, &statePtr->registeredMaterialTable);
 
     /** Fill the hashtable with invalid references to use as a default. */
     MaterialReference invalidRef;
     invalidRef.autoRelease = false;
-    invalidRef.handle = INVALID_ID;
+    invalidRef.handle = slotMapInvalidHandle();
     invalidRef.referenceCount = 0;
     hashtableFill(&statePtr->registeredMaterialTable, &invalidRef);
 
-    u32 count = statePtr->config.maxMaterialCount;
-    for (u32 i = 0; i < count; ++i) {
-        statePtr->registeredMaterials[i].id = INVALID_ID;
-        statePtr->registeredMaterials[i].generation = INVALID_ID;
-        statePtr->registeredMaterials[i].internalId = INVALID_ID;
-    }
+    /** Materials keep their generation across reuse of a slot, so start them all invalid. */
+    Material invalidMaterial = {0};
+    invalidMaterial.id = INVALID_ID;
+    invalidMaterial.generation = INVALID_ID;
+    invalidMaterial.internalId = INVALID_ID;
+    slotMapFill(&statePtr->registeredMaterials, &invalidMaterial);
 
     if (!createDefaultMaterial(statePtr)) {
         ENGINE_FATAL("Failed to create default material. Application cannot continue.")
@@ -88,11 +94,10 @@ b8 materialSystemInitialize(u64* memoryRequirement, void* state, MaterialSystemC
 void materialSystemShutdown(void *state) {
     MaterialSystemState *materialSystemState = (MaterialSystemState*)state;
     if (materialSystemState) {
-        u32 count = materialSystemState->config.maxMaterialCount;
-        for (u32 i = 0; i < count; ++i) {
-            if (materialSystemState->registeredMaterials[i].id != INVALID_ID) {
-                destroyMaterial(&materialSystemState->registeredMaterials[i]);
-            }
+        /** Only live materials are visited. */
+        SlotMap *materials = &materialSystemState->registeredMaterials;
+        for (u32 i = 0; i < materials->count; ++i) {
+            destroyMaterial(slotMapGetLive(materials, i, 0));
         }
 
         destroyMaterial(&materialSystemState->defaultMaterial);
@@ -118,28 +123,29 @@ Material *materialSystemAcquire(const char *name) {
 }
 
 Material *materialSystemAcquireFromConfig(MaterialConfig config) {
+    if (!statePtr) {
+        ENGINE_ERROR("materialSystemAcquireFromConfig called before material system initialization! "
+            "Null pointer returned.")
+        return 0;
+    }
+
+    /** IDs are case-sensitive, so the default name is matched on the string, in any case, before interning. */
     if (stringsEquali(config.name, DEFAULT_MATERIAL_NAME)) {
         return &statePtr->defaultMaterial;
     }
 
+    StringId nameId = stringIntern(config.name);
+
     MaterialReference ref;
-    if (statePtr && hashtableGet(&statePtr->registeredMaterialTable, config.name, &ref)) {
+    if (nameId != INVALID_ID && hashtableGetU64(&statePtr->registeredMaterialTable, nameId, &ref)) {
         if (ref.referenceCount == 0) {
             ref.autoRelease = config.autoRelease;
         }
         ref.referenceCount++;
-        if (ref.handle == INVALID_ID) {
-            u32 count = statePtr->config.maxMaterialCount;
-            Material *material = 0;
-            for (u32 i = 0; i < count; ++i) {
-                if (statePtr->registeredMaterials[i].id == INVALID_ID) {
-                    ref.handle = i;
-                    material = &statePtr->registeredMaterials[i];
-                    break;
-                }
-            }
-
-            if (!material || ref.handle == INVALID_ID) {
+        Material *material = slotMapGet(&statePtr->registeredMaterials, ref.handle);
+        if (!material) {
+            ref.handle = slotMapInsert(&statePtr->registeredMaterials, (void**)&material);
+            if (!material) {
                 ENGINE_FATAL("MaterialSystemAcquire - "
                     "Material system cannot hold anymore materials. "
                     "Adjust configuration to allow more.")
@@ -147,6 +153,7 @@ Material *materialSystemAcquireFromConfig(MaterialConfig config) {
             }
 
             if (!loadMaterial(config, material)) {
+                slotMapRemove(&statePtr->registeredMaterials, ref.handle);
                 ENGINE_ERROR("Failed to load material '%s'.", config.name)
                 return 0;
             }
@@ -157,7 +164,8 @@ Material *materialSystemAcquireFromConfig(MaterialConfig config) {
                 material->generation++;
             }
 
-            material->id = ref.handle;
+            material->id = ref.handle.index;
+            material->name = nameId;
             ENGINE_TRACE("Material '%s' does not yet exist. Created, and refCount is now %i",
                 config.name, ref.referenceCount)
         } else {
@@ -165,8 +173,8 @@ Material *materialSystemAcquireFromConfig(MaterialConfig config) {
                 config.name, ref.referenceCount)
         }
 
-        hashtableSet(&statePtr->registeredMaterialTable, config.name, &ref);
-        return &statePtr->registeredMaterials[ref.handle];
+        hashtableSetU64(&statePtr->registeredMaterialTable, nameId, &ref);
+        return material;
     }
 
     ENGINE_ERROR("material_system_acquire_from_config failed to acquire material '%s'. "
@@ -175,12 +183,15 @@ Material *materialSystemAcquireFromConfig(MaterialConfig config) {
 }
 
 void materialSystemRelease(const char *name) {
-    if (stringsEqualI(name, DEFAULT_MATERIAL_NAME)) {
+    if (stringsEquali(name, DEFAULT_MATERIAL_NAME)) {
         return;
     }
 
+    /** Names that were never interned were never acquired either. */
+    StringId nameId = stringInternFind(name);
+
     MaterialReference ref;
-    if (statePtr && hashtableGet(&statePtr->registeredMaterialTable, name, &ref)) {
+    if (statePtr && nameId != INVALID_ID && hashtableGetU64(&statePtr->registeredMaterialTable, nameId, &ref)) {
         if (ref.referenceCount == 0) {
             ENGINE_WARNING("Tried to release non-existent material: '%s'", name)
             return;
@@ -188,22 +199,21 @@ void materialSystemRelease(const char *name) {
 
         ref.referenceCount--;
         if (ref.referenceCount == 0 && ref.autoRelease) {
-            Material *m = &statePtr->registeredMaterials[ref.handle];
-
-            destroyMaterial(m);
+            Material *m = slotMapGet(&statePtr->registeredMaterials, ref.handle);
 
-            ref.handle = INVALID_ID;
-            ref.autoRelease = false;
+            hashtableRemoveU64(&statePtr->registeredMaterialTable, nameId);
             ENGINE_TRACE("Released material '%s'., "
                 "Material unloaded because reference count=0 and auto_release=true.",
                 name)
+
+            destroyMaterial(m);
+            slotMapRemove(&statePtr->registeredMaterials, ref.handle);
         } else {
+            hashtableSetU64(&statePtr->registeredMaterialTable, nameId, &ref);
             ENGINE_TRACE("Released material '%s', "
                 "now has a reference count of '%i' (auto_release=%s).",
                 name, ref.referenceCount, ref.autoRelease ? "true" : "false")
         }
-
-        hashtableSet(&statePtr->registeredMaterialTable, name, &ref);
     } else {
         ENGINE_ERROR("material_system_release failed to release material '%s'.", name)
     }
@@ -213,7 +223,7 @@ b8 createDefaultMaterial(MaterialSystemState *state) {
     engineZeroMemory(&state->defaultMaterial, sizeof(Material));
     state->defaultMaterial.id = INVALID_ID;
     state->defaultMaterial.generation = INVALID_ID;
-    stringNCopy(state->defaultMaterial.name, DEFAULT_MATERIAL_NAME, MATERIAL_NAME_MAX_LENGTH);
+    state->defaultMaterial.name = stringIntern(DEFAULT_MATERIAL_NAME);
     state->defaultMaterial.diffuseColour = vec4_one();
     state->defaultMaterial.diffuseMap.use = TEXTURE_USE_MAP_DIFFUSE;
     state->defaultMaterial.diffuseMap.texture = textureSystemGetDefaultTexture();
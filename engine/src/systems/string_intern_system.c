@@ -0,0 +1,206 @@
+#include "string_intern_system.h"
+
+#include "../core/logger.h"
+#include "../engine_memory/engine_memory.h"
+#include "../engine_memory/engine_string.h"
+#include "../engine_memory/virtual_arena.h"
+
+typedef struct StringInternEntry {
+    u64 hash;
+    const char *string;
+    u32 length;
+} StringInternEntry;
+
+typedef struct StringInternSystemState {
+    StringInternSystemConfig config;
+    u32 count;
+
+    /** Entry i is the string with ID i. */
+    StringInternEntry *entries;
+
+    /** Open-addressing slots holding ID + 1, 0 when empty; at most half full. */
+    u32 *slots;
+    u64 slotMask;
+
+    /** Backing store for the characters. Never moves, so entries can point into it. */
+    VirtualArena characters;
+} StringInternSystemState;
+
+static StringInternSystemState *statePtr = 0;
+
+/** FNV-1a with a final avalanche, as the hashtable uses. The length is written to outLength. */
+static u64 hashString(const char *str, u64 *outLength) {
+    u64 hash = 0xcbf29ce484222325ULL;
+
+    const u8 *us = (const u8*)str;
+    for (; *us; us++) {
+        hash ^= *us;
+        hash *= 0x100000001b3ULL;
+    }
+
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+
+    *outLength = (u64)(us - (const u8*)str);
+
+    return hash;
+}
+
+static u64 slotCountFor(u32 maxStringCount) {
+    u64 count = 16;
+    while (count < (u64)maxStringCount * 2) {
+        count <<= 1;
+    }
+
+    return count;
+}
+
+/** The slot holding str, or the empty slot where it belongs. */
+static u32 *findSlot(StringInternSystemState *state, const char *str, u64 hash, u64 length) {
+    u64 slot = hash & state->slotMask;
+    while (state->slots[slot]) {
+        StringInternEntry *entry = &state->entries[state->slots[slot] - 1];
+        if (entry->hash == hash && entry->length == length && stringsEqual(entry->string, str)) {
+            break;
+        }
+
+        slot = (slot + 1) & state->slotMask;
+    }
+
+    return &state->slots[slot];
+}
+
+b8 stringInternSystemInitialize(u64 *memoryRequirement, void *state, StringInternSystemConfig config) {
+    if (config.maxStringCount == 0 || config.maxCharacterBytes == 0) {
+        ENGINE_FATAL("stringInternSystemInitialize - config.maxStringCount and maxCharacterBytes must be > 0.")
+        return false;
+    }
+
+    /** Block of memory will contain state structure, then the entries, then the slots. */
+    u64 structRequirement = sizeof(StringInternSystemState);
+    u64 entriesRequirement = sizeof(StringInternEntry) * config.maxStringCount;
+    u64 slotCount = slotCountFor(config.maxStringCount);
+    *memoryRequirement = structRequirement + entriesRequirement + (sizeof(u32) * slotCount);
+
+    if (!state) {
+        return true;
+    }
+
+    engineZeroMemory(state, *memoryRequirement);
+    statePtr = state;
+    statePtr->config = config;
+    statePtr->entries = (StringInternEntry*)((u8*)state + structRequirement);
+    statePtr->slots = (u32*)((u8*)statePtr->entries + entriesRequirement);
+    statePtr->slotMask = slotCount - 1;
+
+    if (!virtualArenaCreate(config.maxCharacterBytes, &statePtr->characters)) {
+        ENGINE_FATAL("stringInternSystemInitialize - failed to reserve the character arena.")
+        statePtr = 0;
+        return false;
+    }
+
+    /** The empty string is always ID 0, so zeroed structs name nothing. */
+    if (stringIntern("") != STRING_ID_EMPTY) {
+        virtualArenaDestroy(&statePtr->characters);
+        statePtr = 0;
+        return false;
+    }
+
+    return true;
+}
+
+void stringInternSystemShutdown(void *state) {
+    if (statePtr) {
+        virtualArenaDestroy(&statePtr->characters);
+        statePtr->count = 0;
+    }
+
+    statePtr = 0;
+}
+
+StringId stringIntern(const char *str) {
+    if (!statePtr) {
+        ENGINE_ERROR("stringIntern called before the string intern system was initialized.")
+        return INVALID_ID;
+    }
+
+    if (!str) {
+        str = "";
+    }
+
+    u64 length = 0;
+    u64 hash = hashString(str, &length);
+    u32 *slot = findSlot(statePtr, str, hash, length);
+    if (*slot) {
+        return *slot - 1;
+    }
+
+    if (statePtr->count >= statePtr->config.maxStringCount || length >= INVALID_ID) {
+        ENGINE_ERROR("String intern table is full (%u strings); cannot add '%s'.",
+            statePtr->config.maxStringCount, str)
+        return INVALID_ID;
+    }
+
+    char *copy = virtualArenaAllocateAligned(&statePtr->characters, length + 1, 1);
+    if (!copy) {
+        ENGINE_ERROR("String intern arena is out of space; cannot add '%s'.", str)
+        return INVALID_ID;
+    }
+
+    /** The arena hands back zeroed memory, so the terminator is already there. */
+    engineCopyMemory(copy, str, length);
+
+    StringId id = statePtr->count++;
+    StringInternEntry *entry = &statePtr->entries[id];
+    entry->hash = hash;
+    entry->string = copy;
+    entry->length = (u32)length;
+    *slot = id + 1;
+
+    return id;
+}
+
+StringId stringInternFind(const char *str) {
+    if (!statePtr) {
+        return INVALID_ID;
+    }
+
+    if (!str) {
+        str = "";
+    }
+
+    u64 length = 0;
+    u64 hash = hashString(str, &length);
+    u32 *slot = findSlot(statePtr, str, hash, length);
+
+    return *slot ? *slot - 1 : INVALID_ID;
+}
+
+const char *stringInternGet(StringId id) {
+    if (!statePtr || id >= statePtr->count) {
+        return "";
+    }
+
+    return statePtr->entries[id].string;
+}
+
+u64 stringInternHash(StringId id) {
+    if (!statePtr || id >= statePtr->count) {
+        return 0;
+    }
+
+    return statePtr->entries[id].hash;
+}
+
+u32 stringInternLength(StringId id) {
+    if (!statePtr || id >= statePtr->count) {
+        return 0;
+    }
+
+    return statePtr->entries[id].length;
+}
+
+u32 stringInternCount() {
+    return statePtr ? statePtr->count : 0;
+}
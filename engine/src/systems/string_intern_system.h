@@ -0,0 +1,72 @@
+#ifndef __ENGINE_STRING_INTERN_SYSTEM_H__
+#define __ENGINE_STRING_INTERN_SYSTEM_H__
+
+#include "../defines.h"
+
+/**
+ * @brief A compact stand-in for an interned string. Equal strings always
+ * intern to the same ID, so comparing two IDs compares the strings.
+ */
+typedef u32 StringId;
+
+/** The ID of the empty string; what a zeroed StringId refers to. */
+#define STRING_ID_EMPTY 0
+
+typedef struct StringInternSystemConfig {
+    /** Most distinct strings that can be interned, the empty string included. */
+    u32 maxStringCount;
+
+    /** Address space reserved for the characters; pages are committed as strings arrive. */
+    u64 maxCharacterBytes;
+} StringInternSystemConfig;
+
+/**
+ * @brief Initializes the string intern table. Call twice; once with state = 0 to get
+ * required memory size, then a second time passing allocated memory to state.
+ * Interned strings are never released; the characters live in a virtual
+ * arena until shutdown.
+ *
+ * @param memoryRequirement A pointer to hold the required memory size.
+ * @param state 0 if just requesting memory requirement, otherwise allocated block of memory.
+ * @param config The intern table configuration.
+ * @return True on success; otherwise false.
+ */
+b8 stringInternSystemInitialize(u64 *memoryRequirement, void *state, StringInternSystemConfig config);
+void stringInternSystemShutdown(void *state);
+
+/**
+ * @brief Obtains the ID of a string, adding it to the table on first sight.
+ * Case-sensitive. Not thread-safe.
+ *
+ * @param str The string to intern. 0 is treated as the empty string.
+ * @return The ID; INVALID_ID if the table or its arena is full.
+ */
+ENGINE_API StringId stringIntern(const char *str);
+
+/**
+ * @brief Obtains the ID of a string only if it has already been interned.
+ *
+ * @param str The string to look up. 0 is treated as the empty string.
+ * @return The ID; INVALID_ID if the string has never been interned.
+ */
+ENGINE_API StringId stringInternFind(const char *str);
+
+/**
+ * @brief Obtains the characters of an interned string. They stay valid
+ * until the system shuts down.
+ *
+ * @param id The ID to look up.
+ * @return The string; the empty string for INVALID_ID or unknown IDs.
+ */
+ENGINE_API const char *stringInternGet(StringId id);
+
+/** @brief The hash computed when the string was interned; 0 for unknown IDs. */
+ENGINE_API u64 stringInternHash(StringId id);
+
+/** @brief The length of an interned string, not counting the terminator; 0 for unknown IDs. */
+ENGINE_API u32 stringInternLength(StringId id);
+
+/** @brief The number of strings interned so far, the empty string included. */
+ENGINE_API u32 stringInternCount();
+
+#endif
@@ -4,8 +4,11 @@
 
 #include "../engine_memory/engine_string.h"
 #include "../engine_memory/engine_memory.h"
+#include "../engine_memory/stack_allocator.h"
+#include "../platform/filesystem.h"
 
 #include "../containers/hashtable.h"
+#include "../containers/slot_map.h"
 
 #include "../renderer/renderer_frontend.h"
 
@@ -16,16 +19,16 @@ typedef struct TextureSystemState {
     TextureSystemConfig config;
     Texture defaultTexture;
 
-    /** Array of registered textures. */
-    Texture *registeredTextures;
+    /** Registered textures, addressed by the handles in the lookup table. */
+    SlotMap registeredTextures;
 
-    /** Hashtable for texture lookups. */
+    /** Texture lookups, keyed by the interned name. */
     Hashtable registeredTextureTable;
 } TextureSystemState;
 
 typedef struct TextureReference {
     u64 referenceCount;
-    u32 handle;
+    SlotMapHandle handle;
     b8 autoRelease;
 } TextureReference;
 
@@ -33,7 +36,7 @@ static TextureSystemState *statePtr = 0;
 
 b8 createDefaultTextures(TextureSystemState *state);
 void destroyDefaultTextures(TextureSystemState *state);
-b8 loadTexture(const char *textureName, Texture *texture);
+b8 loadTexture(StringId textureName, Texture *texture);
 void destroyTexture(Texture *texture);
 
 b8 textureSystemInitialize(u64 *memoryRequirement, void *state, TextureSystemConfig config) {
@@ -42,10 +45,12 @@ b8 textureSystemInitialize(u64 *memoryRequirement, void *state, TextureSystemCon
         return false;
     }
 
-    /** Block of memory will contain state structure, then block for array, then block for hashtable. */
+    /** Block of memory will contain state structure, then block for slot map, then block for hashtable. */
     u64 structRequirement = sizeof(TextureSystemState);
-    u64 arrayRequirement = sizeof(Texture) * config.maxTextureCount;
-    u64 hashtableRequirement = sizeof(TextureReference) * config.maxTextureCount;
+    u64 arrayRequirement = 0;
+    slotMapCreate(sizeof(Texture), config.maxTextureCount, &arrayRequirement, 0, 0);
+    u64 hashtableRequirement = 0;
+    hashtableCreateU64(sizeof(TextureReference), config.maxTextureCount, &hashtableRequirement, 0, 0);
 
     *memoryRequirement = structRequirement + arrayRequirement + hashtableRequirement;
 
@@ -57,24 +62,24 @@ b8 textureSystemInitialize(u64 *memoryRequirement, void *state, TextureSystemCon
     statePtr->config = config;
 
     void *arrayBlock = state + structRequirement;
-    statePtr->registeredTextures = arrayBlock;
+    slotMapCreate(sizeof(Texture), config.maxTextureCount, &arrayRequirement, arrayBlock,
+                  &statePtr->registeredTextures);
 
     void *hashtableBlock = arrayBlock + arrayRequirement;
 
-    hashtableCreate(sizeof(TextureReference), config.maxTextureCount, hashtableBlock,
-                    false, &statePtr->registeredTextureTable);
+    hashtableCreateU64(sizeof(TextureReference), config.maxTextureCount, &hashtableRequirement,
+                       hashtableBlock, &statePtr->registeredTextureTable);
 
     TextureReference invalidRef;
     invalidRef.autoRelease = false;
-    invalidRef.handle = INVALID_ID;
+    invalidRef.handle = slotMapInvalidHandle();
     invalidRef.referenceCount = 0;
     hashtableFill(&statePtr->registeredTextureTable, &invalidRef);
 
-    u32 count = statePtr->config.maxTextureCount;
-    for (u32 i = 0; i < count; ++i) {
-        statePtr->registeredTextures[i].id = INVALID_ID;
-        statePtr->registeredTextures[i].generation = INVALID_ID;
-    }
+    Texture invalidTexture = {0};
+    invalidTexture.id = INVALID_ID;
+    invalidTexture.generation = INVALID_ID;
+    slotMapFill(&statePtr->registeredTextures, &invalidTexture);
 
     createDefaultTextures(statePtr);
 
@@ -83,8 +88,9 @@ b8 textureSystemInitialize(u64 *memoryRequirement, void *state, TextureSystemCon
 
 void textureSystemShutdown(void *state) {
     if (statePtr) {
-        for (u32 i = 0; i < statePtr->config.maxTextureCount; ++i) {
-            Texture *texture = &statePtr->registeredTextures[i];
+        /** Only live textures are visited. */
+        for (u32 i = 0; i < statePtr->registeredTextures.count; ++i) {
+            Texture *texture = slotMapGetLive(&statePtr->registeredTextures, i, 0);
             if (texture->generation != INVALID_ID) {
                 rendererDestroyTexture(texture);
             }
@@ -97,43 +103,44 @@ void textureSystemShutdown(void *state) {
 }
 
 Texture *textureSystemAcquire(const char *name, b8 autoRelease) {
+    if (!statePtr) {
+        ENGINE_ERROR("textureSystemAcquire called before texture system initialization! "
+            "Null pointer returned.")
+        return 0;
+    }
+
+    /** IDs are case-sensitive, so the default name is matched on the string, in any case, before interning. */
     if (stringsEquali(name, DEFAULT_TEXTURE_NAME)) {
         ENGINE_WARNING("textureSystemAcquire called for default texture. "
             "Use textureSystemGetDefaultTexture for texture 'default'.")
         return &statePtr->defaultTexture;
     }
 
+    StringId nameId = stringIntern(name);
+
     TextureReference ref;
-    if (statePtr && hashtableGet(&statePtr->registeredTextureTable, name, &ref)) {
+    if (nameId != INVALID_ID && hashtableGetU64(&statePtr->registeredTextureTable, nameId, &ref)) {
         if (ref.referenceCount == 0) {
             ref.autoRelease = autoRelease;
         }
         ref.referenceCount++;
 
-        if (ref.handle == INVALID_ID) {
-            u32 count = statePtr->config.maxTextureCount;
-            Texture *texture = 0;
-
-            for (u32 i = 0; i < count; ++i) {
-                if (statePtr->registeredTextures[i].id == INVALID_ID) {
-                    ref.handle = i;
-                    texture = &statePtr->registeredTextures[i];
-                    break;
-                }
-            }
-
-            if (!texture || ref.handle == INVALID_ID) {
+        Texture *texture = slotMapGet(&statePtr->registeredTextures, ref.handle);
+        if (!texture) {
+            ref.handle = slotMapInsert(&statePtr->registeredTextures, (void**)&texture);
+            if (!texture) {
                 ENGINE_FATAL("textureSystemAcquire - Texture system cannot hold anymore textures. "
                     "Adjust configuration to allow more.")
                 return 0;
             }
 
-            if (!loadTexture(name, texture)) {
+            if (!loadTexture(nameId, texture)) {
+                slotMapRemove(&statePtr->registeredTextures, ref.handle);
                 ENGINE_ERROR("Failed to load texture '%s'.", name)
                 return 0;
             }
 
-            texture->id = ref.handle;
+            texture->id = ref.handle.index;
             ENGINE_TRACE("Texture '%s' does not yet exist. Created, and refCount is now %i.",
                 name, ref.referenceCount)
         } else {
@@ -141,9 +148,9 @@ Texture *textureSystemAcquire(const char *name, b8 autoRelease) {
                 name, ref.referenceCount)
         }
 
-        hashtableSet(&statePtr->registeredTextureTable, name, &ref);
+        hashtableSetU64(&statePtr->registeredTextureTable, nameId, &ref);
 
-        return &statePtr->registeredTextures[ref.handle];
+        return texture;
     }
 
     ENGINE_ERROR("texture_system_acquire failed to acquire texture '%s'. "
@@ -156,37 +163,36 @@ void textureSystemRelease(const char *name) {
         return;
     }
 
+    /** Names that were never interned were never acquired either. */
+    StringId nameId = stringInternFind(name);
+
     TextureReference ref;
-    if (statePtr && hashtableGet(&statePtr->registeredTextureTable, name, &ref)) {
+    if (statePtr && nameId != INVALID_ID && hashtableGetU64(&statePtr->registeredTextureTable, nameId, &ref)) {
         if (ref.referenceCount == 0) {
             ENGINE_WARNING("Tried to release non-existent texture: '%s'", name)
             return;
         }
 
-        /**
-         * Take a copy of the name since it will be wiped out by destroy,
-         * (as passed in name is generally a pointer to the actual texture's name).
-         */
-        char nameCopy[TEXTURE_NAME_MAX_LENGTH];
-        stringNCopy(nameCopy, name, TEXTURE_NAME_MAX_LENGTH);
+        /** The interned name outlives the texture, so it is safe to log after destroy. */
+        const char *nameCopy = stringInternGet(nameId);
 
         ref.referenceCount--;
         if (ref.referenceCount == 0 && ref.autoRelease) {
-            Texture *texture = &statePtr->registeredTextures[ref.handle];
+            Texture *texture = slotMapGet(&statePtr->registeredTextures, ref.handle);
 
-            /** Destroy/reset texture. */
+            /** Destroy/reset texture, then hand its slot back. */
             destroyTexture(texture);
+            slotMapRemove(&statePtr->registeredTextures, ref.handle);
 
-            ref.handle = INVALID_ID;
-            ref.autoRelease = false;
+            /** Drop the entry so its slot can be reused by another name. */
+            hashtableRemoveU64(&statePtr->registeredTextureTable, nameId);
             ENGINE_TRACE("Released texture '%s'., "
                 "Texture unloaded because reference count=0 and auto_release=true.", nameCopy)
         } else {
+            hashtableSetU64(&statePtr->registeredTextureTable, nameId, &ref);
             ENGINE_TRACE("Released texture '%s', now has a reference count of '%i' (auto_release=%s).",
                 nameCopy, ref.referenceCount, ref.autoRelease ? "true" : "false")
         }
-
-        hashtableSet(&statePtr->registeredTextureTable, nameCopy, &ref);
     } else {
         ENGINE_ERROR("texture_system_release failed to release texture '%s'.", name)
     }
@@ -230,7 +236,7 @@ b8 createDefaultTextures(TextureSystemState *state) {
         }
     }
 
-    stringNCopy(state->defaultTexture.name, DEFAULT_TEXTURE_NAME, TEXTURE_NAME_MAX_LENGTH);
+    state->defaultTexture.name = stringIntern(DEFAULT_TEXTURE_NAME);
     state->defaultTexture.width = textureDimension;
     state->defaultTexture.height = textureDimension;
     state->defaultTexture.channelCount = 4;
@@ -250,22 +256,73 @@ void destroyDefaultTextures(TextureSystemState *state) {
     }
 }
 
-b8 loadTexture(const char *textureName, Texture *texture) {
+b8 loadTexture(StringId textureName, Texture *texture) {
     char *formatStr = "assets/textures/%s.%s";
     const i32 requiredChannelCount = 4;
     stbi_set_flip_vertically_on_load(true);
     char fullFilePath[512];
 
-    stringFormat(fullFilePath, formatStr, textureName, "png");
+    stringFormat(fullFilePath, formatStr, stringInternGet(textureName), "png");
 
     Texture tempTexture;
 
-    u8* data = stbi_load(
-        fullFilePath,
-        (i32*)&tempTexture.width,
-        (i32*)&tempTexture.height,
-        (i32*)&tempTexture.channelCount,
-        requiredChannelCount);
+    /**
+     * The encoded file is only needed while decoding, so it goes on the
+     * calling thread's scratch stack when there is one with room, and on the
+     * heap otherwise.
+     */
+    StackAllocator *scratch = stackAllocatorGetScratch();
+    StackAllocatorMarker marker = scratch ? stackAllocatorGetMarker(scratch) : 0;
+
+    u8 *fileBytes = 0;
+    u64 fileSize = 0;
+    b8 fileOnHeap = false;
+    b8 fileRead = false;
+    FileHandle handle;
+    if (!filesystemOpen(fullFilePath, FILE_MODE_READ, true, &handle)) {
+        stbi__err("can't fopen", "Unable to open file");
+    } else {
+        if (!filesystemSize(&handle, &fileSize) || !fileSize) {
+            stbi__err("can't get file size or file is empty", "Unable to read file");
+        } else {
+            if (scratch && scratch->totalSize - scratch->top >= fileSize) {
+                fileBytes = stackAllocatorAllocate(scratch, fileSize, 1);
+            } else {
+                fileBytes = engineAllocateUninitialized(fileSize, MEMORY_TAG_TEXTURE);
+                fileOnHeap = fileBytes != 0;
+            }
+
+            u64 bytesRead = 0;
+            if (!fileBytes) {
+                stbi__err("outofmem", "Out of memory");
+            } else if (!filesystemRead(&handle, fileSize, fileBytes, &bytesRead)) {
+                stbi__err("can't read file", "Unable to read file");
+            } else {
+                fileRead = true;
+            }
+        }
+
+        filesystemClose(&handle);
+    }
+
+    u8* data = 0;
+    if (fileRead) {
+        data = stbi_load_from_memory(
+            fileBytes,
+            (i32)fileSize,
+            (i32*)&tempTexture.width,
+            (i32*)&tempTexture.height,
+            (i32*)&tempTexture.channelCount,
+            requiredChannelCount);
+    }
+
+    if (fileOnHeap) {
+        engineFree(fileBytes, fileSize, MEMORY_TAG_TEXTURE);
+    }
+
+    if (scratch) {
+        stackAllocatorFreeToMarker(scratch, marker);
+    }
 
     tempTexture.channelCount = requiredChannelCount;
 
@@ -291,8 +348,7 @@ b8 loadTexture(const char *textureName, Texture *texture) {
             return false;
         }
 
-        /** Take a copy of the name. */
-        stringNCopy(tempTexture.name, textureName, TEXTURE_NAME_MAX_LENGTH);
+        tempTexture.name = textureName;
         tempTexture.generation = INVALID_ID;
         tempTexture.hasTransparency = hasTransparency;
 
@@ -331,7 +387,6 @@ void destroyTexture(Texture *texture) {
     /** Clean up backend resources. */
     rendererDestroyTexture(texture);
 
-    engineZeroMemory(texture->name, sizeof(char) * TEXTURE_NAME_MAX_LENGTH);
     engineZeroMemory(texture, sizeof(Texture));
     texture->id = INVALID_ID;
     texture->generation = INVALID_ID;
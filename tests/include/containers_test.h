@@ -0,0 +1,18 @@
+#ifndef __TEST_CONTAINERS_TEST_H__
+#define __TEST_CONTAINERS_TEST_H__
+
+#include "../../engine/src/core/logger.h"
+#include "../../engine/src/defines.h"
+
+b8 testHashtable();
+b8 testHashtableGrowable();
+b8 testSlotMap();
+b8 testDynamicArrayBulk();
+b8 testRingQueues();
+b8 testStringIntern();
+b8 testRadixSort();
+b8 testHeap();
+b8 testSoaArray();
+b8 testBitset();
+
+#endif
@@ -0,0 +1,13 @@
+#ifndef __TEST_JOB_TEST_H__
+#define __TEST_JOB_TEST_H__
+
+#include "../../engine/src/core/logger.h"
+#include "../../engine/src/game_types.h"
+
+b8 testPlatformThreading();
+b8 testJobSystem();
+b8 testJobAllocations();
+b8 testParallelFor();
+b8 testTaskGraph();
+
+#endif
@@ -7,4 +7,15 @@
 void logTypeSizes();
 void logMemoryUsage();
 
+b8 testDynamicAllocator();
+b8 testDynamicAllocatorFragmentation();
+b8 testPoolAllocator();
+b8 testAlignedAllocation();
+b8 testLinearAllocatorDirtyMark();
+b8 testStackAllocator();
+b8 testVirtualArena();
+b8 testBuddyAllocator();
+b8 testMemoryTracker();
+b8 testMemoryStats();
+
 #endif
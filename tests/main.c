@@ -1,6 +1,37 @@
+#include "include/containers_test.h"
+#include "include/job_test.h"
 #include "include/memory_test.h"
 
 int main() {
     logTypeSizes();
     logMemoryUsage();
+
+    b8 passed = true;
+    passed &= testDynamicAllocator();
+    passed &= testDynamicAllocatorFragmentation();
+    passed &= testPoolAllocator();
+    passed &= testAlignedAllocation();
+    passed &= testLinearAllocatorDirtyMark();
+    passed &= testStackAllocator();
+    passed &= testVirtualArena();
+    passed &= testBuddyAllocator();
+    passed &= testMemoryTracker();
+    passed &= testMemoryStats();
+    passed &= testHashtable();
+    passed &= testHashtableGrowable();
+    passed &= testSlotMap();
+    passed &= testDynamicArrayBulk();
+    passed &= testRingQueues();
+    passed &= testStringIntern();
+    passed &= testRadixSort();
+    passed &= testHeap();
+    passed &= testSoaArray();
+    passed &= testBitset();
+    passed &= testPlatformThreading();
+    passed &= testJobSystem();
+    passed &= testJobAllocations();
+    passed &= testParallelFor();
+    passed &= testTaskGraph();
+
+    return passed ? 0 : 1;
 }
@@ -0,0 +1,895 @@
+#include "../include/containers_test.h"
+
+#include "../../engine/src/engine_memory/engine_memory.h"
+#include "../../engine/src/engine_memory/engine_string.h"
+#include "../../engine/src/containers/hashtable.h"
+#include "../../engine/src/containers/slot_map.h"
+#include "../../engine/src/containers/dynamic_array.h"
+#include "../../engine/src/engine_memory/linear_allocator.h"
+#include "../../engine/src/containers/ring_queue.h"
+#include "../../engine/src/core/clock.h"
+#include "../../engine/src/core/atomic.h"
+#include "../../engine/src/systems/string_intern_system.h"
+#include "../../engine/src/containers/radix_sort.h"
+#include "../../engine/src/containers/heap.h"
+#include "../../engine/src/containers/soa_array.h"
+#include "../../engine/src/containers/bitset.h"
+#include "../../engine/src/engine_memory/frame_allocator.h"
+#include "../../engine/src/platform/platform.h"
+
+#include <stdlib.h>
+
+b8 testHashtable() {
+    ENGINE_INFO("Hashtable:\n")
+
+    const u32 capacity = 1000;
+    u64 memoryRequirement = 0;
+    Hashtable table;
+    hashtableCreate(sizeof(u32), capacity, 32, false, &memoryRequirement, 0, 0);
+    void *memory = engineAllocate(memoryRequirement, MEMORY_TAG_APPLICATION);
+    if (!hashtableCreate(sizeof(u32), capacity, 32, false, &memoryRequirement, memory, &table)) {
+        ENGINE_ERROR("Failed to create hashtable.")
+        return false;
+    }
+
+    /** Fill to capacity; the old table aliased any names that hashed to the same slot. */
+    char name[32];
+    for (u32 i = 0; i < capacity; ++i) {
+        stringFormat(name, "texture_%u", i);
+        if (!hashtableSet(&table, name, &i)) {
+            ENGINE_ERROR("Failed to set '%s'.", name)
+            return false;
+        }
+    }
+
+    u32 value = 0;
+    if (hashtableSet(&table, "one_too_many", &value) || hashtableGet(&table, "one_too_many", &value)) {
+        ENGINE_ERROR("A full table accepted another name.")
+        return false;
+    }
+
+    /** Remove every third name, then check everything else is untouched by the backward shifts. */
+    for (u32 i = 0; i < capacity; i += 3) {
+        stringFormat(name, "texture_%u", i);
+        if (!hashtableRemove(&table, name)) {
+            ENGINE_ERROR("Failed to remove '%s'.", name)
+            return false;
+        }
+    }
+
+    for (u32 i = 0; i < capacity; ++i) {
+        stringFormat(name, "texture_%u", i);
+        b8 found = hashtableGet(&table, name, &value);
+        if (found != (i % 3 != 0) || (found && value != i)) {
+            ENGINE_ERROR("Lookup of '%s' returned %u (found=%u).", name, value, found)
+            return false;
+        }
+    }
+
+    u32 invalid = INVALID_ID;
+    hashtableFill(&table, &invalid);
+    if (!hashtableGet(&table, "missing", &value) || value != INVALID_ID || table.count != capacity - 334) {
+        ENGINE_ERROR("Missing names should return the fill value.")
+        return false;
+    }
+
+    hashtableDestroy(&table);
+    engineFree(memory, memoryRequirement, MEMORY_TAG_APPLICATION);
+
+    ENGINE_INFO("  Names stay distinct through fills and removals.")
+
+    return true;
+}
+
+b8 testHashtableGrowable() {
+    ENGINE_INFO("Growable u64 hashtable:\n")
+
+    Hashtable table;
+    if (!hashtableCreateGrowable(sizeof(u64), 8, HASHTABLE_KEY_U64, 0, false, &table)) {
+        ENGINE_ERROR("Failed to create growable hashtable.")
+        return false;
+    }
+
+    /** Enough inserts to grow several times, with removals landing mid-rehash. */
+    const u64 count = 5000;
+    for (u64 i = 0; i < count; ++i) {
+        u64 key = i * 0x9e3779b97f4a7c15ULL;
+        u64 value = i;
+        hashtableSetU64(&table, key, &value);
+        if (i % 4 == 3) {
+            hashtableRemoveU64(&table, (i - 1) * 0x9e3779b97f4a7c15ULL);
+        }
+    }
+
+    u64 value = 0;
+    for (u64 i = 0; i < count; ++i) {
+        b8 found = hashtableGetU64(&table, i * 0x9e3779b97f4a7c15ULL, &value);
+        if (found != (i % 4 != 2) || (found && value != i)) {
+            ENGINE_ERROR("Lookup of key %llu returned %llu (found=%u).", i, value, found)
+            return false;
+        }
+    }
+
+    /** Each live entry is visited exactly once, across both storages if still rehashing. */
+    u64 visited = 0;
+    u64 sum = 0;
+    HashtableIterator iterator = hashtableIterate(&table);
+    HashtableEntry entry;
+    while (hashtableIteratorNext(&iterator, &entry)) {
+        visited++;
+        sum += *(u64*)entry.value;
+    }
+
+    u64 expectedSum = 0;
+    for (u64 i = 0; i < count; ++i) {
+        expectedSum += i % 4 != 2 ? i : 0;
+    }
+
+    if (visited != table.count || visited != count - (count / 4) || sum != expectedSum) {
+        ENGINE_ERROR("Iterator visited %llu entries of %u.", visited, table.count)
+        return false;
+    }
+
+    hashtableDestroy(&table);
+
+    ENGINE_INFO("  Grew to %llu entries with incremental rehashing.", visited)
+
+    return true;
+}
+
+b8 testSlotMap() {
+    ENGINE_INFO("Slot map:\n")
+
+    const u32 capacity = 64;
+    u64 memoryRequirement = 0;
+    SlotMap map;
+    slotMapCreate(sizeof(u64), capacity, &memoryRequirement, 0, 0);
+    void *memory = engineAllocate(memoryRequirement, MEMORY_TAG_APPLICATION);
+    slotMapCreate(sizeof(u64), capacity, &memoryRequirement, memory, &map);
+
+    SlotMapHandle handles[64];
+    for (u32 i = 0; i < capacity; ++i) {
+        u64 *element = 0;
+        handles[i] = slotMapInsert(&map, (void**)&element);
+        *element = i;
+    }
+
+    if (slotMapInsert(&map, 0).index != INVALID_ID) {
+        ENGINE_ERROR("A full slot map handed out another slot.")
+        return false;
+    }
+
+    for (u32 i = 0; i < capacity; i += 2) {
+        slotMapRemove(&map, handles[i]);
+    }
+
+    /** The reused slot gets a new generation, so the old handle no longer resolves. */
+    u64 *element = 0;
+    SlotMapHandle reused = slotMapInsert(&map, (void**)&element);
+    *element = 1000;
+    if (reused.index != handles[62].index || slotMapGet(&map, handles[62]) ||
+        slotMapRemove(&map, handles[62]) || *(u64*)slotMapGet(&map, reused) != 1000) {
+
+        ENGINE_ERROR("Stale handle resolved after its slot was reused.")
+        return false;
+    }
+
+    u64 sum = 0;
+    for (u32 i = 0; i < map.count; ++i) {
+        sum += *(u64*)slotMapGetLive(&map, i, 0);
+    }
+
+    /** Odd values 1..63 plus the reused slot. */
+    if (map.count != 33 || sum != 1024 + 1000) {
+        ENGINE_ERROR("Live walk saw %u elements summing to %llu.", map.count, sum)
+        return false;
+    }
+
+    slotMapDestroy(&map);
+    engineFree(memory, memoryRequirement, MEMORY_TAG_APPLICATION);
+
+    ENGINE_INFO("  Stale handles rejected, live walk dense.")
+
+    return true;
+}
+
+/** Heap blocks that are filled with garbage when freed, so reads after a free show up. */
+static void *poisoningAllocate(void *instance, u64 size, u64 alignment) {
+    return engineAllocateAlignedUninitialized(size, alignment, (MemoryTag)(u64)instance);
+}
+
+static void poisoningFree(void *instance, void *block, u64 size, u64 alignment) {
+    engineSetMemory(block, 0xCD, size);
+    engineFreeAligned(block, size, alignment, (MemoryTag)(u64)instance);
+}
+
+b8 testDynamicArrayBulk() {
+    ENGINE_INFO("Dynamic array bulk operations:\n")
+
+    /** An array that lives in a caller-supplied linear allocator. */
+    u64 blockSize = 4096;
+    void *block = engineAllocate(blockSize, MEMORY_TAG_APPLICATION);
+    LinearAllocator linear;
+    linearAllocatorCreate(blockSize, block, &linear);
+    EngineAllocator allocator = engineAllocatorLinear(&linear);
+
+    u32 *values = dynamicArrayCreateWith(u32, 4, &allocator);
+    dynamicArraySetGrowth(values, 150);
+
+    u32 source[100];
+    for (u32 i = 0; i < 100; ++i) {
+        source[i] = i;
+    }
+
+    /** One growth to fit the whole batch, rather than one per push. */
+    dynamicArrayPushN(values, source, 100)
+    if (dynamicArrayLength(values) != 100 || dynamicArrayCapacity(values) != 100 || values[99] != 99 ||
+        (u8*)values < (u8*)block || (u8*)values >= (u8*)block + blockSize) {
+
+        ENGINE_ERROR("pushN did not land all 100 elements in the linear allocator.")
+        return false;
+    }
+
+    /** 150% of 100. */
+    dynamicArrayPushN(values, source, 1)
+    if (dynamicArrayCapacity(values) != 150) {
+        ENGINE_ERROR("Expected growth to 150 elements, got %llu.", dynamicArrayCapacity(values))
+        return false;
+    }
+
+    u32 removed = 0;
+    dynamicArraySwapRemove(values, 10, &removed);
+    if (removed != 10 || values[10] != 0 || dynamicArrayLength(values) != 100) {
+        ENGINE_ERROR("Swap-remove did not move the last element into the hole.")
+        return false;
+    }
+
+    /** Heap-backed copy, appended in one go then trimmed. */
+    u32 *copy = dynamicArrayCreate(u32);
+    dynamicArrayReserveCapacity(copy, 256)
+    dynamicArrayAppendArray(copy, values)
+    dynamicArrayShrinkToFit(copy)
+    if (dynamicArrayCapacity(copy) != 100 || copy[10] != 0 || copy[99] != 99) {
+        ENGINE_ERROR("Append/shrink produced capacity %llu.", dynamicArrayCapacity(copy))
+        return false;
+    }
+
+    /** Appending an array to itself grows it, so its old block is freed mid-append. */
+    EngineAllocator poisoning = {poisoningAllocate, poisoningFree, (void*)(u64)MEMORY_TAG_DYNAMIC_ARRAY};
+    u32 *self = dynamicArrayCreateWith(u32, 100, &poisoning);
+    dynamicArrayPushN(self, source, 100)
+    dynamicArrayAppendArray(self, self)
+    if (dynamicArrayLength(self) != 200 || self[100] != 0 || self[199] != 99) {
+        ENGINE_ERROR("Self-append read the array's elements after its old block was freed.")
+        return false;
+    }
+
+    dynamicArrayShrinkToFit(self)
+    dynamicArrayPushN(self, &self[195], 5)
+    if (dynamicArrayLength(self) != 205 || self[200] != 95 || self[204] != 99) {
+        ENGINE_ERROR("Pushing a sub-range of the array onto itself read freed elements.")
+        return false;
+    }
+
+    dynamicArrayDestroy(self);
+    dynamicArrayDestroy(copy);
+    dynamicArrayDestroy(values);
+    linearAllocatorDestroy(&linear);
+    engineFree(block, blockSize, MEMORY_TAG_APPLICATION);
+
+    ENGINE_INFO("  Bulk pushes, allocator binding and growth factor behave.")
+
+    return true;
+}
+
+#define QUEUE_BENCHMARK_COUNT 1000000
+
+typedef struct QueueBenchmark {
+    SpscQueue spsc;
+    MpmcQueue mpmc;
+
+    /** Values per producer; each producer pushes 1..count. */
+    u64 count;
+    volatile u64 consumed;
+    volatile u64 sum;
+    volatile b8 outOfOrder;
+} QueueBenchmark;
+
+static u32 spscProducer(void *argument) {
+    QueueBenchmark *benchmark = argument;
+    for (u64 i = 1; i <= benchmark->count; ++i) {
+        while (!spscQueuePush(&benchmark->spsc, &i)) {
+            platformThreadYield();
+        }
+    }
+
+    return 0;
+}
+
+static u32 spscConsumer(void *argument) {
+    QueueBenchmark *benchmark = argument;
+    u64 expected = 1;
+    u64 value = 0;
+    while (expected <= benchmark->count) {
+        if (spscQueuePop(&benchmark->spsc, &value)) {
+            if (value != expected) {
+                benchmark->outOfOrder = true;
+            }
+            benchmark->sum += value;
+            ++expected;
+        } else {
+            platformThreadYield();
+        }
+    }
+
+    return 0;
+}
+
+static u32 mpmcProducer(void *argument) {
+    QueueBenchmark *benchmark = argument;
+    for (u64 i = 1; i <= benchmark->count; ++i) {
+        while (!mpmcQueuePush(&benchmark->mpmc, &i)) {
+            platformThreadYield();
+        }
+    }
+
+    return 0;
+}
+
+static u32 mpmcConsumer(void *argument) {
+    QueueBenchmark *benchmark = argument;
+    u64 value = 0;
+    u64 sum = 0;
+    u64 total = benchmark->count * 2;
+    for (;;) {
+        if (mpmcQueuePop(&benchmark->mpmc, &value)) {
+            sum += value;
+            atomicFetchAdd64(&benchmark->consumed, 1);
+        } else if (atomicLoad64(&benchmark->consumed) >= total) {
+            break;
+        } else {
+            platformThreadYield();
+        }
+    }
+
+    atomicFetchAdd64(&benchmark->sum, sum);
+
+    return 0;
+}
+
+b8 testRingQueues() {
+    ENGINE_INFO("Ring queues:\n")
+
+    /** Wrap around a small queue a few times on one thread first. */
+    MpmcQueue small;
+    mpmcQueueCreate(sizeof(u32), 4, &small);
+    u32 value = 0;
+    for (u32 lap = 0; lap < 3; ++lap) {
+        for (u32 i = 0; i < 4; ++i) {
+            u32 pushed = (lap * 4) + i;
+            mpmcQueuePush(&small, &pushed);
+        }
+
+        if (mpmcQueuePush(&small, &value)) {
+            ENGINE_ERROR("A full MPMC queue accepted another element.")
+            return false;
+        }
+
+        for (u32 i = 0; i < 4; ++i) {
+            if (!mpmcQueuePop(&small, &value) || value != (lap * 4) + i) {
+                ENGINE_ERROR("MPMC queue popped %u out of order.", value)
+                return false;
+            }
+        }
+    }
+
+    if (mpmcQueuePop(&small, &value)) {
+        ENGINE_ERROR("An empty MPMC queue popped an element.")
+        return false;
+    }
+    mpmcQueueDestroy(&small);
+
+    QueueBenchmark benchmark = {0};
+    benchmark.count = QUEUE_BENCHMARK_COUNT;
+    u64 expectedSum = (benchmark.count * (benchmark.count + 1)) / 2;
+    Clock clock = {0};
+
+    /** One producer, one consumer. */
+    spscQueueCreate(sizeof(u64), 1024, &benchmark.spsc);
+    PlatformThread producer, consumer;
+    clockStart(&clock);
+    platformThreadCreate(spscConsumer, &benchmark, &consumer);
+    platformThreadCreate(spscProducer, &benchmark, &producer);
+    platformThreadJoin(&producer);
+    platformThreadJoin(&consumer);
+    clockUpdate(&clock);
+    spscQueueDestroy(&benchmark.spsc);
+
+    if (benchmark.outOfOrder || benchmark.sum != expectedSum) {
+        ENGINE_ERROR("SPSC queue lost or reordered elements.")
+        return false;
+    }
+    ENGINE_INFO("  SPSC: %llu elements in %.3fs (%.1fM/s).", benchmark.count, clock.elapsed,
+        (f64)benchmark.count / clock.elapsed / 1000000.0)
+
+    /** Two producers, two consumers. */
+    benchmark.sum = 0;
+    mpmcQueueCreate(sizeof(u64), 1024, &benchmark.mpmc);
+    PlatformThread threads[4];
+    clockStart(&clock);
+    platformThreadCreate(mpmcConsumer, &benchmark, &threads[0]);
+    platformThreadCreate(mpmcConsumer, &benchmark, &threads[1]);
+    platformThreadCreate(mpmcProducer, &benchmark, &threads[2]);
+    platformThreadCreate(mpmcProducer, &benchmark, &threads[3]);
+    for (u32 i = 0; i < 4; ++i) {
+        platformThreadJoin(&threads[i]);
+    }
+    clockUpdate(&clock);
+    mpmcQueueDestroy(&benchmark.mpmc);
+
+    if (benchmark.sum != expectedSum * 2) {
+        ENGINE_ERROR("MPMC queue lost or duplicated elements.")
+        return false;
+    }
+    ENGINE_INFO("  MPMC 2x2: %llu elements in %.3fs (%.1fM/s).", benchmark.count * 2, clock.elapsed,
+        (f64)(benchmark.count * 2) / clock.elapsed / 1000000.0)
+
+    return true;
+}
+
+b8 testStringIntern() {
+    ENGINE_INFO("String intern table:\n")
+
+    StringInternSystemConfig config;
+    config.maxStringCount = 256;
+    config.maxCharacterBytes = 64 * 1024;
+    u64 memoryRequirement = 0;
+    stringInternSystemInitialize(&memoryRequirement, 0, config);
+    void *memory = engineAllocate(memoryRequirement, MEMORY_TAG_APPLICATION);
+    if (!stringInternSystemInitialize(&memoryRequirement, memory, config)) {
+        ENGINE_ERROR("String intern system failed to initialize.")
+        return false;
+    }
+
+    /** A name copied into a buffer still interns to the same ID as the literal. */
+    char copy[32];
+    stringNCopy(copy, "cobblestone", sizeof(copy));
+    StringId cobblestone = stringIntern("cobblestone");
+    StringId paving = stringIntern("paving_1");
+    if (cobblestone == INVALID_ID || cobblestone == paving || stringIntern(copy) != cobblestone ||
+        stringInternFind("Cobblestone") != INVALID_ID || stringIntern(0) != STRING_ID_EMPTY) {
+
+        ENGINE_ERROR("Equal strings did not share an ID, or different ones did.")
+        return false;
+    }
+
+    if (!stringsEqual(stringInternGet(paving), "paving_1") || stringInternLength(paving) != 8 ||
+        stringInternHash(paving) == stringInternHash(cobblestone) || stringInternGet(INVALID_ID)[0]) {
+
+        ENGINE_ERROR("Interned string '%s' did not read back.", stringInternGet(paving))
+        return false;
+    }
+
+    /** Fill the table; every ID must stay distinct and resolve to its own string. */
+    char name[32];
+    while (stringInternCount() < config.maxStringCount) {
+        stringFormat(name, "texture_%u", stringInternCount());
+        stringIntern(name);
+    }
+
+    for (u32 i = 3; i < config.maxStringCount; ++i) {
+        stringFormat(name, "texture_%u", i);
+        if (stringInternFind(name) != i || !stringsEqual(stringInternGet(i), name)) {
+            ENGINE_ERROR("'%s' resolved to ID %u.", name, stringInternFind(name))
+            return false;
+        }
+    }
+
+    if (stringIntern("one_too_many") != INVALID_ID || stringIntern("paving_1") != paving) {
+        ENGINE_ERROR("A full intern table handed out another ID.")
+        return false;
+    }
+
+    stringInternSystemShutdown(memory);
+    engineFree(memory, memoryRequirement, MEMORY_TAG_APPLICATION);
+
+    ENGINE_INFO("  %u strings interned, IDs stable.", config.maxStringCount)
+
+    return true;
+}
+
+#define RADIX_TEST_THREAD_COUNT 4
+
+typedef struct RadixTestTask {
+    PFN_radixSortTask task;
+    void *data;
+    u32 index;
+} RadixTestTask;
+
+static u32 radixTestThread(void *argument) {
+    RadixTestTask *task = argument;
+    task->task(task->data, task->index);
+    return 0;
+}
+
+/** One bare thread per task; enough to exercise the parallel histogram. */
+static void radixTestParallelFor(void *context, u32 taskCount, PFN_radixSortTask task, void *data) {
+    PlatformThread threads[RADIX_TEST_THREAD_COUNT];
+    RadixTestTask tasks[RADIX_TEST_THREAD_COUNT];
+    for (u32 i = 0; i < taskCount; ++i) {
+        tasks[i].task = task;
+        tasks[i].data = data;
+        tasks[i].index = i;
+        platformThreadCreate(radixTestThread, &tasks[i], &threads[i]);
+    }
+
+    for (u32 i = 0; i < taskCount; ++i) {
+        platformThreadJoin(&threads[i]);
+    }
+}
+
+static int compareSortItems(const void *a, const void *b) {
+    u64 left = ((const RadixSortItem*)a)->key;
+    u64 right = ((const RadixSortItem*)b)->key;
+    return left < right ? -1 : left > right;
+}
+
+/** Fills items with xorshift keys, masked to keyMask; payloads record the original order. */
+static void fillSortItems(RadixSortItem *items, u32 count, u64 keyMask) {
+    u64 state = 0x9e3779b97f4a7c15ULL;
+    for (u32 i = 0; i < count; ++i) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        items[i].key = state & keyMask;
+        items[i].payload = i;
+        items[i].reserved = 0;
+    }
+}
+
+/** Ascending keys, and equal keys still in their original order. */
+static b8 sortedAndStable(const RadixSortItem *items, u32 count) {
+    for (u32 i = 1; i < count; ++i) {
+        if (items[i - 1].key > items[i].key ||
+            (items[i - 1].key == items[i].key && items[i - 1].payload > items[i].payload)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+b8 testRadixSort() {
+    ENGINE_INFO("Radix sort:\n")
+
+    const u32 maxCount = 1000000;
+    u64 bufferSize = sizeof(RadixSortItem) * maxCount;
+    RadixSortItem *items = engineAllocate(bufferSize, MEMORY_TAG_ARRAY);
+    RadixSortItem *reference = engineAllocate(bufferSize, MEMORY_TAG_ARRAY);
+    RadixSortItem *scratch = engineAllocate(bufferSize, MEMORY_TAG_ARRAY);
+
+    /** Small inputs take the insertion sort path. */
+    fillSortItems(items, 50, 0xf);
+    radixSort(items, 50, scratch);
+    if (!sortedAndStable(items, 50)) {
+        ENGINE_ERROR("Small radix sort was not sorted and stable.")
+        return false;
+    }
+
+    /** Scratch from the frame allocator, with few distinct keys to exercise stability. */
+    FrameAllocatorConfig frameConfig;
+    frameConfig.arenaSize = 1024 * 1024;
+    u64 frameRequirement = 0;
+    frameAllocatorSystemInitialize(&frameRequirement, 0, frameConfig);
+    void *frameMemory = engineAllocate(frameRequirement, MEMORY_TAG_APPLICATION);
+    frameAllocatorSystemInitialize(&frameRequirement, frameMemory, frameConfig);
+
+    fillSortItems(items, 20000, 0xff00ff);
+    if (!radixSort(items, 20000, 0) || !sortedAndStable(items, 20000)) {
+        ENGINE_ERROR("Radix sort with frame scratch was not sorted and stable.")
+        return false;
+    }
+
+    /** The parallel histogram must agree with qsort. */
+    RadixSortParallel parallel;
+    parallel.parallelFor = radixTestParallelFor;
+    parallel.context = 0;
+    parallel.taskCount = RADIX_TEST_THREAD_COUNT;
+
+    frameAllocatorBeginFrame();
+    fillSortItems(items, 200000, ~0ULL);
+    engineCopyMemory(reference, items, sizeof(RadixSortItem) * 200000);
+    qsort(reference, 200000, sizeof(RadixSortItem), compareSortItems);
+    if (!radixSortParallel(items, 200000, scratch, &parallel) || !sortedAndStable(items, 200000)) {
+        ENGINE_ERROR("Parallel radix sort was not sorted and stable.")
+        return false;
+    }
+
+    for (u32 i = 0; i < 200000; ++i) {
+        if (items[i].key != reference[i].key) {
+            ENGINE_ERROR("Radix sort and qsort disagree at %u.", i)
+            return false;
+        }
+    }
+
+    frameAllocatorSystemShutdown(frameMemory);
+    engineFree(frameMemory, frameRequirement, MEMORY_TAG_APPLICATION);
+
+    /** Full 64-bit keys, so every pass runs. */
+    Clock clock;
+    for (u32 count = 10000; count <= maxCount; count *= 10) {
+        fillSortItems(items, count, ~0ULL);
+        engineCopyMemory(reference, items, sizeof(RadixSortItem) * count);
+
+        clockStart(&clock);
+        radixSort(items, count, scratch);
+        clockUpdate(&clock);
+        f64 radixTime = clock.elapsed;
+
+        clockStart(&clock);
+        qsort(reference, count, sizeof(RadixSortItem), compareSortItems);
+        clockUpdate(&clock);
+        f64 qsortTime = clock.elapsed;
+
+        if (!sortedAndStable(items, count)) {
+            ENGINE_ERROR("Radix sort of %u items was not sorted and stable.", count)
+            return false;
+        }
+
+        ENGINE_INFO("  %7u items: radix %.2fms, qsort %.2fms.", count, radixTime * 1000.0, qsortTime * 1000.0)
+    }
+
+    engineFree(items, bufferSize, MEMORY_TAG_ARRAY);
+    engineFree(reference, bufferSize, MEMORY_TAG_ARRAY);
+    engineFree(scratch, bufferSize, MEMORY_TAG_ARRAY);
+
+    return true;
+}
+
+typedef struct HeapTestItem {
+    u64 priority;
+    HeapNode node;
+} HeapTestItem;
+
+b8 testHeap() {
+    ENGINE_INFO("Heap:\n")
+
+    const u32 count = 1000;
+    HeapTestItem *items = engineAllocate(sizeof(HeapTestItem) * count, MEMORY_TAG_ARRAY);
+
+    /** Starts small so pushes have to grow it. */
+    Heap heap;
+    heapCreateGrowable(4, &heap);
+
+    u64 state = 0x2545f4914f6cdd1dULL;
+    for (u32 i = 0; i < count; ++i) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        items[i].priority = state % 100000;
+        heapNodeInitialize(&items[i].node);
+        heapPush(&heap, &items[i].node, items[i].priority);
+    }
+
+    if (heapPush(&heap, &items[0].node, 0)) {
+        ENGINE_ERROR("A queued node was pushed twice.")
+        return false;
+    }
+
+    /** Decrease every third key, raise every fifth, and drop every seventh item. */
+    u32 queued = count;
+    for (u32 i = 0; i < count; ++i) {
+        if (i % 7 == 0) {
+            heapRemove(&heap, &items[i].node);
+            queued--;
+        } else if (i % 3 == 0) {
+            items[i].priority /= 2;
+            heapUpdate(&heap, &items[i].node, items[i].priority);
+        } else if (i % 5 == 0) {
+            items[i].priority += 50000;
+            heapUpdate(&heap, &items[i].node, items[i].priority);
+        }
+    }
+
+    if (heap.count != queued || heapNodeQueued(&items[7].node) || heapRemove(&heap, &items[7].node)) {
+        ENGINE_ERROR("Heap holds %u nodes after removal; expected %u.", heap.count, queued)
+        return false;
+    }
+
+    u64 previous = 0;
+    u32 popped = 0;
+    u64 priority = 0;
+    HeapNode *node = 0;
+    while ((node = heapPop(&heap, &priority))) {
+        HeapTestItem *item = HEAP_NODE_OWNER(node, HeapTestItem, node);
+        if (priority < previous || priority != item->priority || heapNodeQueued(node)) {
+            ENGINE_ERROR("Heap popped priority %llu after %llu.", priority, previous)
+            return false;
+        }
+
+        previous = priority;
+        popped++;
+    }
+
+    if (popped != queued) {
+        ENGINE_ERROR("Heap popped %u nodes; expected %u.", popped, queued)
+        return false;
+    }
+
+    heapDestroy(&heap);
+
+    /** A fixed heap refuses the push past its capacity. */
+    u64 memoryRequirement = 0;
+    heapCreate(8, &memoryRequirement, 0, 0);
+    void *memory = engineAllocate(memoryRequirement, MEMORY_TAG_BST);
+    heapCreate(8, &memoryRequirement, memory, &heap);
+    for (u32 i = 0; i < 9; ++i) {
+        heapNodeInitialize(&items[i].node);
+        if (heapPush(&heap, &items[i].node, count - i) != (i < 8)) {
+            ENGINE_ERROR("Fixed heap accepted the wrong number of nodes.")
+            return false;
+        }
+    }
+
+    if (heapPeek(&heap, &priority) != &items[7].node || priority != count - 7) {
+        ENGINE_ERROR("Fixed heap peeked the wrong node.")
+        return false;
+    }
+
+    heapDestroy(&heap);
+    engineFree(memory, memoryRequirement, MEMORY_TAG_BST);
+    engineFree(items, sizeof(HeapTestItem) * count, MEMORY_TAG_ARRAY);
+
+    ENGINE_INFO("  %u nodes popped in order after updates and removals.", popped)
+
+    return true;
+}
+
+b8 testSoaArray() {
+    ENGINE_INFO("SoA array:\n")
+
+    /** Position, velocity and an id, as a transform update would see them. */
+    enum { COLUMN_POSITION, COLUMN_VELOCITY, COLUMN_ID, COLUMN_COUNT };
+    const u64 strides[COLUMN_COUNT] = { sizeof(f32) * 3, sizeof(f32) * 3, sizeof(u32) };
+
+    SoaArray array;
+    soaArrayCreateGrowable(COLUMN_COUNT, strides, 4, &array);
+
+    const u32 count = 1000;
+    for (u32 i = 0; i < count; ++i) {
+        f32 position[3] = { (f32)i, 0.0f, 0.0f };
+        f32 velocity[3] = { 1.0f, 2.0f, 3.0f };
+        const void *values[COLUMN_COUNT] = { position, velocity, &i };
+        if (soaArrayPush(&array, values) != i) {
+            ENGINE_ERROR("SoA push %u landed at the wrong row.", i)
+            return false;
+        }
+    }
+
+    for (u32 i = 0; i < COLUMN_COUNT; ++i) {
+        if ((u64)soaArrayColumn(&array, i) % SOA_ARRAY_COLUMN_ALIGNMENT) {
+            ENGINE_ERROR("SoA column %u is not aligned.", i)
+            return false;
+        }
+    }
+
+    /** Integrate in spans, touching only the two vector columns. */
+    SoaArraySpan span = {0};
+    u32 spans = 0;
+    while (soaArrayNextSpan(&array, 256, &span)) {
+        f32 *positions = span.columns[COLUMN_POSITION];
+        const f32 *velocities = span.columns[COLUMN_VELOCITY];
+        for (u32 i = 0; i < span.count * 3; ++i) {
+            positions[i] += velocities[i];
+        }
+
+        spans++;
+    }
+
+    /** Removing a row moves the last row into it in every column. */
+    soaArraySwapRemove(&array, 10);
+    f32 *positions = soaArrayColumn(&array, COLUMN_POSITION);
+    u32 *ids = soaArrayColumn(&array, COLUMN_ID);
+    if (spans != 4 || array.length != count - 1 || ids[10] != count - 1 ||
+        positions[30] != (f32)count || positions[31] != 2.0f || positions[32] != 3.0f) {
+
+        ENGINE_ERROR("SoA columns fell out of sync after integrate and swap remove.")
+        return false;
+    }
+
+    u32 first = soaArrayAppend(&array, 10);
+    ids = soaArrayColumn(&array, COLUMN_ID);
+    if (first != count - 1 || ids[0] != 0 || ids[first + 9] != 0) {
+        ENGINE_ERROR("SoA append did not add zeroed rows at the end.")
+        return false;
+    }
+
+    soaArrayDestroy(&array);
+
+    /** A fixed array in a caller block stops at its capacity. */
+    u64 memoryRequirement = 0;
+    soaArrayCreate(COLUMN_COUNT, strides, 8, &memoryRequirement, 0, 0);
+    void *memory = engineAllocateAligned(memoryRequirement, SOA_ARRAY_COLUMN_ALIGNMENT, MEMORY_TAG_ARRAY);
+    soaArrayCreate(COLUMN_COUNT, strides, 8, &memoryRequirement, memory, &array);
+    if (soaArrayAppend(&array, 8) != 0 || soaArrayPush(&array, 0) != INVALID_ID) {
+        ENGINE_ERROR("Fixed SoA array accepted more rows than its capacity.")
+        return false;
+    }
+
+    soaArrayDestroy(&array);
+    engineFreeAligned(memory, memoryRequirement, SOA_ARRAY_COLUMN_ALIGNMENT, MEMORY_TAG_ARRAY);
+
+    ENGINE_INFO("  %u rows integrated in %u spans, columns in sync.", count, spans)
+
+    return true;
+}
+
+b8 testBitset() {
+    ENGINE_INFO("Bitset and index allocator:\n")
+
+    /** Not a multiple of 64, so the tail word is partial. */
+    const u32 bitCount = 200;
+    u64 memoryRequirement = 0;
+    Bitset bitset;
+    bitsetCreate(bitCount, &memoryRequirement, 0, 0);
+    void *memory = engineAllocate(memoryRequirement, MEMORY_TAG_ARRAY);
+    bitsetCreate(bitCount, &memoryRequirement, memory, &bitset);
+
+    bitsetSet(&bitset, 3);
+    bitsetSet(&bitset, 64);
+    bitsetSet(&bitset, 199);
+    if (bitsetCount(&bitset) != 3 || bitsetFindFirstSet(&bitset, 0) != 3 || bitsetFindFirstSet(&bitset, 4) != 64 ||
+        bitsetFindFirstSet(&bitset, 65) != 199 || bitsetFindFirstClear(&bitset, 3) != 4) {
+
+        ENGINE_ERROR("Bitset scan found the wrong bits.")
+        return false;
+    }
+
+    for (u32 i = 0; i < bitCount; ++i) {
+        bitsetSet(&bitset, i);
+    }
+
+    if (bitsetFindFirstClear(&bitset, 0) != INVALID_ID || bitsetFindFirstSet(&bitset, bitCount) != INVALID_ID) {
+        ENGINE_ERROR("Bitset scan ran past the last bit.")
+        return false;
+    }
+
+    engineFree(memory, memoryRequirement, MEMORY_TAG_ARRAY);
+
+    /** Enough indices to need more than one summary word. */
+    const u32 capacity = 70000;
+    IndexAllocator allocator;
+    indexAllocatorCreate(capacity, &memoryRequirement, 0, 0);
+    memory = engineAllocate(memoryRequirement, MEMORY_TAG_ARRAY);
+    indexAllocatorCreate(capacity, &memoryRequirement, memory, &allocator);
+
+    for (u32 i = 0; i < capacity; ++i) {
+        if (indexAllocatorAcquire(&allocator) != i) {
+            ENGINE_ERROR("Index allocator did not hand out index %u in order.", i)
+            return false;
+        }
+    }
+
+    if (indexAllocatorAcquire(&allocator) != INVALID_ID) {
+        ENGINE_ERROR("A full index allocator handed out another index.")
+        return false;
+    }
+
+    /** Released indices come back lowest first. */
+    indexAllocatorRelease(&allocator, 66000);
+    indexAllocatorRelease(&allocator, 5000);
+    indexAllocatorRelease(&allocator, 69999);
+    if (indexAllocatorRelease(&allocator, 5000) || allocator.count != capacity - 3 ||
+        indexAllocatorAcquire(&allocator) != 5000 || indexAllocatorAcquire(&allocator) != 66000 ||
+        indexAllocatorAcquire(&allocator) != 69999 || !indexAllocatorIsAcquired(&allocator, 5000)) {
+
+        ENGINE_ERROR("Index allocator did not reuse released indices lowest first.")
+        return false;
+    }
+
+    engineFree(memory, memoryRequirement, MEMORY_TAG_ARRAY);
+
+    ENGINE_INFO("  %u indices handed out and reused.", capacity)
+
+    return true;
+}
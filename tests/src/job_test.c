@@ -0,0 +1,708 @@
+#include "../include/job_test.h"
+
+#include "../../engine/src/engine_memory/engine_memory.h"
+#include "../../engine/src/engine_memory/stack_allocator.h"
+#include "../../engine/src/core/atomic.h"
+#include "../../engine/src/core/job_system.h"
+#include "../../engine/src/core/parallel_for.h"
+#include "../../engine/src/core/task_graph.h"
+#include "../../engine/src/core/clock.h"
+#include "../../engine/src/platform/platform.h"
+
+#define JOB_TEST_JOB_COUNT 20000
+#define JOB_TEST_PARENT_COUNT 16
+#define JOB_TEST_CHILD_COUNT 32
+#define JOB_TEST_GATED_COUNT 48
+#define JOB_TEST_ALLOCATING_JOBS 64
+#define JOB_TEST_ALLOCATIONS_PER_JOB 1024
+#define JOB_TEST_LIVE_BLOCKS 8
+
+#define THREADING_TEST_THREAD_COUNT 4
+#define THREADING_TEST_INCREMENTS 20000
+#define THREADING_TEST_HANDOFFS 1000
+
+#define PARALLEL_FOR_TEST_COUNT 100003
+#define PARALLEL_FOR_BENCHMARK_COUNT (1 << 22)
+#define PARALLEL_FOR_BENCHMARK_MAX_THREADS 8
+
+#define TASK_GRAPH_TEST_TASKS 7
+#define TASK_GRAPH_TEST_RUNS 200
+
+typedef struct ThreadingTestData {
+    PlatformMutex mutex;
+    PlatformConditionVariable condition;
+    PlatformSemaphore semaphore;
+
+    /** Guarded by mutex. */
+    u64 total;
+    u32 turn;
+} ThreadingTestData;
+
+static u32 incrementThread(void *argument) {
+    ThreadingTestData *data = argument;
+    for (u32 i = 0; i < THREADING_TEST_INCREMENTS; ++i) {
+        platformMutexLock(&data->mutex);
+        data->total++;
+        platformMutexUnlock(&data->mutex);
+    }
+
+    return 0;
+}
+
+/** Takes odd turns while the main thread takes even ones; each side sleeps until it is up. */
+static u32 handoffThread(void *argument) {
+    ThreadingTestData *data = argument;
+    for (u32 i = 0; i < THREADING_TEST_HANDOFFS; ++i) {
+        platformMutexLock(&data->mutex);
+        while (data->turn % 2 == 0) {
+            platformConditionVariableWait(&data->condition, &data->mutex);
+        }
+
+        data->turn++;
+        platformConditionVariableBroadcast(&data->condition);
+        platformMutexUnlock(&data->mutex);
+    }
+
+    return 0;
+}
+
+static u32 semaphoreThread(void *argument) {
+    ThreadingTestData *data = argument;
+    for (u32 i = 0; i < THREADING_TEST_HANDOFFS; ++i) {
+        platformSemaphoreWait(&data->semaphore);
+    }
+
+    return 0;
+}
+
+b8 testPlatformThreading() {
+    ENGINE_INFO("Platform threading:\n")
+
+    ThreadingTestData data = {0};
+    PlatformThread current = platformThreadGetCurrent();
+    platformThreadSetName(&current, "Engine tests main thread");
+    u32 processorCount = platformGetProcessorCount();
+    u64 everyProcessor = processorCount >= 64 ? ~0ULL : (1ULL << processorCount) - 1;
+    if (!platformThreadSetAffinity(&current, everyProcessor)) {
+        ENGINE_ERROR("Could not set the main thread's affinity to all %u processors.", processorCount)
+        return false;
+    }
+
+    platformMutexLock(&data.mutex);
+    if (platformMutexTryLock(&data.mutex)) {
+        ENGINE_ERROR("A held mutex was locked again.")
+        return false;
+    }
+
+    platformMutexUnlock(&data.mutex);
+
+    PlatformThread threads[THREADING_TEST_THREAD_COUNT];
+    for (u32 i = 0; i < THREADING_TEST_THREAD_COUNT; ++i) {
+        platformThreadCreate(incrementThread, &data, &threads[i]);
+    }
+
+    for (u32 i = 0; i < THREADING_TEST_THREAD_COUNT; ++i) {
+        platformThreadJoin(&threads[i]);
+    }
+
+    if (data.total != THREADING_TEST_THREAD_COUNT * THREADING_TEST_INCREMENTS) {
+        ENGINE_ERROR("Mutex let increments through: %llu of %u.", data.total,
+            THREADING_TEST_THREAD_COUNT * THREADING_TEST_INCREMENTS)
+        return false;
+    }
+
+    platformThreadCreate(handoffThread, &data, &threads[0]);
+    for (u32 i = 0; i < THREADING_TEST_HANDOFFS; ++i) {
+        platformMutexLock(&data.mutex);
+        while (data.turn % 2 == 1) {
+            platformConditionVariableWait(&data.condition, &data.mutex);
+        }
+
+        data.turn++;
+        platformConditionVariableSignal(&data.condition);
+        platformMutexUnlock(&data.mutex);
+    }
+
+    platformThreadJoin(&threads[0]);
+    if (data.turn != THREADING_TEST_HANDOFFS * 2) {
+        ENGINE_ERROR("Condition variable handoff ended on turn %u.", data.turn)
+        return false;
+    }
+
+    platformSemaphoreCreate(0, &data.semaphore);
+    platformThreadCreate(semaphoreThread, &data, &threads[0]);
+    for (u32 i = 0; i < THREADING_TEST_HANDOFFS; i += 10) {
+        platformSemaphoreSignal(&data.semaphore, 10);
+    }
+
+    platformThreadJoin(&threads[0]);
+    platformSemaphoreDestroy(&data.semaphore);
+
+    ENGINE_INFO("  %u locked increments and %u condition and semaphore handoffs.",
+        THREADING_TEST_THREAD_COUNT * THREADING_TEST_INCREMENTS, THREADING_TEST_HANDOFFS)
+
+    return true;
+}
+
+static void countJob(void *data) {
+    atomicFetchAdd64((volatile u64*)data, 1);
+}
+
+/** Counts jobs that ran on a worker without a usable scratch stack. */
+static void scratchJob(void *data) {
+    if (jobSystemGetThreadIndex() == 0) {
+        return;
+    }
+
+    StackAllocator *scratch = stackAllocatorGetScratch();
+    StackAllocatorMarker marker = scratch ? stackAllocatorGetMarker(scratch) : 0;
+    if (!scratch || !stackAllocatorAllocate(scratch, 1024, 16) || !stackAllocatorFreeToMarker(scratch, marker)) {
+        atomicFetchAdd64((volatile u64*)data, 1);
+    }
+}
+
+typedef struct ParentJobData {
+    volatile u64 *total;
+    u64 childrenSeen;
+} ParentJobData;
+
+/** Spawns children from inside a job and waits on them there. */
+static void parentJob(void *data) {
+    ParentJobData *parent = data;
+    JobDecl children[JOB_TEST_CHILD_COUNT];
+    for (u32 i = 0; i < JOB_TEST_CHILD_COUNT; ++i) {
+        children[i].entry = countJob;
+        children[i].data = (void*)parent->total;
+        children[i].priority = (JobPriority)(i % JOB_PRIORITY_COUNT);
+    }
+
+    JobCounter counter = {0};
+    u64 before = atomicLoad64(parent->total);
+    jobSystemRun(children, JOB_TEST_CHILD_COUNT, &counter);
+    jobSystemWaitForCounter(&counter, 0);
+
+    /** Other parents add too, so this only checks that its own children have all landed. */
+    parent->childrenSeen = atomicLoad64(parent->total) - before;
+}
+
+typedef struct GatedJobData {
+    JobCounter *started;
+    JobCounter *gate;
+    volatile u64 *passed;
+} GatedJobData;
+
+/** Announces itself, then waits on a gate that only opens once every gated job has started. */
+static void gatedJob(void *data) {
+    GatedJobData *gated = data;
+    atomicFetchSub64(&gated->started->value, 1);
+    jobSystemWaitForCounter(gated->gate, 0);
+    atomicFetchAdd64(gated->passed, 1);
+}
+
+b8 testJobSystem() {
+    ENGINE_INFO("Job system:\n")
+
+    /** Before initialization jobs run on the spot. */
+    volatile u64 total = 0;
+    JobDecl job = {countJob, (void*)&total, JOB_PRIORITY_NORMAL};
+    JobCounter counter = {0};
+    jobSystemRun(&job, 1, &counter);
+    if (total != 1 || counter.value != 0 || jobSystemGetThreadCount() != 1) {
+        ENGINE_ERROR("Jobs did not run inline without a job system.")
+        return false;
+    }
+
+    /** Small deques, so bursts overflow and run inline as well. */
+    JobSystemConfig config;
+    config.workerCount = 3;
+    config.maxJobsPerThread = 64;
+    config.fiberCount = 64;
+    config.fiberStackSize = 32 * 1024;
+    config.workerScratchSize = 64 * 1024;
+    u64 memoryRequirement = 0;
+    jobSystemInitialize(&memoryRequirement, 0, config);
+    void *memory = engineAllocate(memoryRequirement, MEMORY_TAG_JOB);
+    if (!jobSystemInitialize(&memoryRequirement, memory, config)) {
+        ENGINE_ERROR("Failed to initialize the job system.")
+        return false;
+    }
+
+    if (jobSystemGetThreadCount() != 4 || jobSystemGetThreadIndex() != 0) {
+        ENGINE_ERROR("Job system reported %u threads and main index %u.",
+            jobSystemGetThreadCount(), jobSystemGetThreadIndex())
+        return false;
+    }
+
+    total = 0;
+    JobDecl jobs[100];
+    for (u32 i = 0; i < 100; ++i) {
+        jobs[i].entry = countJob;
+        jobs[i].data = (void*)&total;
+        jobs[i].priority = (JobPriority)(i % JOB_PRIORITY_COUNT);
+    }
+
+    for (u32 i = 0; i < JOB_TEST_JOB_COUNT / 100; ++i) {
+        jobSystemRun(jobs, 100, &counter);
+    }
+
+    jobSystemWaitForCounter(&counter, 0);
+    if (atomicLoad64(&total) != JOB_TEST_JOB_COUNT) {
+        ENGINE_ERROR("Expected %u jobs to run, counted %llu.", JOB_TEST_JOB_COUNT, atomicLoad64(&total))
+        return false;
+    }
+
+    /** Every worker binds its own scratch stack. */
+    volatile u64 scratchFailures = 0;
+    for (u32 i = 0; i < 100; ++i) {
+        jobs[i].entry = scratchJob;
+        jobs[i].data = (void*)&scratchFailures;
+    }
+
+    jobSystemRun(jobs, 100, &counter);
+    jobSystemWaitForCounter(&counter, 0);
+    if (atomicLoad64(&scratchFailures)) {
+        ENGINE_ERROR("%llu jobs found no scratch stack on their worker.", atomicLoad64(&scratchFailures))
+        return false;
+    }
+
+    total = 0;
+    ParentJobData parents[JOB_TEST_PARENT_COUNT];
+    JobDecl parentJobs[JOB_TEST_PARENT_COUNT];
+    for (u32 i = 0; i < JOB_TEST_PARENT_COUNT; ++i) {
+        parents[i].total = &total;
+        parents[i].childrenSeen = 0;
+        parentJobs[i].entry = parentJob;
+        parentJobs[i].data = &parents[i];
+        parentJobs[i].priority = JOB_PRIORITY_HIGH;
+    }
+
+    jobSystemRun(parentJobs, JOB_TEST_PARENT_COUNT, &counter);
+    jobSystemWaitForCounter(&counter, 0);
+    for (u32 i = 0; i < JOB_TEST_PARENT_COUNT; ++i) {
+        if (parents[i].childrenSeen < JOB_TEST_CHILD_COUNT) {
+            ENGINE_ERROR("Parent job %u returned before its children finished.", i)
+            return false;
+        }
+    }
+
+    if (atomicLoad64(&total) != JOB_TEST_PARENT_COUNT * JOB_TEST_CHILD_COUNT) {
+        ENGINE_ERROR("Nested jobs ran %llu times.", atomicLoad64(&total))
+        return false;
+    }
+
+    /**
+     * More jobs wait on the gate at once than there are threads, which only
+     * works if waiting parks the job instead of holding its thread.
+     */
+    JobCounter started = {JOB_TEST_GATED_COUNT};
+    JobCounter gate = {1};
+    total = 0;
+    GatedJobData gated = {&started, &gate, &total};
+    JobDecl gatedJobs[JOB_TEST_GATED_COUNT];
+    for (u32 i = 0; i < JOB_TEST_GATED_COUNT; ++i) {
+        gatedJobs[i].entry = gatedJob;
+        gatedJobs[i].data = &gated;
+        gatedJobs[i].priority = JOB_PRIORITY_NORMAL;
+    }
+
+    jobSystemRun(gatedJobs, JOB_TEST_GATED_COUNT, &counter);
+    jobSystemWaitForCounter(&started, 0);
+    if (atomicLoad64(&total) != 0) {
+        ENGINE_ERROR("A gated job got past its wait before the gate opened.")
+        return false;
+    }
+
+    atomicStore64(&gate.value, 0);
+    jobSystemWaitForCounter(&counter, 0);
+    if (atomicLoad64(&total) != JOB_TEST_GATED_COUNT) {
+        ENGINE_ERROR("Only %llu of %u parked jobs resumed.", atomicLoad64(&total), JOB_TEST_GATED_COUNT)
+        return false;
+    }
+
+    jobSystemShutdown(memory);
+    engineFree(memory, memoryRequirement, MEMORY_TAG_JOB);
+    if (jobSystemGetThreadIndex() != INVALID_ID) {
+        ENGINE_ERROR("The main thread kept its job thread index after shutdown.")
+        return false;
+    }
+
+    ENGINE_INFO("  %u flat and %u nested jobs ran on %u threads; %u jobs parked at once.", JOB_TEST_JOB_COUNT,
+        JOB_TEST_PARENT_COUNT * (JOB_TEST_CHILD_COUNT + 1), config.workerCount + 1, JOB_TEST_GATED_COUNT)
+
+    return true;
+}
+
+/** Tags that route to the pool, the buddy allocator and the dynamic allocator respectively. */
+static const MemoryTag allocationTestTags[3] = {MEMORY_TAG_STRING, MEMORY_TAG_TEXTURE, MEMORY_TAG_ARRAY};
+
+static volatile u64 corruptedBlocks = 0;
+
+/**
+ * Keeps a few blocks of mixed sizes and tags alive at once, filling each
+ * with a byte of its own and checking nobody else wrote over it before
+ * freeing it.
+ */
+static void allocatingJob(void *data) {
+    u32 seed = (u32)(u64)data;
+    void *blocks[JOB_TEST_LIVE_BLOCKS] = {0};
+    u64 sizes[JOB_TEST_LIVE_BLOCKS] = {0};
+    MemoryTag tags[JOB_TEST_LIVE_BLOCKS] = {0};
+    u8 fills[JOB_TEST_LIVE_BLOCKS] = {0};
+    for (u32 i = 0; i < JOB_TEST_ALLOCATIONS_PER_JOB + JOB_TEST_LIVE_BLOCKS; ++i) {
+        u32 slot = i % JOB_TEST_LIVE_BLOCKS;
+        if (blocks[slot]) {
+            u8 *bytes = blocks[slot];
+            if (bytes[0] != fills[slot] || bytes[sizes[slot] - 1] != fills[slot]) {
+                atomicFetchAdd64(&corruptedBlocks, 1);
+            }
+
+            engineFree(blocks[slot], sizes[slot], tags[slot]);
+            blocks[slot] = 0;
+        }
+
+        if (i < JOB_TEST_ALLOCATIONS_PER_JOB) {
+            seed = (seed * 1103515245) + 12345;
+            sizes[slot] = 16 + ((seed >> 8) % 3000);
+            tags[slot] = allocationTestTags[(seed >> 4) % 3];
+            fills[slot] = (u8)(seed >> 16);
+            blocks[slot] = engineAllocateUninitialized(sizes[slot], tags[slot]);
+            engineSetMemory(blocks[slot], fills[slot], sizes[slot]);
+        }
+    }
+}
+
+b8 testJobAllocations() {
+    ENGINE_INFO("Allocating from jobs:\n")
+
+    /** Every allocator behind engineAllocate, with tracking, shared by all the workers. */
+    MemorySystemConfig memoryConfig = {0};
+    memoryConfig.totalAllocSize = 16 * 1024 * 1024;
+    memoryConfig.poolBlocksPerClass = 256;
+    memoryConfig.pooledTagMask = MEMORY_TAG_BIT(MEMORY_TAG_STRING);
+    memoryConfig.buddyAllocSize = 4 * 1024 * 1024;
+    memoryConfig.buddyMinBlockSize = 64;
+    memoryConfig.buddyTagMask = MEMORY_TAG_BIT(MEMORY_TAG_TEXTURE);
+    memoryConfig.trackAllocations = true;
+    memoryConfig.trackingCapacity = 4096;
+
+    JobSystemConfig config;
+    config.workerCount = 3;
+    config.maxJobsPerThread = 64;
+    config.fiberCount = 16;
+    config.fiberStackSize = 256 * 1024;
+    config.workerScratchSize = 0;
+
+    /** Both blocks come from the heap before the memory system starts and go back after it stops. */
+    u64 memoryRequirement = 0;
+    memorySystemInitialize(&memoryRequirement, 0, memoryConfig);
+    void *memoryState = engineAllocateAligned(memoryRequirement, 64, MEMORY_TAG_APPLICATION);
+    u64 jobMemoryRequirement = 0;
+    jobSystemInitialize(&jobMemoryRequirement, 0, config);
+    void *jobMemory = engineAllocate(jobMemoryRequirement, MEMORY_TAG_JOB);
+
+    if (!memorySystemInitialize(&memoryRequirement, memoryState, memoryConfig) ||
+        !jobSystemInitialize(&jobMemoryRequirement, jobMemory, config)) {
+
+        ENGINE_ERROR("Failed to initialize the memory and job systems.")
+        return false;
+    }
+
+    JobDecl jobs[JOB_TEST_ALLOCATING_JOBS];
+    for (u32 i = 0; i < JOB_TEST_ALLOCATING_JOBS; ++i) {
+        jobs[i].entry = allocatingJob;
+        jobs[i].data = (void*)(u64)(i + 1);
+        jobs[i].priority = JOB_PRIORITY_NORMAL;
+    }
+
+    JobCounter counter = {0};
+    jobSystemRun(jobs, JOB_TEST_ALLOCATING_JOBS, &counter);
+    jobSystemWaitForCounter(&counter, 0);
+    jobSystemShutdown(jobMemory);
+
+    if (atomicLoad64(&corruptedBlocks)) {
+        ENGINE_ERROR("%llu blocks were written over while they were live.", atomicLoad64(&corruptedBlocks))
+        return false;
+    }
+
+    MemoryStatsSnapshot snapshot;
+    DynamicAllocatorStats dynamicStats;
+    BuddyAllocatorStats buddyStats;
+    engineGetMemoryStats(&snapshot);
+    engineGetMemoryAllocatorStats(&dynamicStats);
+    engineGetMemoryBuddyStats(&buddyStats);
+    if (snapshot.totalAllocated != 0 ||
+        snapshot.allocationCount != JOB_TEST_ALLOCATING_JOBS * JOB_TEST_ALLOCATIONS_PER_JOB ||
+        dynamicStats.freeBlockCount != 1 || dynamicStats.freeSpace != dynamicStats.totalSize ||
+        buddyStats.usedSize != 0) {
+
+        ENGINE_ERROR("Allocators were left inconsistent: %lluB live, %llu dynamic free ranges, %lluB buddy used.",
+            snapshot.totalAllocated, dynamicStats.freeBlockCount, buddyStats.usedSize)
+        return false;
+    }
+
+    PoolAllocatorClassStats poolStats;
+    for (u32 i = 0; engineGetMemoryPoolStats(i, &poolStats); ++i) {
+        if (poolStats.used != 0) {
+            ENGINE_ERROR("Pool class %lluB still has %llu blocks in use.", poolStats.blockSize, poolStats.used)
+            return false;
+        }
+    }
+
+    memorySystemShutdown(memoryState);
+    engineFree(jobMemory, jobMemoryRequirement, MEMORY_TAG_JOB);
+    engineFreeAligned(memoryState, memoryRequirement, 64, MEMORY_TAG_APPLICATION);
+
+    ENGINE_INFO("  %u allocations and frees from %u jobs on %u threads.",
+        JOB_TEST_ALLOCATING_JOBS * JOB_TEST_ALLOCATIONS_PER_JOB, JOB_TEST_ALLOCATING_JOBS, config.workerCount + 1)
+
+    return true;
+}
+
+static void markVisited(u32 begin, u32 end, void *userData) {
+    u8 *visits = userData;
+    for (u32 i = begin; i < end; ++i) {
+        visits[i]++;
+    }
+}
+
+/** Compute-bound, so the benchmark measures the pool rather than memory bandwidth. */
+static void benchmarkBody(u32 begin, u32 end, void *userData) {
+    f32 *values = userData;
+    for (u32 i = begin; i < end; ++i) {
+        f32 x = (f32)i * 0.001f;
+        for (u32 j = 0; j < 32; ++j) {
+            x = (x * 0.999f) + 0.5f;
+        }
+
+        values[i] = x;
+    }
+}
+
+static b8 initializeParallelFor(u32 workerCount, u64 *outMemoryRequirement, void **outMemory) {
+    ParallelForConfig config;
+    config.workerCount = workerCount;
+    parallelForSystemInitialize(outMemoryRequirement, 0, config);
+    *outMemory = engineAllocate(*outMemoryRequirement, MEMORY_TAG_JOB);
+    return parallelForSystemInitialize(outMemoryRequirement, *outMemory, config);
+}
+
+static void shutdownParallelFor(u64 memoryRequirement, void *memory) {
+    parallelForSystemShutdown(memory);
+    engineFree(memory, memoryRequirement, MEMORY_TAG_JOB);
+}
+
+b8 testParallelFor() {
+    ENGINE_INFO("Parallel for:\n")
+
+    u8 *visits = engineAllocate(PARALLEL_FOR_TEST_COUNT, MEMORY_TAG_ARRAY);
+    u64 memoryRequirement = 0;
+    void *memory = 0;
+    if (!initializeParallelFor(3, &memoryRequirement, &memory)) {
+        ENGINE_ERROR("Failed to initialize the parallel-for pool.")
+        return false;
+    }
+
+    /** A prime count, an offset start, and chunks from tiny to larger than the range. */
+    const u32 chunks[] = {1, 7, 1000, 60000, 200000};
+    for (u32 c = 0; c < sizeof(chunks) / sizeof(chunks[0]); ++c) {
+        engineZeroMemory(visits, PARALLEL_FOR_TEST_COUNT);
+        parallelFor(3, PARALLEL_FOR_TEST_COUNT, chunks[c], markVisited, visits);
+        for (u32 i = 0; i < PARALLEL_FOR_TEST_COUNT; ++i) {
+            if (visits[i] != (i >= 3 ? 1 : 0)) {
+                ENGINE_ERROR("Index %u was visited %u times with chunks of %u.", i, visits[i], chunks[c])
+                return false;
+            }
+        }
+    }
+
+    shutdownParallelFor(memoryRequirement, memory);
+    engineFree(visits, PARALLEL_FOR_TEST_COUNT, MEMORY_TAG_ARRAY);
+
+    /** Scaling: one thread is the plain serial loop, then the pool at each size up to the core count. */
+    f32 *values = engineAllocate(sizeof(f32) * PARALLEL_FOR_BENCHMARK_COUNT, MEMORY_TAG_ARRAY);
+    Clock clock = {0};
+    clockStart(&clock);
+    parallelFor(0, PARALLEL_FOR_BENCHMARK_COUNT, 4096, benchmarkBody, values);
+    clockUpdate(&clock);
+    f64 serialTime = clock.elapsed;
+    ENGINE_INFO("  1 thread: %.3fs.", serialTime)
+
+    initializeParallelFor(0, &memoryRequirement, &memory);
+    u32 maxThreads = parallelForGetThreadCount();
+    shutdownParallelFor(memoryRequirement, memory);
+    if (maxThreads > PARALLEL_FOR_BENCHMARK_MAX_THREADS) {
+        maxThreads = PARALLEL_FOR_BENCHMARK_MAX_THREADS;
+    }
+
+    for (u32 threads = 2; threads <= maxThreads; ++threads) {
+        initializeParallelFor(threads - 1, &memoryRequirement, &memory);
+        clockStart(&clock);
+        parallelFor(0, PARALLEL_FOR_BENCHMARK_COUNT, 4096, benchmarkBody, values);
+        clockUpdate(&clock);
+        ENGINE_INFO("  %u threads: %.3fs (%.2fx).", threads, clock.elapsed, serialTime / clock.elapsed)
+        shutdownParallelFor(memoryRequirement, memory);
+    }
+
+    engineFree(values, sizeof(f32) * PARALLEL_FOR_BENCHMARK_COUNT, MEMORY_TAG_ARRAY);
+
+    return true;
+}
+
+typedef struct GraphTestTask {
+    volatile u64 *sequence;
+
+    /** Position this task finished in during the last run, from 1. */
+    u64 order;
+    u32 threadIndex;
+    b8 succeed;
+} GraphTestTask;
+
+static b8 recordTask(void *userData) {
+    GraphTestTask *task = userData;
+    task->threadIndex = jobSystemGetThreadIndex();
+    task->order = atomicFetchAdd64(task->sequence, 1) + 1;
+    return task->succeed;
+}
+
+/** Runs the graph and checks every declared ordering; see the layout in testTaskGraph. */
+static b8 executeOrderedGraph(TaskGraph *graph, GraphTestTask *tasks, volatile u64 *sequence) {
+    atomicStore64(sequence, 0);
+    for (u32 i = 0; i < TASK_GRAPH_TEST_TASKS; ++i) {
+        tasks[i].order = 0;
+    }
+
+    if (!taskGraphExecute(graph)) {
+        ENGINE_ERROR("Task graph execution failed with no failing task.")
+        return false;
+    }
+
+    for (u32 i = 0; i < TASK_GRAPH_TEST_TASKS; ++i) {
+        if (tasks[i].order == 0) {
+            ENGINE_ERROR("Task %u did not run.", i)
+            return false;
+        }
+    }
+
+    for (u32 reader = 1; reader <= 3; ++reader) {
+        if (tasks[reader].order < tasks[0].order || tasks[reader].order > tasks[4].order) {
+            ENGINE_ERROR("Reader %u ran out of order with the writers around it.", reader)
+            return false;
+        }
+    }
+
+    if (tasks[6].order < tasks[4].order || tasks[6].order < tasks[5].order) {
+        ENGINE_ERROR("The last task ran before the writers it reads from.")
+        return false;
+    }
+
+    if (tasks[4].threadIndex != jobSystemGetThreadIndex() || tasks[6].threadIndex != jobSystemGetThreadIndex()) {
+        ENGINE_ERROR("A main-thread task ran on another thread.")
+        return false;
+    }
+
+    return true;
+}
+
+b8 testTaskGraph() {
+    ENGINE_INFO("Task graph:\n")
+
+    u64 graphMemoryRequirement = 0;
+    taskGraphCreate(TASK_GRAPH_TEST_TASKS, 4, 16, &graphMemoryRequirement, 0, 0);
+    void *graphMemory = engineAllocate(graphMemoryRequirement, MEMORY_TAG_ARRAY);
+    TaskGraph graph;
+    if (!taskGraphCreate(TASK_GRAPH_TEST_TASKS, 4, 16, &graphMemoryRequirement, graphMemory, &graph)) {
+        ENGINE_ERROR("Failed to create the task graph.")
+        return false;
+    }
+
+    /**
+     * 0 writes a; 1-3 read it; 4 writes it again on the main thread; 5 writes
+     * b on its own; 6 reads both on the main thread. Declared out of order to
+     * show that task order, not access order, decides.
+     */
+    volatile u64 sequence = 0;
+    GraphTestTask tasks[TASK_GRAPH_TEST_TASKS];
+    for (u32 i = 0; i < TASK_GRAPH_TEST_TASKS; ++i) {
+        tasks[i].sequence = &sequence;
+        tasks[i].succeed = true;
+        taskGraphAddTask(&graph, "ordered", recordTask, &tasks[i], i == 4 || i == 6);
+    }
+
+    taskGraphRead(&graph, 6, "a");
+    taskGraphRead(&graph, 6, "b");
+    taskGraphWrite(&graph, 5, "b");
+    taskGraphWrite(&graph, 4, "a");
+    taskGraphRead(&graph, 3, "a");
+    taskGraphRead(&graph, 2, "a");
+    taskGraphRead(&graph, 1, "a");
+    taskGraphWrite(&graph, 0, "a");
+
+    /** Without a job system every task runs on the calling thread. */
+    for (u32 run = 0; run < 3; ++run) {
+        if (!executeOrderedGraph(&graph, tasks, &sequence)) {
+            return false;
+        }
+    }
+
+    JobSystemConfig config;
+    config.workerCount = 3;
+    config.maxJobsPerThread = 64;
+    config.fiberCount = 16;
+    /** Room for the failing task's log message. */
+    config.fiberStackSize = 256 * 1024;
+    config.workerScratchSize = 0;
+    u64 memoryRequirement = 0;
+    jobSystemInitialize(&memoryRequirement, 0, config);
+    void *memory = engineAllocate(memoryRequirement, MEMORY_TAG_JOB);
+    if (!jobSystemInitialize(&memoryRequirement, memory, config)) {
+        ENGINE_ERROR("Failed to initialize the job system.")
+        return false;
+    }
+
+    for (u32 run = 0; run < TASK_GRAPH_TEST_RUNS; ++run) {
+        if (!executeOrderedGraph(&graph, tasks, &sequence)) {
+            return false;
+        }
+    }
+
+    /** A task failing keeps its dependents from starting, and the run reports it. */
+    tasks[0].succeed = false;
+    atomicStore64(&sequence, 0);
+    for (u32 i = 0; i < TASK_GRAPH_TEST_TASKS; ++i) {
+        tasks[i].order = 0;
+    }
+
+    if (taskGraphExecute(&graph)) {
+        ENGINE_ERROR("Task graph execution succeeded with a failing task.")
+        return false;
+    }
+
+    for (u32 i = 1; i <= 4; ++i) {
+        if (tasks[i].order != 0) {
+            ENGINE_ERROR("Task %u ran after the task it depends on failed.", i)
+            return false;
+        }
+    }
+
+    /** A full graph turns away more tasks, and a failed run leaves it ready for the next one. */
+    tasks[0].succeed = true;
+    GraphTestTask extra = {&sequence, 0, 0, true};
+    u32 extraIndex = taskGraphAddTask(&graph, "extra", recordTask, &extra, false);
+    if (extraIndex != INVALID_ID) {
+        ENGINE_ERROR("A full task graph accepted another task.")
+        return false;
+    }
+
+    if (!executeOrderedGraph(&graph, tasks, &sequence)) {
+        return false;
+    }
+
+    jobSystemShutdown(memory);
+    engineFree(memory, memoryRequirement, MEMORY_TAG_JOB);
+    engineFree(graphMemory, graphMemoryRequirement, MEMORY_TAG_ARRAY);
+
+    ENGINE_INFO("  %u tasks ran in dependency order %u times on %u threads.", TASK_GRAPH_TEST_TASKS,
+        TASK_GRAPH_TEST_RUNS, config.workerCount + 1)
+
+    return true;
+}
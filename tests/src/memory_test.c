@@ -1,9 +1,16 @@
 #include "../include/memory_test.h"
 
 #include "../../engine/src/engine_memory/engine_memory.h"
+#include "../../engine/src/engine_memory/dynamic_allocator.h"
+#include "../../engine/src/engine_memory/pool_allocator.h"
+#include "../../engine/src/engine_memory/linear_allocator.h"
+#include "../../engine/src/engine_memory/stack_allocator.h"
+#include "../../engine/src/engine_memory/virtual_arena.h"
 
 #include <stddef.h>
 
+#define FRAGMENT_TEST_BLOCKS 8192
+
 void logTypeSizes() {
     ENGINE_INFO("Type sizes:\n")
 
@@ -33,3 +40,577 @@ void logMemoryUsage() {
     }
 #endif
 }
+
+b8 testDynamicAllocator() {
+    ENGINE_INFO("Dynamic allocator:\n")
+
+    const u64 totalSize = 1024;
+    u64 memoryRequirement = 0;
+    DynamicAllocator allocator;
+    dynamicAllocatorCreate(totalSize, &memoryRequirement, 0, 0);
+    void *memory = engineAllocate(memoryRequirement, MEMORY_TAG_APPLICATION);
+    if (!dynamicAllocatorCreate(totalSize, &memoryRequirement, memory, &allocator)) {
+        ENGINE_ERROR("dynamicAllocatorCreate failed.")
+        return false;
+    }
+
+    void *a = dynamicAllocatorAllocate(&allocator, 100);
+    void *b = dynamicAllocatorAllocate(&allocator, 200);
+    void *c = dynamicAllocatorAllocate(&allocator, 300);
+    if (!a || !b || !c || ((u64)a % DYNAMIC_ALLOCATOR_GRANULARITY) ||
+        ((u64)b % DYNAMIC_ALLOCATOR_GRANULARITY) || ((u64)c % DYNAMIC_ALLOCATOR_GRANULARITY)) {
+        ENGINE_ERROR("Expected three aligned blocks.")
+        return false;
+    }
+
+    /** Free the middle block, then its neighbours; everything should coalesce back. */
+    dynamicAllocatorFree(&allocator, b, 200);
+
+    DynamicAllocatorStats stats;
+    dynamicAllocatorGetStats(&allocator, &stats);
+    if (stats.freeBlockCount != 2 || stats.fragmentation <= 0.0f) {
+        ENGINE_ERROR("Expected a hole between blocks, got %llu free ranges.", stats.freeBlockCount)
+        return false;
+    }
+
+    if (dynamicAllocatorFree(&allocator, b, 200)) {
+        ENGINE_ERROR("Double free was not detected.")
+        return false;
+    }
+
+    dynamicAllocatorFree(&allocator, a, 100);
+    dynamicAllocatorFree(&allocator, c, 300);
+    dynamicAllocatorGetStats(&allocator, &stats);
+    if (stats.freeBlockCount != 1 || stats.largestFreeBlock != stats.totalSize) {
+        ENGINE_ERROR("Expected a single free range after freeing everything, got %llu.",
+            stats.freeBlockCount)
+        return false;
+    }
+
+    ENGINE_INFO("  free: %lluB, largest: %lluB, ranges: %llu, fragmentation: %.2f",
+        stats.freeSpace, stats.largestFreeBlock, stats.freeBlockCount, stats.fragmentation)
+
+    dynamicAllocatorDestroy(&allocator);
+    engineFree(memory, memoryRequirement, MEMORY_TAG_APPLICATION);
+
+    return true;
+}
+
+b8 testDynamicAllocatorFragmentation() {
+    ENGINE_INFO("Dynamic allocator fragmentation:\n")
+
+    /** Exactly enough room for the blocks, so every range is a freed block. */
+    const u64 blockSize = 16;
+    const u64 totalSize = FRAGMENT_TEST_BLOCKS * DYNAMIC_ALLOCATOR_GRANULARITY;
+    u64 memoryRequirement = 0;
+    DynamicAllocator allocator;
+    dynamicAllocatorCreate(totalSize, &memoryRequirement, 0, 0);
+    void *memory = engineAllocate(memoryRequirement, MEMORY_TAG_APPLICATION);
+    dynamicAllocatorCreate(totalSize, &memoryRequirement, memory, &allocator);
+
+    void **blocks = engineAllocate(sizeof(void*) * FRAGMENT_TEST_BLOCKS, MEMORY_TAG_ARRAY);
+    for (u32 i = 0; i < FRAGMENT_TEST_BLOCKS; ++i) {
+        blocks[i] = dynamicAllocatorAllocate(&allocator, blockSize);
+        if (!blocks[i]) {
+            ENGINE_ERROR("Allocation %u of %u failed.", i, FRAGMENT_TEST_BLOCKS)
+            return false;
+        }
+    }
+
+    /** Every other block: thousands of free ranges that cannot merge. */
+    for (u32 i = 0; i < FRAGMENT_TEST_BLOCKS; i += 2) {
+        if (!dynamicAllocatorFree(&allocator, blocks[i], blockSize)) {
+            ENGINE_ERROR("Freeing block %u of a fragmented heap failed.", i)
+            return false;
+        }
+    }
+
+    DynamicAllocatorStats stats;
+    dynamicAllocatorGetStats(&allocator, &stats);
+    if (stats.freeBlockCount != FRAGMENT_TEST_BLOCKS / 2 ||
+        stats.freeSpace != (FRAGMENT_TEST_BLOCKS / 2) * DYNAMIC_ALLOCATOR_GRANULARITY ||
+        stats.largestFreeBlock != DYNAMIC_ALLOCATOR_GRANULARITY) {
+
+        ENGINE_ERROR("Expected %u separate free ranges, got %llu.", FRAGMENT_TEST_BLOCKS / 2, stats.freeBlockCount)
+        return false;
+    }
+
+    /** Holes are reused, and a block bigger than any hole does not fit. */
+    if (dynamicAllocatorAllocate(&allocator, DYNAMIC_ALLOCATOR_GRANULARITY + 1)) {
+        ENGINE_ERROR("A block larger than every hole was allocated.")
+        return false;
+    }
+
+    for (u32 i = 0; i < FRAGMENT_TEST_BLOCKS; i += 2) {
+        blocks[i] = dynamicAllocatorAllocate(&allocator, blockSize);
+        if (!blocks[i]) {
+            ENGINE_ERROR("Refilling hole %u failed.", i)
+            return false;
+        }
+    }
+
+    if (dynamicAllocatorFreeSpace(&allocator) != 0) {
+        ENGINE_ERROR("Refilling the holes left %lluB free.", dynamicAllocatorFreeSpace(&allocator))
+        return false;
+    }
+
+    /** Odd blocks first this time, then even ones, which merge both ways into one range. */
+    for (u32 pass = 1; pass < 3; ++pass) {
+        for (u32 i = pass % 2; i < FRAGMENT_TEST_BLOCKS; i += 2) {
+            dynamicAllocatorFree(&allocator, blocks[i], blockSize);
+        }
+    }
+
+    dynamicAllocatorGetStats(&allocator, &stats);
+    if (stats.freeBlockCount != 1 || stats.largestFreeBlock != stats.totalSize) {
+        ENGINE_ERROR("Expected a single free range after freeing everything, got %llu.",
+            stats.freeBlockCount)
+        return false;
+    }
+
+    ENGINE_INFO("  %u %lluB blocks freed alternately and refilled; %llu range left.",
+        FRAGMENT_TEST_BLOCKS, blockSize, stats.freeBlockCount)
+
+    engineFree(blocks, sizeof(void*) * FRAGMENT_TEST_BLOCKS, MEMORY_TAG_ARRAY);
+    dynamicAllocatorDestroy(&allocator);
+    engineFree(memory, memoryRequirement, MEMORY_TAG_APPLICATION);
+
+    return true;
+}
+
+b8 testPoolAllocator() {
+    ENGINE_INFO("Pool allocator:\n")
+
+    const u64 blocksPerClass = 4;
+    u64 memoryRequirement = 0;
+    PoolAllocator allocator;
+    poolAllocatorCreate(blocksPerClass, &memoryRequirement, 0, 0);
+    void *memory = engineAllocateAligned(memoryRequirement, 64, MEMORY_TAG_APPLICATION);
+    poolAllocatorCreate(blocksPerClass, &memoryRequirement, memory, &allocator);
+
+    /** 40 bytes rounds up to the 64-byte class. */
+    void *blocks[4];
+    for (u32 i = 0; i < blocksPerClass; ++i) {
+        blocks[i] = poolAllocatorAllocate(&allocator, 40);
+        if (!blocks[i] || ((u64)blocks[i] % 64)) {
+            ENGINE_ERROR("Expected a 64-byte aligned block from the 64B class.")
+            return false;
+        }
+    }
+
+    if (poolAllocatorAllocate(&allocator, 40) ||
+        poolAllocatorAllocate(&allocator, POOL_ALLOCATOR_MAX_BLOCK_SIZE + 1)) {
+        ENGINE_ERROR("Expected exhausted and oversized requests to fail.")
+        return false;
+    }
+
+    PoolAllocatorClassStats stats;
+    poolAllocatorGetClassStats(&allocator, 2, &stats);
+    if (stats.blockSize != 64 || stats.used != 4 || stats.exhaustedCount != 1) {
+        ENGINE_ERROR("Unexpected 64B class counters: used %llu, exhausted %llu.",
+            stats.used, stats.exhaustedCount)
+        return false;
+    }
+
+    /** Freed blocks are reused last-in, first-out. */
+    poolAllocatorFree(&allocator, blocks[1]);
+    if (poolAllocatorAllocate(&allocator, 64) != blocks[1]) {
+        ENGINE_ERROR("Expected the freed block to be reused.")
+        return false;
+    }
+
+    for (u32 i = 0; i < blocksPerClass; ++i) {
+        poolAllocatorFree(&allocator, blocks[i]);
+    }
+
+    poolAllocatorGetClassStats(&allocator, 2, &stats);
+    ENGINE_INFO("  %lluB class: %llu/%llu used, peak %llu",
+        stats.blockSize, stats.used, stats.capacity, stats.peakUsed)
+
+    poolAllocatorDestroy(&allocator);
+    engineFreeAligned(memory, memoryRequirement, 64, MEMORY_TAG_APPLICATION);
+
+    return stats.used == 0 && stats.peakUsed == 4;
+}
+
+b8 testAlignedAllocation() {
+    ENGINE_INFO("Aligned allocation:\n")
+
+    const u64 alignments[3] = {16, 32, 64};
+    for (u32 i = 0; i < 3; ++i) {
+        u8 *block = engineAllocateAligned(100, alignments[i], MEMORY_TAG_ARRAY);
+        if (!block || ((u64)block % alignments[i])) {
+            ENGINE_ERROR("Block %p is not %llu-byte aligned.", block, alignments[i])
+            return false;
+        }
+
+        for (u32 j = 0; j < 100; ++j) {
+            if (block[j] != 0) {
+                ENGINE_ERROR("Aligned block was not zeroed.")
+                return false;
+            }
+        }
+
+        engineFreeAligned(block, 100, alignments[i], MEMORY_TAG_ARRAY);
+    }
+
+    LinearAllocator allocator;
+    linearAllocatorCreate(1024, 0, &allocator);
+    linearAllocatorAllocate(&allocator, 3);
+    void *aligned = linearAllocatorAllocateAligned(&allocator, 16, 64);
+    if (!aligned || ((u64)aligned % 64)) {
+        ENGINE_ERROR("Linear allocator returned %p for a 64-byte aligned request.", aligned)
+        return false;
+    }
+    linearAllocatorDestroy(&allocator);
+
+    ENGINE_INFO("  16/32/64-byte blocks aligned and zeroed.")
+
+    return true;
+}
+
+b8 testLinearAllocatorDirtyMark() {
+    ENGINE_INFO("Linear allocator dirty mark:\n")
+
+    LinearAllocator allocator;
+    linearAllocatorCreate(1024, 0, &allocator);
+
+    u8 *block = linearAllocatorAllocate(&allocator, 200);
+    engineSetMemory(block, 0xAB, 200);
+    linearAllocatorFreeAll(&allocator, false);
+    linearAllocatorAllocate(&allocator, 50);
+
+    if (allocator.dirty != 200 || allocator.allocated != 50) {
+        ENGINE_ERROR("Expected dirty 200 / allocated 50, got %llu / %llu.",
+            allocator.dirty, allocator.allocated)
+        return false;
+    }
+
+    linearAllocatorFreeAll(&allocator, true);
+    for (u32 i = 0; i < 200; ++i) {
+        if (block[i] != 0) {
+            ENGINE_ERROR("Byte %u was not cleared.", i)
+            return false;
+        }
+    }
+
+    if (allocator.dirty != 0) {
+        ENGINE_ERROR("Dirty mark not reset after clearing.")
+        return false;
+    }
+    linearAllocatorDestroy(&allocator);
+
+    ENGINE_INFO("  Only the dirty range is cleared.")
+
+    return true;
+}
+
+b8 testStackAllocator() {
+    ENGINE_INFO("Stack allocator:\n")
+
+    StackAllocator allocator;
+    stackAllocatorCreate(1024, 0, &allocator);
+
+    StackAllocatorMarker outer = stackAllocatorGetMarker(&allocator);
+    stackAllocatorAllocate(&allocator, 100, 1);
+
+    StackAllocatorMarker inner = stackAllocatorGetMarker(&allocator);
+    void *block = stackAllocatorAllocate(&allocator, 200, 64);
+    if (!block || ((u64)block % 64)) {
+        ENGINE_ERROR("Stack allocator returned %p for a 64-byte aligned request.", block)
+        return false;
+    }
+
+#ifdef _DEBUG
+    if (stackAllocatorFreeToMarker(&allocator, outer)) {
+        ENGINE_ERROR("Out-of-order free to the outer marker was accepted.")
+        return false;
+    }
+#endif
+
+    if (!stackAllocatorFreeToMarker(&allocator, inner) || allocator.top != 100) {
+        ENGINE_ERROR("Freeing to the inner marker left top at %llu.", allocator.top)
+        return false;
+    }
+
+    if (!stackAllocatorFreeToMarker(&allocator, outer) || allocator.top != 0) {
+        ENGINE_ERROR("Freeing to the outer marker left top at %llu.", allocator.top)
+        return false;
+    }
+
+    if (stackAllocatorFreeToMarker(&allocator, inner)) {
+        ENGINE_ERROR("Freeing to a released marker was accepted.")
+        return false;
+    }
+
+    stackAllocatorSetScratch(&allocator);
+    if (stackAllocatorGetScratch() != &allocator) {
+        ENGINE_ERROR("Scratch stack was not bound to this thread.")
+        return false;
+    }
+    stackAllocatorSetScratch(0);
+    stackAllocatorDestroy(&allocator);
+
+    ENGINE_INFO("  Nested markers released innermost first.")
+
+    return true;
+}
+
+b8 testVirtualArena() {
+    ENGINE_INFO("Virtual arena:\n")
+
+    VirtualArena arena;
+    if (!virtualArenaCreate(256 * 1024 * 1024, &arena)) {
+        ENGINE_ERROR("Unable to reserve a 256MiB virtual arena.")
+        return false;
+    }
+
+    if (arena.committedSize != 0) {
+        ENGINE_ERROR("Fresh arena already has %lluB committed.", arena.committedSize)
+        return false;
+    }
+
+    u8 *first = virtualArenaAllocate(&arena, 100);
+    u64 committedAfterFirst = arena.committedSize;
+    u8 *second = virtualArenaAllocateAligned(&arena, 3 * VIRTUAL_ARENA_COMMIT_CHUNK, 4096);
+    if (!first || !second || ((u64)second % 4096) || committedAfterFirst != arena.commitChunk) {
+        ENGINE_ERROR("Unexpected arena layout: %p, %p, %lluB committed after the first block.",
+            first, second, committedAfterFirst)
+        return false;
+    }
+
+    /** Earlier blocks stay put as the arena grows, and fresh pages read back as zero. */
+    for (u64 i = 0; i < 3 * VIRTUAL_ARENA_COMMIT_CHUNK; i += 4096) {
+        if (second[i] != 0) {
+            ENGINE_ERROR("Freshly committed page was not zeroed.")
+            return false;
+        }
+        second[i] = 1;
+    }
+
+    u64 reserved = 0;
+    u64 committed = 0;
+    virtualArenaGetTotals(&reserved, &committed);
+    if (reserved < arena.reservedSize || committed < arena.committedSize) {
+        ENGINE_ERROR("Totals %llu/%llu do not cover the arena.", committed, reserved)
+        return false;
+    }
+
+    virtualArenaFreeAll(&arena);
+    second = virtualArenaAllocateAligned(&arena, 3 * VIRTUAL_ARENA_COMMIT_CHUNK, 4096);
+    if (!second || second[0] != 0) {
+        ENGINE_ERROR("Memory was not zeroed after free-all.")
+        return false;
+    }
+
+    virtualArenaDestroy(&arena);
+
+    ENGINE_INFO("  Pages committed on demand; %lluB committed of %lluB reserved at peak.",
+        committed, reserved)
+
+    return true;
+}
+
+b8 testBuddyAllocator() {
+    ENGINE_INFO("Buddy allocator:\n")
+
+    const u64 totalSize = 64 * 1024;
+    const u64 minBlockSize = 256;
+    u64 memoryRequirement = 0;
+    BuddyAllocator allocator;
+    buddyAllocatorCreate(totalSize, minBlockSize, &memoryRequirement, 0, 0);
+    void *memory = engineAllocateAligned(memoryRequirement, 64, MEMORY_TAG_APPLICATION);
+    if (!buddyAllocatorCreate(totalSize, minBlockSize, &memoryRequirement, memory, &allocator)) {
+        ENGINE_ERROR("buddyAllocatorCreate failed.")
+        return false;
+    }
+
+    /** Sizes chosen to hit several orders, freed in an order unrelated to allocation. */
+    const u64 sizes[8] = {100, 3000, 256, 700, 16384, 1025, 5000, 200};
+    void *blocks[8];
+    for (u32 i = 0; i < 8; ++i) {
+        blocks[i] = buddyAllocatorAllocate(&allocator, sizes[i]);
+        if (!blocks[i]) {
+            ENGINE_ERROR("Allocation %u (%lluB) failed.", i, sizes[i])
+            return false;
+        }
+
+        engineSetMemory(blocks[i], (i32)i, sizes[i]);
+    }
+
+    for (u32 i = 0; i < 8; ++i) {
+        if (((u8*)blocks[i])[sizes[i] - 1] != i) {
+            ENGINE_ERROR("Block %u overlaps another block.", i)
+            return false;
+        }
+    }
+
+    BuddyAllocatorStats stats;
+    buddyAllocatorGetStats(&allocator, &stats);
+    if (stats.allocationCount != 8 || stats.internalFragmentation <= 0.0f) {
+        ENGINE_ERROR("Expected 8 rounded-up allocations, got %llu.", stats.allocationCount)
+        return false;
+    }
+
+    const u32 freeOrder[8] = {3, 7, 0, 5, 2, 6, 1, 4};
+    for (u32 i = 0; i < 8; ++i) {
+        u32 index = freeOrder[i];
+        if (!buddyAllocatorFree(&allocator, blocks[index], sizes[index])) {
+            ENGINE_ERROR("Free of block %u failed.", index)
+            return false;
+        }
+    }
+
+    if (buddyAllocatorFree(&allocator, blocks[0], sizes[0])) {
+        ENGINE_ERROR("Double free was not detected.")
+        return false;
+    }
+
+    buddyAllocatorGetStats(&allocator, &stats);
+    if (stats.largestFreeBlock != totalSize || stats.freeBlocksPerOrder[stats.orderCount - 1] != 1) {
+        ENGINE_ERROR("Buddies did not merge back into one block; largest free is %lluB.",
+            stats.largestFreeBlock)
+        return false;
+    }
+
+    ENGINE_INFO("  %u orders, everything merged back into one %lluB block.",
+        stats.orderCount, stats.largestFreeBlock)
+
+    buddyAllocatorDestroy(&allocator);
+    engineFreeAligned(memory, memoryRequirement, 64, MEMORY_TAG_APPLICATION);
+
+    return true;
+}
+
+b8 testMemoryTracker() {
+    ENGINE_INFO("Memory tracker:\n")
+
+    u64 memoryRequirement = 0;
+    MemoryTracker tracker;
+    memoryTrackerCreate(256, &memoryRequirement, 0, 0);
+    void *memory = engineAllocateAligned(memoryRequirement, 64, MEMORY_TAG_APPLICATION);
+    memoryTrackerCreate(256, &memoryRequirement, memory, &tracker);
+
+    /** Fake addresses are fine; the tracker never touches the blocks. */
+    static const char *fileA = "a.c";
+    static const char *fileB = "b.c";
+    for (u64 i = 1; i <= 200; ++i) {
+        memoryTrackerAdd(&tracker, (void*)(i * 16), 10, MEMORY_TAG_ARRAY, fileA, 1);
+    }
+    memoryTrackerAdd(&tracker, (void*)0x100000, 5000, MEMORY_TAG_STRING, fileB, 2);
+
+    /** Free every other block to exercise removal from the middle of probe runs. */
+    for (u64 i = 1; i <= 200; i += 2) {
+        if (!memoryTrackerRemove(&tracker, (void*)(i * 16))) {
+            ENGINE_ERROR("Block %llu was not found.", i)
+            return false;
+        }
+    }
+
+    for (u64 i = 2; i <= 200; i += 2) {
+        if (memoryTrackerRemove(&tracker, (void*)(i * 16 + 8))) {
+            ENGINE_ERROR("Removed an address that was never added.")
+            return false;
+        }
+    }
+
+    MemoryCallsiteStats top[4];
+    u32 count = memoryTrackerGetTopCallsites(&tracker, MEMORY_CALLSITE_SORT_LIVE_BYTES, 4, top);
+    if (count != 2 || top[0].file != fileB || top[1].liveCount != 100 || top[1].liveBytes != 1000) {
+        ENGINE_ERROR("Unexpected callsite ranking by live bytes.")
+        return false;
+    }
+
+    count = memoryTrackerGetTopCallsites(&tracker, MEMORY_CALLSITE_SORT_TOTAL_COUNT, 1, top);
+    if (count != 1 || top[0].file != fileA || top[0].totalCount != 200) {
+        ENGINE_ERROR("Unexpected callsite ranking by allocation count.")
+        return false;
+    }
+
+    memoryTrackerBeginFrame(&tracker);
+    memoryTrackerAdd(&tracker, (void*)0x200000, 64, MEMORY_TAG_STRING, fileB, 2);
+    memoryTrackerBeginFrame(&tracker);
+    count = memoryTrackerGetTopCallsites(&tracker, MEMORY_CALLSITE_SORT_LAST_FRAME_COUNT, 4, top);
+    if (count != 1 || top[0].file != fileB || top[0].lastFrameCount != 1) {
+        ENGINE_ERROR("Expected a single hot spot last frame, got %u.", count)
+        return false;
+    }
+
+    for (u64 i = 2; i <= 200; i += 2) {
+        memoryTrackerRemove(&tracker, (void*)(i * 16));
+    }
+
+    u64 liveCount = 0;
+    memoryTrackerGetCounts(&tracker, &liveCount, 0);
+    if (liveCount != 2) {
+        ENGINE_ERROR("Expected 2 live blocks, got %llu.", liveCount)
+        return false;
+    }
+
+    memoryTrackerDestroy(&tracker);
+    engineFreeAligned(memory, memoryRequirement, 64, MEMORY_TAG_APPLICATION);
+
+    ENGINE_INFO("  Callsites ranked, frame hot spots and leaks counted.")
+
+    return true;
+}
+
+b8 testMemoryStats() {
+    ENGINE_INFO("Memory stats:\n")
+
+    /** A bare memory system: no pool or allocator blocks, only the counters. */
+    MemorySystemConfig config = {0};
+    config.frameAllocationBudget = 2;
+
+    u64 memoryRequirement = 0;
+    memorySystemInitialize(&memoryRequirement, 0, config);
+    void *state = engineAllocateAligned(memoryRequirement, 64, MEMORY_TAG_APPLICATION);
+    memorySystemInitialize(&memoryRequirement, state, config);
+
+    memorySystemBeginFrame();
+    void *a = engineAllocate(1000, MEMORY_TAG_GAME);
+    void *b = engineAllocate(3000, MEMORY_TAG_GAME);
+    engineFree(b, 3000, MEMORY_TAG_GAME);
+    void *c = engineAllocate(500, MEMORY_TAG_SCENE);
+
+    MemoryStatsSnapshot snapshot;
+    engineGetMemoryStats(&snapshot);
+    MemoryTagStats *game = &snapshot.tags[MEMORY_TAG_GAME];
+    if (game->currentBytes != 1000 || game->peakBytes != 4000 || game->allocationCount != 2 ||
+        game->freeCount != 1 || snapshot.peakTotalAllocated != 4000) {
+
+        ENGINE_ERROR("Unexpected GAME stats: %llu bytes, peak %llu, %llu allocs, %llu frees.",
+            game->currentBytes, game->peakBytes, game->allocationCount, game->freeCount)
+        return false;
+    }
+
+    /** Three allocations against a budget of two. */
+    if (memorySystemBeginFrame()) {
+        ENGINE_ERROR("Frame over the allocation budget was not flagged.")
+        return false;
+    }
+
+    MemoryFrameDelta delta;
+    engineGetMemoryFrameDelta(&delta);
+    if (delta.allocationCount != 3 || delta.freeCount != 1 || delta.bytesAllocated != 4500 ||
+        delta.taggedAllocationCounts[MEMORY_TAG_SCENE] != 1 || !delta.overBudget) {
+
+        ENGINE_ERROR("Unexpected frame delta: %llu allocs, %llu frees, %lluB.",
+            delta.allocationCount, delta.freeCount, delta.bytesAllocated)
+        return false;
+    }
+
+    engineFree(a, 1000, MEMORY_TAG_GAME);
+    engineFree(c, 500, MEMORY_TAG_SCENE);
+    if (!memorySystemBeginFrame()) {
+        ENGINE_ERROR("Frame without allocations was flagged.")
+        return false;
+    }
+
+    memorySystemShutdown(state);
+    engineFreeAligned(state, memoryRequirement, 64, MEMORY_TAG_APPLICATION);
+
+    ENGINE_INFO("  Peaks, counts and frame deltas add up.")
+
+    return true;
+}